@@ -0,0 +1,74 @@
+/*
+ * bench_util.c - Timers and process counters for benchmarks
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+double bench_wall_seconds(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+double bench_cpu_seconds(void)
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+    return ((((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+            (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime)) / 1e7;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0.0;
+    return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+           (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+int bench_io_bytes(unsigned long long* read_bytes, unsigned long long* write_bytes)
+{
+#ifdef _WIN32
+    IO_COUNTERS io;
+    if (!GetProcessIoCounters(GetCurrentProcess(), &io)) return 0;
+    *read_bytes = io.ReadTransferCount;
+    *write_bytes = io.WriteTransferCount;
+    return 1;
+#else
+    char line[128];
+    int found = 0;
+    FILE* f = fopen("/proc/self/io", "r");
+
+    *read_bytes = 0;
+    *write_bytes = 0;
+    if (!f) return 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "rchar: %llu", read_bytes) == 1) found |= 1;
+        if (sscanf(line, "wchar: %llu", write_bytes) == 1) found |= 2;
+    }
+    fclose(f);
+    return found == 3;
+#endif
+}
+
+unsigned long long bench_file_size(const WCHAR* path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &attr)) return 0;
+    return ((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+}
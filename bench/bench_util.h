@@ -0,0 +1,35 @@
+/*
+ * bench_util.h
+ * Timers and process counters for benchmarks
+ */
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include "pdf_compat.h"
+
+/*
+ * Monotonic wall clock in seconds.
+ */
+double bench_wall_seconds(void);
+
+/*
+ * User + kernel CPU time of this process in seconds (all threads).
+ */
+double bench_cpu_seconds(void);
+
+/*
+ * Bytes this process has passed to read/write calls so far.
+ * Windows: GetProcessIoCounters(); Linux: rchar/wchar of /proc/self/io.
+ * Reads through a memory mapping (how inputs are opened) are not counted.
+ *
+ * @return 1 on success, 0 if the counters are not available
+ */
+int bench_io_bytes(unsigned long long* read_bytes, unsigned long long* write_bytes);
+
+/*
+ * @return file size in bytes, 0 if the file does not exist
+ */
+unsigned long long bench_file_size(const WCHAR* path);
+
+#endif /* BENCH_UTIL_H */
@@ -0,0 +1,173 @@
+/*
+ * linear_check.c - Linearized merge and split outputs against the
+ * "fast web view" promise
+ *
+ * Generates inputs in the temp folder, writes every merge mode and every
+ * split mode with linearize = 1, and checks each output with
+ * pdf_check_linearization_ex(): hint tables valid, /L equal to the file
+ * size, and the first page section (/E) no larger than FIRST_PAGE_MAX_KB,
+ * so a viewer can show the first page after fetching only that much of
+ * outputs of 0.5 to 6 MB.
+ *
+ * Output is CSV on stdout; the exit code is the number of failed outputs
+ * (0 = all linearized):
+ *
+ *   op,mode,file_bytes,first_page_end,result
+ *
+ * Usage: linear-check [files] [pages_per_file]     (defaults: 3 32)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdf_tools.h"
+#include "bench_util.h"
+#include "synth_pdf.h"
+
+#define FIRST_PAGE_MAX_KB 256       /* 첫 페이지 구간 상한 (페이지 하나 약 130 KB + hint table) */
+#define SPLIT_CHAPTERS 4
+#define WORKER_THREADS 2
+
+static int g_failures;
+
+/* One CSV line per output; result is "ok", "not_linearized" or "first_page_<KB>kb" */
+static void check_output(const char* op, const char* mode, const WCHAR* path)
+{
+    pdf_linearization_t info;
+    pdf_error_t error;
+    char result[32];
+
+    memset(&info, 0, sizeof(info));
+    if (pdf_check_linearization_ex(path, &info, &error) != 1) {
+        strcpy(result, "not_linearized");
+    } else if (info.first_page_end > FIRST_PAGE_MAX_KB * 1024ull) {
+        sprintf(result, "first_page_%llukb", info.first_page_end / 1024ull);
+    } else {
+        strcpy(result, "ok");
+    }
+    if (strcmp(result, "ok") != 0) g_failures++;
+
+    printf("%s,%s,%llu,%llu,%s\n", op, mode, bench_file_size(path), info.first_page_end, result);
+    fflush(stdout);
+}
+
+static void check_merge(const WCHAR** paths, int count, const WCHAR* out_path)
+{
+    static const pdf_merge_mode_t modes[] = {
+        PDF_MERGE_SINGLE_PASS, PDF_MERGE_STREAMING, PDF_MERGE_TREE, PDF_MERGE_SEQUENTIAL
+    };
+    static const char* mode_names[] = { "single_pass", "streaming", "tree", "sequential" };
+    pdf_merge_options_t options;
+    pdf_error_t error;
+    int m, failed_index;
+
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        pdf_merge_options_init(&options);
+        options.mode = modes[m];
+        options.thread_count = WORKER_THREADS;
+        options.linearize = 1;
+        if (!pdf_merge_ex(paths, count, out_path, &options, NULL, NULL, &error, &failed_index)) {
+            printf("merge,%s,0,0,error_%d\n", mode_names[m], -(int)error);
+            g_failures++;
+        } else {
+            check_output("merge", mode_names[m], out_path);
+        }
+        DeleteFileW(out_path);
+    }
+}
+
+static void check_split(const WCHAR* path, int pages, const WCHAR* temp_dir)
+{
+    static const pdf_split_mode_t modes[] = { PDF_SPLIT_SERIAL, PDF_SPLIT_PARALLEL };
+    static const char* mode_names[] = { "serial", "parallel" };
+    WCHAR out_paths[SPLIT_CHAPTERS][MAX_PATH];
+    pdf_split_chapter_t chapters[SPLIT_CHAPTERS];
+    pdf_error_t results[SPLIT_CHAPTERS];
+    pdf_split_options_t options;
+    pdf_error_t error;
+    int per = pages / SPLIT_CHAPTERS;
+    int m, i;
+
+    for (i = 0; i < SPLIT_CHAPTERS; i++) {
+        swprintf_s(out_paths[i], MAX_PATH, L"%lsjpt_linear_ch_%d.pdf", temp_dir, i);
+        chapters[i].output_path = out_paths[i];
+        chapters[i].start_page = i * per + 1;
+        chapters[i].end_page = i == SPLIT_CHAPTERS - 1 ? pages : (i + 1) * per;
+        chapters[i].pages = NULL;
+    }
+
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        pdf_split_options_init(&options);
+        options.mode = modes[m];
+        options.thread_count = WORKER_THREADS;
+        options.linearize = 1;
+        pdf_document_cache_clear();
+        pdf_split_batch_ex(path, chapters, SPLIT_CHAPTERS, &options, results, NULL, NULL, &error);
+        for (i = 0; i < SPLIT_CHAPTERS; i++) {
+            if (results[i] != PDF_OK) {
+                printf("split,%s,0,0,error_%d\n", mode_names[m], -(int)results[i]);
+                g_failures++;
+            } else {
+                check_output("split", mode_names[m], out_paths[i]);
+            }
+            DeleteFileW(out_paths[i]);
+        }
+    }
+    pdf_document_cache_clear();
+}
+
+int main(int argc, char** argv)
+{
+    int files = argc > 1 ? atoi(argv[1]) : 3;
+    int pages = argc > 2 ? atoi(argv[2]) : 32;
+    WCHAR temp_dir[MAX_PATH];
+    WCHAR out_path[MAX_PATH];
+    WCHAR (*paths)[MAX_PATH];
+    const WCHAR** path_ptrs;
+    synth_pdf_options_t options;
+    int i, ok = 1;
+
+    if (files < 2 || pages < SPLIT_CHAPTERS) {
+        fprintf(stderr, "usage: linear-check [files>=2] [pages_per_file>=%d]\n", SPLIT_CHAPTERS);
+        return 2;
+    }
+
+    /* Outputs are checked by parsing them; the user's metadata index stays untouched */
+    pdf_index_set_file(NULL);
+
+    paths = (WCHAR (*)[MAX_PATH])calloc((size_t)files, sizeof(*paths));
+    path_ptrs = (const WCHAR**)calloc((size_t)files, sizeof(*path_ptrs));
+    if (!paths || !path_ptrs || GetTempPathW(MAX_PATH, temp_dir) == 0) {
+        fprintf(stderr, "setup failed\n");
+        return 100;
+    }
+    swprintf_s(out_path, MAX_PATH, L"%lsjpt_linear_out.pdf", temp_dir);
+
+    /* Every page draws the shared image, so the first page section holds it too */
+    memset(&options, 0, sizeof(options));
+    options.page_count = pages;
+    options.page_bytes = 64 * 1024;
+    options.image_bytes = 64 * 1024;
+    options.resources = SYNTH_SHARED_IMAGE;
+    for (i = 0; i < files && ok; i++) {
+        swprintf_s(paths[i], MAX_PATH, L"%lsjpt_linear_in_%03d.pdf", temp_dir, i);
+        path_ptrs[i] = paths[i];
+        options.seed = (unsigned int)i + 1;
+        ok = synth_pdf_write_ex(paths[i], &options);
+    }
+
+    if (!ok) {
+        fprintf(stderr, "failed to generate inputs\n");
+        g_failures = 100;
+    } else {
+        printf("op,mode,file_bytes,first_page_end,result\n");
+        check_merge(path_ptrs, files, out_path);
+        check_split(paths[0], pages, temp_dir);
+    }
+
+    for (i = 0; i < files; i++) DeleteFileW(paths[i]);
+    free(paths);
+    free(path_ptrs);
+    return g_failures;
+}
@@ -0,0 +1,340 @@
+/*
+ * mem_check.c - Peak memory of each merge and split strategy against its
+ * declared bound
+ *
+ * Generates inputs in the temp folder (the first one twice the size of
+ * the others, so "largest" and "total" differ) and runs every strategy in
+ * a child process of its own, so peak RSS is per strategy:
+ *
+ *   POSIX    fork(); the child sets RLIMIT_DATA to the bound, the parent
+ *            reads ru_maxrss from wait4()
+ *   Windows  the program starts itself with --child in a job object with
+ *            JOB_OBJECT_LIMIT_PROCESS_MEMORY set to the bound, and reads
+ *            PeakWorkingSetSize of the child
+ *
+ * The hard limit covers private memory only, so mapped input pages do not
+ * count against it; peak RSS includes them and is checked against the
+ * bound as well. A strategy fails if it errors (e.g. PDF_ERR_MEMORY under
+ * the limit), crashes, or its peak RSS exceeds the bound:
+ *
+ *   bound = per_largest * largest + per_total * total + MEM_BASE_MB
+ *
+ * Output is CSV on stdout; the exit code is the number of failed
+ * strategies (0 = all within bounds):
+ *
+ *   strategy,files,largest_mb,total_mb,peak_mb,bound_mb,peak_per_largest,result
+ *
+ * Usage: mem-check [files] [file_mb]     (defaults: 8 64)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdf_tools.h"
+#include "bench_util.h"
+#include "synth_pdf.h"
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define MB (1024ull * 1024ull)
+#define MEM_BASE_MB 64              /* 실행 파일, QPDF, 스레드 스택 등 고정 비용 */
+#define SPLIT_CHAPTERS 8
+#define WORKER_THREADS 2
+
+/*
+ * Declared memory bounds, in multiples of the largest input and of all
+ * inputs together. These are what the README promises per strategy.
+ */
+typedef struct mem_case {
+    const char* name;
+    int is_split;
+    int mode;                       /* pdf_merge_mode_t / pdf_split_mode_t */
+    double per_largest;
+    double per_total;
+} mem_case_t;
+
+static const mem_case_t g_cases[] = {
+    /* One input open at a time, written straight to the output */
+    { "merge_streaming",   0, PDF_MERGE_STREAMING,   3.0, 0.0 },
+    /* Every input stays open until the output is written */
+    { "merge_single_pass", 0, PDF_MERGE_SINGLE_PASS, 0.0, 3.0 },
+    /* 2 PDFs per worker, but the last round holds both halves */
+    { "merge_tree",        0, PDF_MERGE_TREE,        0.0, 3.0 },
+    /* The growing result plus the next input, at every step */
+    { "merge_sequential",  0, PDF_MERGE_SEQUENTIAL,  1.0, 3.0 },
+    /* One parsed source (the largest input) */
+    { "split_serial",      1, PDF_SPLIT_SERIAL,      3.0, 0.0 },
+    /* One parse per worker from a shared mapping */
+    { "split_parallel",    1, PDF_SPLIT_PARALLEL,    1.0 + 2.0 * WORKER_THREADS, 0.0 },
+};
+
+#define CASE_COUNT ((int)(sizeof(g_cases) / sizeof(g_cases[0])))
+
+typedef struct corpus {
+    int count;
+    int file_mb;
+    WCHAR temp_dir[MAX_PATH];
+    WCHAR (*paths)[MAX_PATH];
+    const WCHAR** path_ptrs;
+    unsigned long long largest;
+    unsigned long long total;
+} corpus_t;
+
+static void corpus_free(corpus_t* c, int delete_files)
+{
+    int i;
+    for (i = 0; delete_files && i < c->count; i++) DeleteFileW(c->paths[i]);
+    free(c->paths);
+    free(c->path_ptrs);
+    c->paths = NULL;
+    c->path_ptrs = NULL;
+}
+
+/* Same paths in the parent and in a --child process */
+static int corpus_init(corpus_t* c, int count, int file_mb)
+{
+    int i;
+
+    memset(c, 0, sizeof(*c));
+    c->count = count;
+    c->file_mb = file_mb;
+    c->paths = (WCHAR (*)[MAX_PATH])calloc((size_t)count, sizeof(*c->paths));
+    c->path_ptrs = (const WCHAR**)calloc((size_t)count, sizeof(*c->path_ptrs));
+    if (!c->paths || !c->path_ptrs || GetTempPathW(MAX_PATH, c->temp_dir) == 0) {
+        corpus_free(c, 0);
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        swprintf_s(c->paths[i], MAX_PATH, L"%lsjpt_mem_in_%03d.pdf", c->temp_dir, i);
+        c->path_ptrs[i] = c->paths[i];
+    }
+    return 1;
+}
+
+static int corpus_generate(corpus_t* c)
+{
+    synth_pdf_options_t options;
+    unsigned long long size;
+    int i;
+
+    memset(&options, 0, sizeof(options));
+    options.page_bytes = 64 * 1024;
+    options.image_bytes = 64 * 1024;
+    options.resources = SYNTH_SHARED_IMAGE;
+
+    for (i = 0; i < c->count; i++) {
+        options.seed = (unsigned int)i + 1;
+        options.page_count = synth_pdf_pages_for_size(&options, (i == 0 ? 2ull : 1ull) * c->file_mb * MB);
+        if (!synth_pdf_write_ex(c->paths[i], &options)) return 0;
+        size = bench_file_size(c->paths[i]);
+        if (size > c->largest) c->largest = size;
+        c->total += size;
+    }
+    return 1;
+}
+
+static unsigned long long case_bound(const mem_case_t* mc, const corpus_t* c)
+{
+    return (unsigned long long)(mc->per_largest * (double)c->largest + mc->per_total * (double)c->total) +
+           MEM_BASE_MB * MB;
+}
+
+/* Runs in the child process; returns its exit code (0 or -pdf_error_t) */
+static int case_run(const mem_case_t* mc, const corpus_t* c)
+{
+    WCHAR out_paths[SPLIT_CHAPTERS][MAX_PATH];
+    pdf_error_t error = PDF_OK;
+    int i, ok;
+
+    if (mc->is_split) {
+        pdf_split_chapter_t chapters[SPLIT_CHAPTERS];
+        pdf_error_t results[SPLIT_CHAPTERS];
+        pdf_split_options_t options;
+        int pages = pdf_get_page_count(c->paths[0], &error);
+        int per = pages / SPLIT_CHAPTERS;
+
+        if (per < 1) return -(int)(error != PDF_OK ? error : PDF_ERR_PAGE_OUT_OF_RANGE);
+        for (i = 0; i < SPLIT_CHAPTERS; i++) {
+            swprintf_s(out_paths[i], MAX_PATH, L"%lsjpt_mem_ch_%d.pdf", c->temp_dir, i);
+            chapters[i].output_path = out_paths[i];
+            chapters[i].start_page = i * per + 1;
+            chapters[i].end_page = i == SPLIT_CHAPTERS - 1 ? pages : (i + 1) * per;
+            chapters[i].pages = NULL;
+        }
+
+        pdf_split_options_init(&options);
+        options.mode = (pdf_split_mode_t)mc->mode;
+        options.thread_count = WORKER_THREADS;
+        ok = pdf_split_batch_ex(c->paths[0], chapters, SPLIT_CHAPTERS, &options, results,
+                                NULL, NULL, &error) == SPLIT_CHAPTERS;
+        for (i = 0; i < SPLIT_CHAPTERS; i++) {
+            if (results[i] != PDF_OK && error == PDF_OK) error = results[i];
+            DeleteFileW(out_paths[i]);
+        }
+    } else {
+        pdf_merge_options_t options;
+        int failed_index;
+
+        swprintf_s(out_paths[0], MAX_PATH, L"%lsjpt_mem_out.pdf", c->temp_dir);
+        pdf_merge_options_init(&options);
+        options.mode = (pdf_merge_mode_t)mc->mode;
+        options.thread_count = WORKER_THREADS;
+        ok = pdf_merge_ex(c->path_ptrs, c->count, out_paths[0], &options, NULL, NULL, &error, &failed_index);
+        DeleteFileW(out_paths[0]);
+    }
+
+    pdf_index_close();
+    if (ok) return 0;
+    return -(int)(error != PDF_OK ? error : PDF_ERR_UNKNOWN);
+}
+
+/*
+ * Run one strategy in a child process under a hard limit of limit bytes.
+ * @param peak_bytes peak RSS of the child
+ * @param status exit code of the child, -1 if it crashed or was killed
+ * @return 1 if the child ran, 0 if it could not be started
+ */
+#ifdef _WIN32
+
+static int case_spawn(int index, const corpus_t* c, unsigned long long limit,
+                      unsigned long long* peak_bytes, int* status)
+{
+    WCHAR exe[MAX_PATH];
+    WCHAR cmd[MAX_PATH + 64];
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+    PROCESS_MEMORY_COUNTERS pmc;
+    STARTUPINFOW si;
+    PROCESS_INFORMATION pi;
+    HANDLE job;
+    DWORD code = 0;
+
+    if (GetModuleFileNameW(NULL, exe, MAX_PATH) == 0) return 0;
+    swprintf_s(cmd, MAX_PATH + 64, L"\"%ls\" --child %d %d %d", exe, index, c->count, c->file_mb);
+
+    job = CreateJobObjectW(NULL, NULL);
+    if (!job) return 0;
+    memset(&limits, 0, sizeof(limits));
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY | JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    limits.ProcessMemoryLimit = (SIZE_T)limit;
+    SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+
+    memset(&si, 0, sizeof(si));
+    si.cb = sizeof(si);
+    if (!CreateProcessW(exe, cmd, NULL, NULL, TRUE, CREATE_SUSPENDED, NULL, NULL, &si, &pi)) {
+        CloseHandle(job);
+        return 0;
+    }
+    AssignProcessToJobObject(job, pi.hProcess);
+    ResumeThread(pi.hThread);
+    WaitForSingleObject(pi.hProcess, INFINITE);
+
+    GetExitCodeProcess(pi.hProcess, &code);
+    memset(&pmc, 0, sizeof(pmc));
+    GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof(pmc));
+    *peak_bytes = pmc.PeakWorkingSetSize;
+    /* Crashes exit with an NTSTATUS (0xC0000005 etc.) */
+    *status = code < 256 ? (int)code : -1;
+
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    CloseHandle(job);
+    return 1;
+}
+
+#else
+
+static int case_spawn(int index, const corpus_t* c, unsigned long long limit,
+                      unsigned long long* peak_bytes, int* status)
+{
+    struct rusage ru;
+    struct rlimit rl;
+    int wstatus;
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) return 0;
+    if (pid == 0) {
+        rl.rlim_cur = rl.rlim_max = (rlim_t)limit;
+        setrlimit(RLIMIT_DATA, &rl);
+        _exit(case_run(&g_cases[index], c));
+    }
+
+    if (wait4(pid, &wstatus, 0, &ru) != pid) return 0;
+    *peak_bytes = (unsigned long long)ru.ru_maxrss * 1024ull;   /* KB on Linux */
+    *status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+    return 1;
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+    int files = 8, file_mb = 64;
+    unsigned long long bound, peak;
+    corpus_t c;
+    int i, status, failures = 0;
+    const char* result;
+    char result_buf[32];
+
+    /* No hits in (or writes to) the user's metadata index, here and in the children */
+    pdf_index_set_file(NULL);
+
+    /* Windows child: mem-check --child <case> <files> <file_mb> */
+    if (argc == 5 && strcmp(argv[1], "--child") == 0) {
+        i = atoi(argv[2]);
+        if (i < 0 || i >= CASE_COUNT || !corpus_init(&c, atoi(argv[3]), atoi(argv[4]))) return 100;
+        status = case_run(&g_cases[i], &c);
+        corpus_free(&c, 0);
+        return status;
+    }
+
+    if (argc > 1) files = atoi(argv[1]);
+    if (argc > 2) file_mb = atoi(argv[2]);
+    if (files < 2 || file_mb < 1) {
+        fprintf(stderr, "usage: mem-check [files>=2] [file_mb>=1]\n");
+        return 2;
+    }
+
+    if (!corpus_init(&c, files, file_mb) || !corpus_generate(&c)) {
+        fprintf(stderr, "failed to generate inputs\n");
+        corpus_free(&c, 1);
+        return 100;
+    }
+
+    printf("strategy,files,largest_mb,total_mb,peak_mb,bound_mb,peak_per_largest,result\n");
+    for (i = 0; i < CASE_COUNT; i++) {
+        bound = case_bound(&g_cases[i], &c);
+        peak = 0;
+        status = -1;
+        if (!case_spawn(i, &c, bound, &peak, &status)) {
+            result = "spawn_failed";
+        } else if (status < 0) {
+            result = "crashed";
+        } else if (status != 0) {
+            sprintf(result_buf, "error_%d", status);
+            result = result_buf;
+        } else if (peak > bound) {
+            result = "over_bound";
+        } else {
+            result = "ok";
+        }
+        if (strcmp(result, "ok") != 0) failures++;
+
+        printf("%s,%d,%.1f,%.1f,%.1f,%.1f,%.2f,%s\n", g_cases[i].name, c.count,
+               (double)c.largest / MB, (double)c.total / MB, (double)peak / MB, (double)bound / MB,
+               (double)peak / (double)c.largest, result);
+        fflush(stdout);
+    }
+
+    corpus_free(&c, 1);
+    return failures;
+}
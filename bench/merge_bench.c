@@ -0,0 +1,101 @@
+/*
+ * merge_bench.c - Wall time of pdf_merge_ex() per merge mode
+ *
+ * Generates synthetic inputs in the temp folder and merges the first N of them
+ * for growing N. Output is CSV on stdout:
+ *
+ *   mode,files,total_pages,seconds,ms_per_page
+ *
+ * With a fixed page count per file, single-pass should keep ms_per_page
+ * flat (linear in total pages), tree should grow with log2(N) divided by
+ * the core count, and sequential keeps growing with N.
+ *
+ * Usage: merge-bench [max_files] [pages_per_file] [page_bytes]
+ *
+ * The persistent metadata index is disabled for the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pdf_tools.h"
+#include "bench_util.h"
+#include "synth_pdf.h"
+
+int main(int argc, char** argv)
+{
+    static const int file_steps[] = { 2, 5, 10, 20, 30, 40, 50, 75, 100 };
+    static const pdf_merge_mode_t modes[] = {
+        PDF_MERGE_SINGLE_PASS, PDF_MERGE_STREAMING, PDF_MERGE_TREE, PDF_MERGE_SEQUENTIAL
+    };
+    static const char* mode_names[] = { "single_pass", "streaming", "tree", "sequential" };
+    int max_files = argc > 1 ? atoi(argv[1]) : 50;
+    int pages = argc > 2 ? atoi(argv[2]) : 20;
+    int page_bytes = argc > 3 ? atoi(argv[3]) : 16 * 1024;
+    WCHAR temp_dir[MAX_PATH];
+    WCHAR out_path[MAX_PATH];
+    WCHAR (*paths)[MAX_PATH];
+    const WCHAR** path_ptrs;
+    pdf_merge_options_t options;
+    pdf_error_t error;
+    int failed_index;
+    int i, s, m, n, ok;
+    double t0, elapsed;
+
+    if (max_files < 2 || pages < 1 || page_bytes < 0) {
+        fprintf(stderr, "usage: merge-bench [max_files>=2] [pages_per_file] [page_bytes]\n");
+        return 2;
+    }
+
+    /* Measure the merges, not hits in (or writes to) the user's metadata index */
+    pdf_index_set_file(NULL);
+
+    paths = (WCHAR (*)[MAX_PATH])calloc((size_t)max_files, sizeof(*paths));
+    path_ptrs = (const WCHAR**)calloc((size_t)max_files, sizeof(*path_ptrs));
+    if (!paths || !path_ptrs || GetTempPathW(MAX_PATH, temp_dir) == 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < max_files; i++) {
+        swprintf_s(paths[i], MAX_PATH, L"%lsjpt_bench_in_%03d.pdf", temp_dir, i);
+        if (!synth_pdf_write(paths[i], pages, page_bytes, (unsigned int)i + 1)) {
+            fprintf(stderr, "failed to generate input %d\n", i);
+            return 1;
+        }
+        path_ptrs[i] = paths[i];
+    }
+    swprintf_s(out_path, MAX_PATH, L"%lsjpt_bench_out.pdf", temp_dir);
+
+    printf("mode,files,total_pages,seconds,ms_per_page\n");
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        pdf_merge_options_init(&options);
+        options.mode = modes[m];
+
+        for (s = 0; s < (int)(sizeof(file_steps) / sizeof(file_steps[0])); s++) {
+            n = file_steps[s];
+            if (n > max_files) break;
+
+            t0 = bench_wall_seconds();
+            ok = pdf_merge_ex(path_ptrs, n, out_path, &options, NULL, NULL, &error, &failed_index);
+            elapsed = bench_wall_seconds() - t0;
+
+            if (!ok) {
+                fprintf(stderr, "%s: merge of %d files failed (error %d, file %d)\n",
+                        mode_names[m], n, (int)error, failed_index);
+                continue;
+            }
+            printf("%s,%d,%d,%.3f,%.3f\n", mode_names[m], n, n * pages,
+                   elapsed, elapsed * 1000.0 / (n * pages));
+            fflush(stdout);
+        }
+    }
+
+    for (i = 0; i < max_files; i++) {
+        DeleteFileW(paths[i]);
+    }
+    DeleteFileW(out_path);
+    free(path_ptrs);
+    free(paths);
+    return 0;
+}
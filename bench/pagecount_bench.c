@@ -0,0 +1,121 @@
+/*
+ * pagecount_bench.c - pdf_get_page_count() against the old implementation
+ *
+ * Generates one large synthetic PDF in the temp folder and times:
+ *
+ *   legacy  copy the file to the temp folder, qpdf_read() it,
+ *           qpdf_get_num_pages()
+ *           (what pdf_get_page_count() did before the tail scan)
+ *   fast    pdf_get_page_count() with the metadata index disabled
+ *   indexed pdf_get_page_count() with a fresh index file in the temp folder
+ *           (run 1 computes and stores, later runs are index hits)
+ *
+ * Output is CSV on stdout:
+ *
+ *   method,file_mb,pages,run,seconds
+ *
+ * Run 1 of legacy reads the file cold if the generator output has been
+ * evicted; later runs show the warm-cache cost. fast should stay in the
+ * milliseconds regardless of file size.
+ *
+ * Usage: pagecount-bench [pages] [page_bytes] [runs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <qpdf/qpdf-c.h>
+
+#include "pdf_tools.h"
+#include "bench_util.h"
+#include "synth_pdf.h"
+
+/* The pre-tail-scan pdf_get_page_count(), minus error mapping */
+static int legacy_page_count(const WCHAR* path)
+{
+    WCHAR temp_dir[MAX_PATH], temp_path[MAX_PATH];
+    char temp_path_a[MAX_PATH];
+    qpdf_data qpdf;
+    int page_count = -1;
+
+    if (GetTempPathW(MAX_PATH, temp_dir) == 0) return -1;
+    if (GetTempFileNameW(temp_dir, L"pdf", 0, temp_path) == 0) return -1;
+    if (!CopyFileExW(path, temp_path, NULL, NULL, NULL, 0)) {
+        DeleteFileW(temp_path);
+        return -1;
+    }
+    WideCharToMultiByte(CP_UTF8, 0, temp_path, -1, temp_path_a, MAX_PATH, NULL, NULL);
+
+    qpdf = qpdf_init();
+    if (qpdf_read(qpdf, temp_path_a, NULL) < 2) {
+        page_count = qpdf_get_num_pages(qpdf);
+    }
+    qpdf_cleanup(&qpdf);
+    DeleteFileW(temp_path);
+    return page_count;
+}
+
+int main(int argc, char** argv)
+{
+    int pages = argc > 1 ? atoi(argv[1]) : 2000;
+    int page_bytes = argc > 2 ? atoi(argv[2]) : 512 * 1024;
+    int runs = argc > 3 ? atoi(argv[3]) : 3;
+    WCHAR temp_dir[MAX_PATH];
+    WCHAR path[MAX_PATH];
+    WCHAR index_path[MAX_PATH];
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    double file_mb, t0, elapsed;
+    pdf_error_t error;
+    int run, count;
+
+    if (pages < 1 || page_bytes < 0 || runs < 1) {
+        fprintf(stderr, "usage: pagecount-bench [pages] [page_bytes] [runs]\n");
+        return 2;
+    }
+
+    if (GetTempPathW(MAX_PATH, temp_dir) == 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    swprintf_s(path, MAX_PATH, L"%lsjpt_bench_pagecount.pdf", temp_dir);
+    swprintf_s(index_path, MAX_PATH, L"%lsjpt_bench_pagecount.idx", temp_dir);
+    DeleteFileW(index_path);
+    if (!synth_pdf_write(path, pages, page_bytes, 1)) {
+        fprintf(stderr, "failed to generate input\n");
+        return 1;
+    }
+    GetFileAttributesExW(path, GetFileExInfoStandard, &attr);
+    file_mb = (double)(((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow) / (1024.0 * 1024.0);
+
+    printf("method,file_mb,pages,run,seconds\n");
+    for (run = 1; run <= runs; run++) {
+        t0 = bench_wall_seconds();
+        count = legacy_page_count(path);
+        elapsed = bench_wall_seconds() - t0;
+        printf("legacy,%.1f,%d,%d,%.4f\n", file_mb, count, run, elapsed);
+
+        pdf_index_set_file(NULL);
+        t0 = bench_wall_seconds();
+        count = pdf_get_page_count(path, &error);
+        elapsed = bench_wall_seconds() - t0;
+        printf("fast,%.1f,%d,%d,%.4f\n", file_mb, count, run, elapsed);
+
+        if (!pdf_index_set_file(index_path)) {
+            fprintf(stderr, "index path too long\n");
+            return 1;
+        }
+        t0 = bench_wall_seconds();
+        count = pdf_get_page_count(path, &error);
+        elapsed = bench_wall_seconds() - t0;
+        printf("indexed,%.1f,%d,%d,%.4f\n", file_mb, count, run, elapsed);
+        fflush(stdout);
+
+        if (count != pages) {
+            fprintf(stderr, "page count mismatch: %d (error %d), expected %d\n", count, (int)error, pages);
+        }
+    }
+
+    pdf_index_close();
+    DeleteFileW(index_path);
+    DeleteFileW(path);
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*
+ * suite_bench.c - Merge, split and page count over a generated corpus
+ *
+ * Two sweeps, each on a fresh synthetic corpus in the temp folder:
+ *
+ *   count sweep  2 .. max_files files of 1 MB
+ *   size sweep   2 files of 1 MB .. max_mb MB
+ *
+ * For every corpus it times:
+ *
+ *   pages        pdf_get_page_count() of every file (index disabled)
+ *   merge        pdf_merge_ex() of all files, per merge mode
+ *                (sequential only up to seq_max files, it is quadratic)
+ *   split        pdf_split_batch_ex() of the first file into 10 chapters,
+ *                serial and parallel (document cache cleared first)
+ *
+ * Merge and split use each operation's default output profile; with
+ * --profiles they run once per profile (fast, standard, compact) so the
+ * CPU time and output size of each can be compared. Streaming merge
+ * ignores the profile and runs once.
+ *
+ * One record per run, CSV (default) or a JSON array:
+ *
+ *   op,mode,profile,files,file_mb,pages,wall_s,cpu_s,in_bytes,out_bytes,io_read,io_write,error
+ *
+ * in_bytes/out_bytes are input and output file sizes; io_read/io_write are
+ * the process read/write counters over the run (mapped input reads are not
+ * included). cpu_s counts every thread, so cpu_s > wall_s means parallelism.
+ *
+ * Usage: bench-suite [--json] [--max-files N] [--max-mb N] [--seq-max N]
+ *                    [--pattern font|image|private|scan] [--profiles] [--linearize] [--dedup]
+ *
+ * --pattern scan models scanned documents: every page is one private
+ * image with a tiny content stream.
+ *
+ * --linearize writes every merge and split output linearized and checks
+ * it with pdf_check_linearization() (hint tables valid, first page
+ * section ahead of the rest); a failed check is recorded as error 1000
+ * and makes bench-suite exit with 3 once every run is done.
+ *
+ * --dedup merges with stream deduplication; compare out_bytes with a run
+ * without it. Streaming merges then run as single pass.
+ *
+ * Defaults: --max-files 1000 --max-mb 256 --seq-max 100 --pattern font.
+ * --max-mb 2048 runs the full size sweep (needs about 10 GB of free space).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdf_tools.h"
+#include "bench_util.h"
+#include "synth_pdf.h"
+
+#define MB (1024ull * 1024ull)
+#define SPLIT_CHAPTERS 10
+#define ERROR_NOT_LINEARIZED 1000
+
+typedef struct bench_record {
+    const char* op;
+    const char* mode;
+    const char* profile;
+    int files;
+    double file_mb;
+    long long pages;
+    double wall;
+    double cpu;
+    unsigned long long in_bytes;
+    unsigned long long out_bytes;
+    unsigned long long io_read;
+    unsigned long long io_write;
+    int error;
+} bench_record_t;
+
+typedef struct bench_run {
+    double wall0, cpu0;
+    unsigned long long read0, write0;
+} bench_run_t;
+
+static int g_json;
+static int g_records;
+static int g_profiles;              /* 1 = merge/split once per output profile */
+static int g_linearize;             /* 1 = linearized outputs, checked after each run */
+static int g_dedup;                 /* 1 = merge with stream deduplication */
+static int g_not_linearized;        /* outputs that failed the --linearize check */
+
+/* With --linearize, a written output must pass the linearization check */
+static void check_output(bench_record_t* rec, const WCHAR* path)
+{
+    if (g_linearize && rec->error == 0 && pdf_check_linearization(path, NULL) != 1) {
+        rec->error = ERROR_NOT_LINEARIZED;
+        g_not_linearized++;
+    }
+}
+
+static const pdf_output_profile_t k_profiles[] = { PDF_OUTPUT_FAST, PDF_OUTPUT_STANDARD, PDF_OUTPUT_COMPACT };
+
+static const char* profile_name(pdf_output_profile_t profile)
+{
+    switch (profile) {
+    case PDF_OUTPUT_FAST: return "fast";
+    case PDF_OUTPUT_COMPACT: return "compact";
+    default: return "standard";
+    }
+}
+
+static void run_begin(bench_run_t* run)
+{
+    bench_io_bytes(&run->read0, &run->write0);
+    run->cpu0 = bench_cpu_seconds();
+    run->wall0 = bench_wall_seconds();
+}
+
+static void run_end(const bench_run_t* run, bench_record_t* rec)
+{
+    unsigned long long r = 0, w = 0;
+
+    rec->wall = bench_wall_seconds() - run->wall0;
+    rec->cpu = bench_cpu_seconds() - run->cpu0;
+    if (bench_io_bytes(&r, &w)) {
+        rec->io_read = r - run->read0;
+        rec->io_write = w - run->write0;
+    }
+}
+
+static void emit(const bench_record_t* rec)
+{
+    if (g_json) {
+        printf("%s\n  {\"op\": \"%s\", \"mode\": \"%s\", \"profile\": \"%s\", \"files\": %d,"
+               " \"file_mb\": %.1f, \"pages\": %lld, \"wall_s\": %.4f, \"cpu_s\": %.4f, \"in_bytes\": %llu,"
+               " \"out_bytes\": %llu, \"io_read\": %llu, \"io_write\": %llu, \"error\": %d}",
+               g_records ? "," : "[", rec->op, rec->mode, rec->profile, rec->files, rec->file_mb, rec->pages,
+               rec->wall, rec->cpu, rec->in_bytes, rec->out_bytes, rec->io_read, rec->io_write,
+               rec->error);
+    } else {
+        if (!g_records) {
+            printf("op,mode,profile,files,file_mb,pages,wall_s,cpu_s,in_bytes,out_bytes,io_read,io_write,error\n");
+        }
+        printf("%s,%s,%s,%d,%.1f,%lld,%.4f,%.4f,%llu,%llu,%llu,%llu,%d\n",
+               rec->op, rec->mode, rec->profile, rec->files, rec->file_mb, rec->pages, rec->wall, rec->cpu,
+               rec->in_bytes, rec->out_bytes, rec->io_read, rec->io_write, rec->error);
+    }
+    g_records++;
+    fflush(stdout);
+}
+
+typedef struct corpus {
+    int count;
+    double file_mb;
+    int pages_per_file;
+    WCHAR (*paths)[MAX_PATH];
+    const WCHAR** path_ptrs;
+    unsigned long long total_bytes;
+} corpus_t;
+
+static void corpus_free(corpus_t* c)
+{
+    int i;
+    for (i = 0; i < c->count; i++) DeleteFileW(c->paths[i]);
+    free(c->paths);
+    free(c->path_ptrs);
+    memset(c, 0, sizeof(*c));
+}
+
+static int corpus_make(corpus_t* c, const WCHAR* temp_dir, int count, unsigned long long file_bytes,
+                       synth_pdf_options_t* options)
+{
+    int i;
+
+    memset(c, 0, sizeof(*c));
+    c->paths = (WCHAR (*)[MAX_PATH])calloc((size_t)count, sizeof(*c->paths));
+    c->path_ptrs = (const WCHAR**)calloc((size_t)count, sizeof(*c->path_ptrs));
+    if (!c->paths || !c->path_ptrs) {
+        corpus_free(c);
+        return 0;
+    }
+
+    options->page_count = synth_pdf_pages_for_size(options, file_bytes);
+    c->pages_per_file = options->page_count;
+    c->file_mb = (double)file_bytes / MB;
+    for (i = 0; i < count; i++) {
+        swprintf_s(c->paths[i], MAX_PATH, L"%lsjpt_suite_in_%04d.pdf", temp_dir, i);
+        options->seed = (unsigned int)i + 1;
+        c->count = i + 1;
+        if (!synth_pdf_write_ex(c->paths[i], options)) {
+            fprintf(stderr, "failed to generate input %d\n", i);
+            corpus_free(c);
+            return 0;
+        }
+        c->path_ptrs[i] = c->paths[i];
+        c->total_bytes += bench_file_size(c->paths[i]);
+    }
+    return 1;
+}
+
+static void record_init(bench_record_t* rec, const char* op, const char* mode, const corpus_t* c, int files)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->op = op;
+    rec->mode = mode;
+    rec->profile = "-";
+    rec->files = files;
+    rec->file_mb = c->file_mb;
+    rec->pages = (long long)c->pages_per_file * files;
+}
+
+static void bench_pages(const corpus_t* c)
+{
+    bench_record_t rec;
+    bench_run_t run;
+    pdf_error_t error = PDF_OK;
+    int i;
+
+    pdf_index_set_file(NULL);
+    record_init(&rec, "pages", "tail_scan", c, c->count);
+    rec.in_bytes = c->total_bytes;
+    run_begin(&run);
+    for (i = 0; i < c->count; i++) {
+        if (pdf_get_page_count(c->paths[i], &error) != c->pages_per_file && rec.error == 0) {
+            rec.error = error != PDF_OK ? (int)error : PDF_ERR_UNKNOWN;
+        }
+    }
+    run_end(&run, &rec);
+    emit(&rec);
+}
+
+static void bench_merge(const corpus_t* c, const WCHAR* out_path, int seq_max)
+{
+    static const pdf_merge_mode_t modes[] = {
+        PDF_MERGE_SINGLE_PASS, PDF_MERGE_STREAMING, PDF_MERGE_TREE, PDF_MERGE_SEQUENTIAL
+    };
+    static const char* mode_names[] = { "single_pass", "streaming", "tree", "sequential" };
+    pdf_merge_options_t options;
+    bench_record_t rec;
+    bench_run_t run;
+    pdf_error_t error;
+    int m, p, profile_count, failed_index;
+
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        if (modes[m] == PDF_MERGE_SEQUENTIAL && c->count > seq_max) continue;
+
+        profile_count = g_profiles && modes[m] != PDF_MERGE_STREAMING ? 3 : 1;
+        for (p = 0; p < profile_count; p++) {
+            pdf_merge_options_init(&options);
+            options.mode = modes[m];
+            if (g_profiles) options.profile = k_profiles[p];
+            options.linearize = g_linearize;
+            options.dedup = g_dedup;
+            record_init(&rec, "merge", mode_names[m], c, c->count);
+            rec.profile = modes[m] == PDF_MERGE_STREAMING && !g_linearize && !g_dedup
+                ? "raw" : profile_name(options.profile);
+            rec.in_bytes = c->total_bytes;
+
+            run_begin(&run);
+            if (!pdf_merge_ex(c->path_ptrs, c->count, out_path, &options, NULL, NULL, &error, &failed_index)) {
+                rec.error = (int)error;
+            }
+            run_end(&run, &rec);
+            rec.out_bytes = bench_file_size(out_path);
+            check_output(&rec, out_path);
+            DeleteFileW(out_path);
+            emit(&rec);
+        }
+    }
+}
+
+static void bench_split(const corpus_t* c, const WCHAR* temp_dir)
+{
+    static const pdf_split_mode_t modes[] = { PDF_SPLIT_SERIAL, PDF_SPLIT_PARALLEL };
+    static const char* mode_names[] = { "serial", "parallel" };
+    WCHAR out_paths[SPLIT_CHAPTERS][MAX_PATH];
+    pdf_split_chapter_t chapters[SPLIT_CHAPTERS];
+    pdf_error_t results[SPLIT_CHAPTERS];
+    pdf_split_options_t options;
+    bench_record_t rec;
+    bench_run_t run;
+    pdf_error_t error;
+    int chapter_count, per, m, p, i;
+
+    chapter_count = c->pages_per_file < SPLIT_CHAPTERS ? c->pages_per_file : SPLIT_CHAPTERS;
+    per = c->pages_per_file / chapter_count;
+    for (i = 0; i < chapter_count; i++) {
+        swprintf_s(out_paths[i], MAX_PATH, L"%lsjpt_suite_ch_%02d.pdf", temp_dir, i);
+        chapters[i].output_path = out_paths[i];
+        chapters[i].start_page = i * per + 1;
+        chapters[i].end_page = i == chapter_count - 1 ? c->pages_per_file : (i + 1) * per;
+        chapters[i].pages = NULL;
+    }
+
+    for (m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        for (p = 0; p < (g_profiles ? 3 : 1); p++) {
+            pdf_split_options_init(&options);
+            options.mode = modes[m];
+            if (g_profiles) options.profile = k_profiles[p];
+            options.linearize = g_linearize;
+            pdf_document_cache_clear();
+            record_init(&rec, "split", mode_names[m], c, 1);
+            rec.profile = profile_name(options.profile);
+            rec.in_bytes = bench_file_size(c->paths[0]);
+
+            run_begin(&run);
+            if (pdf_split_batch_ex(c->paths[0], chapters, chapter_count, &options, results,
+                                   NULL, NULL, &error) != chapter_count) {
+                rec.error = error != PDF_OK ? (int)error : (int)PDF_ERR_WRITE_FAILED;
+            }
+            run_end(&run, &rec);
+            for (i = 0; i < chapter_count; i++) {
+                rec.out_bytes += bench_file_size(out_paths[i]);
+                check_output(&rec, out_paths[i]);
+                DeleteFileW(out_paths[i]);
+            }
+            emit(&rec);
+        }
+    }
+    pdf_document_cache_clear();
+}
+
+static int run_corpus(const WCHAR* temp_dir, int count, unsigned long long file_bytes,
+                      synth_pdf_options_t* options, int seq_max)
+{
+    WCHAR out_path[MAX_PATH];
+    corpus_t c;
+
+    if (!corpus_make(&c, temp_dir, count, file_bytes, options)) return 0;
+    swprintf_s(out_path, MAX_PATH, L"%lsjpt_suite_out.pdf", temp_dir);
+
+    bench_pages(&c);
+    bench_merge(&c, out_path, seq_max);
+    bench_split(&c, temp_dir);
+
+    corpus_free(&c);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    static const int count_steps[] = { 2, 5, 10, 25, 50, 100, 250, 500, 1000 };
+    static const int mb_steps[] = { 1, 4, 16, 64, 256, 512, 1024, 2048 };
+    int max_files = 1000, max_mb = 256, seq_max = 100;
+    synth_pdf_options_t options;
+    WCHAR temp_dir[MAX_PATH];
+    int i;
+
+    memset(&options, 0, sizeof(options));
+    options.page_bytes = 64 * 1024;
+    options.image_bytes = 256 * 1024;
+    options.resources = SYNTH_SHARED_FONT;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            g_json = 1;
+        } else if (strcmp(argv[i], "--max-files") == 0 && i + 1 < argc) {
+            max_files = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-mb") == 0 && i + 1 < argc) {
+            max_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seq-max") == 0 && i + 1 < argc) {
+            seq_max = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profiles") == 0) {
+            g_profiles = 1;
+        } else if (strcmp(argv[i], "--linearize") == 0) {
+            g_linearize = 1;
+        } else if (strcmp(argv[i], "--dedup") == 0) {
+            g_dedup = 1;
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "font") == 0) {
+                options.resources = SYNTH_SHARED_FONT;
+            } else if (strcmp(argv[i], "image") == 0) {
+                options.resources = SYNTH_SHARED_IMAGE;
+            } else if (strcmp(argv[i], "private") == 0) {
+                options.resources = SYNTH_PRIVATE_RESOURCES;
+                options.image_bytes = 16 * 1024;
+                options.page_bytes = 16 * 1024;
+            } else if (strcmp(argv[i], "scan") == 0) {
+                options.resources = SYNTH_PRIVATE_RESOURCES;
+                options.image_bytes = 128 * 1024;
+                options.page_bytes = 256;
+            } else {
+                max_files = 0;
+            }
+        } else {
+            max_files = 0;
+        }
+    }
+    if (max_files < 2 || max_mb < 1) {
+        fprintf(stderr, "usage: bench-suite [--json] [--max-files N>=2] [--max-mb N>=1] [--seq-max N]"
+                        " [--pattern font|image|private|scan] [--profiles] [--linearize] [--dedup]\n");
+        return 2;
+    }
+    if (GetTempPathW(MAX_PATH, temp_dir) == 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    /* Every run parses its inputs; the user's metadata index stays untouched */
+    pdf_index_set_file(NULL);
+
+    /* Count sweep at 1 MB per file */
+    for (i = 0; i < (int)(sizeof(count_steps) / sizeof(count_steps[0])); i++) {
+        if (count_steps[i] > max_files) break;
+        if (!run_corpus(temp_dir, count_steps[i], MB, &options, seq_max)) return 1;
+    }
+
+    /* Size sweep with 2 files (1 MB is already covered above) */
+    for (i = 1; i < (int)(sizeof(mb_steps) / sizeof(mb_steps[0])); i++) {
+        if (mb_steps[i] > max_mb) break;
+        if (!run_corpus(temp_dir, 2, (unsigned long long)mb_steps[i] * MB, &options, seq_max)) return 1;
+    }
+
+    if (g_json) printf("%s]\n", g_records ? "\n" : "[");
+    if (g_not_linearized) {
+        fprintf(stderr, "%d outputs failed the linearization check\n", g_not_linearized);
+        return 3;
+    }
+    return 0;
+}
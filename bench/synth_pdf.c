@@ -0,0 +1,180 @@
+/*
+ * synth_pdf.c - Synthetic PDF generator for benchmarks
+ *
+ * Object layout:
+ *   1          Catalog
+ *   2          Pages (flat, all pages are direct kids)
+ *   3          shared Helvetica font
+ *   4          shared image (SYNTH_SHARED_IMAGE only)
+ *   then per page i: page, content stream
+ *                    [, font, image] (SYNTH_PRIVATE_RESOURCES)
+ */
+
+#include "synth_pdf.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define IMAGE_WIDTH 256
+#define PAGE_OVERHEAD 260           /* page dictionary and stream wrapper bytes */
+
+/* Small LCG so the output only depends on the seed */
+static unsigned int next_rand(unsigned int* state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+static int image_height(int image_bytes)
+{
+    int h = image_bytes / IMAGE_WIDTH;
+    return h > 0 ? h : 1;
+}
+
+/* 8-bit gray image of random pixels, about image_bytes */
+static void write_image(FILE* f, int obj, int image_bytes, unsigned int* state)
+{
+    unsigned char row[IMAGE_WIDTH];
+    int h = image_height(image_bytes);
+    int y, x;
+
+    fprintf(f, "%d 0 obj\n<< /Type /XObject /Subtype /Image /Width %d /Height %d"
+               " /ColorSpace /DeviceGray /BitsPerComponent 8 /Length %lld >>\nstream\n",
+            obj, IMAGE_WIDTH, h, (long long)IMAGE_WIDTH * h);
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < IMAGE_WIDTH; x++) {
+            row[x] = (unsigned char)next_rand(state);
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fprintf(f, "\nendstream\nendobj\n");
+}
+
+int synth_pdf_write_ex(const WCHAR* path, const synth_pdf_options_t* options)
+{
+    FILE* f;
+    long long* offsets;
+    long long xref_offset;
+    int first_page_obj, per_page, obj_count, i, obj, written;
+    int font_obj, image_obj;
+    char line[80];
+    char text[192];
+    int text_len, filler_len, line_len, k;
+    unsigned int state = options->seed;
+    synth_resources_t res = options->resources;
+
+    if (options->page_count < 1) return 0;
+
+    first_page_obj = res == SYNTH_SHARED_IMAGE ? 5 : 4;
+    per_page = res == SYNTH_PRIVATE_RESOURCES ? 4 : 2;
+    obj_count = first_page_obj - 1 + options->page_count * per_page;
+    offsets = (long long*)calloc((size_t)obj_count + 1, sizeof(long long));
+    if (!offsets) return 0;
+
+    f = _wfopen(path, L"wb");
+    if (!f) {
+        free(offsets);
+        return 0;
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 16);
+
+    fprintf(f, "%%PDF-1.4\n%%\xE2\xE3\xCF\xD3\n");
+
+    offsets[1] = _ftelli64(f);
+    fprintf(f, "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+    offsets[2] = _ftelli64(f);
+    fprintf(f, "2 0 obj\n<< /Type /Pages /Count %d /Kids [", options->page_count);
+    for (i = 0; i < options->page_count; i++) {
+        fprintf(f, "%s%d 0 R", i ? " " : "", first_page_obj + per_page * i);
+    }
+    fprintf(f, "] >>\nendobj\n");
+
+    offsets[3] = _ftelli64(f);
+    fprintf(f, "3 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>\nendobj\n");
+
+    if (res == SYNTH_SHARED_IMAGE) {
+        offsets[4] = _ftelli64(f);
+        write_image(f, 4, options->image_bytes, &state);
+    }
+
+    for (i = 0; i < options->page_count; i++) {
+        obj = first_page_obj + per_page * i;
+        font_obj = res == SYNTH_PRIVATE_RESOURCES ? obj + 2 : 3;
+        image_obj = res == SYNTH_PRIVATE_RESOURCES ? obj + 3 : (res == SYNTH_SHARED_IMAGE ? 4 : 0);
+
+        offsets[obj] = _ftelli64(f);
+        fprintf(f, "%d 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842]"
+                   " /Resources << /Font << /F1 %d 0 R >>", obj, font_obj);
+        if (image_obj) fprintf(f, " /XObject << /Im1 %d 0 R >>", image_obj);
+        fprintf(f, " >> /Contents %d 0 R >>\nendobj\n", obj + 1);
+
+        /* Visible text (and image), then comment lines of filler up to page_bytes */
+        text_len = sprintf(text, "BT /F1 24 Tf 72 720 Td (Seed %u page %d) Tj ET\n%s",
+                           options->seed, i + 1, image_obj ? "q 256 0 0 256 72 400 cm /Im1 Do Q\n" : "");
+        filler_len = options->page_bytes > text_len ? options->page_bytes - text_len : 0;
+
+        offsets[obj + 1] = _ftelli64(f);
+        fprintf(f, "%d 0 obj\n<< /Length %d >>\nstream\n", obj + 1, text_len + filler_len);
+        fwrite(text, 1, (size_t)text_len, f);
+        written = 0;
+        while (written < filler_len) {
+            line_len = filler_len - written;
+            if (line_len > (int)sizeof(line)) line_len = (int)sizeof(line);
+            line[0] = '%';
+            for (k = 1; k < line_len - 1; k++) {
+                line[k] = (char)('A' + next_rand(&state) % 26);
+            }
+            line[line_len - 1] = '\n';
+            fwrite(line, 1, (size_t)line_len, f);
+            written += line_len;
+        }
+        fprintf(f, "\nendstream\nendobj\n");
+
+        if (res == SYNTH_PRIVATE_RESOURCES) {
+            offsets[obj + 2] = _ftelli64(f);
+            fprintf(f, "%d 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica"
+                       " /Name /F%d >>\nendobj\n", obj + 2, i + 1);
+            offsets[obj + 3] = _ftelli64(f);
+            write_image(f, obj + 3, options->image_bytes, &state);
+        }
+    }
+
+    xref_offset = _ftelli64(f);
+    fprintf(f, "xref\n0 %d\n0000000000 65535 f \n", obj_count + 1);
+    for (i = 1; i <= obj_count; i++) {
+        fprintf(f, "%010lld 00000 n \n", offsets[i]);
+    }
+    fprintf(f, "trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%lld\n%%%%EOF\n",
+            obj_count + 1, xref_offset);
+
+    free(offsets);
+    i = ferror(f);
+    return (fclose(f) == 0 && !i) ? 1 : 0;
+}
+
+int synth_pdf_write(const WCHAR* path, int page_count, int page_bytes, unsigned int seed)
+{
+    synth_pdf_options_t options;
+
+    options.page_count = page_count;
+    options.page_bytes = page_bytes;
+    options.image_bytes = 0;
+    options.resources = SYNTH_SHARED_FONT;
+    options.seed = seed;
+    return synth_pdf_write_ex(path, &options);
+}
+
+int synth_pdf_pages_for_size(const synth_pdf_options_t* options, unsigned long long target_bytes)
+{
+    unsigned long long image = (unsigned long long)IMAGE_WIDTH * image_height(options->image_bytes);
+    unsigned long long per_page = (unsigned long long)options->page_bytes + PAGE_OVERHEAD;
+    unsigned long long pages;
+
+    if (options->resources == SYNTH_SHARED_IMAGE && target_bytes > image) target_bytes -= image;
+    if (options->resources == SYNTH_PRIVATE_RESOURCES) per_page += image + 2 * PAGE_OVERHEAD;
+
+    pages = target_bytes / per_page;
+    if (pages < 1) pages = 1;
+    if (pages > 0x7fffffff) pages = 0x7fffffff;
+    return (int)pages;
+}
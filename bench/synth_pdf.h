@@ -0,0 +1,56 @@
+/*
+ * synth_pdf.h
+ * Synthetic PDF generator for benchmarks
+ */
+
+#ifndef SYNTH_PDF_H
+#define SYNTH_PDF_H
+
+#include "pdf_compat.h"
+
+/*
+ * How pages share resources.
+ */
+typedef enum {
+    SYNTH_SHARED_FONT = 0,          /* 모든 페이지가 폰트 1개 공유 (기본값) */
+    SYNTH_SHARED_IMAGE,             /* 폰트 + 이미지 1개를 모든 페이지가 공유 */
+    SYNTH_PRIVATE_RESOURCES         /* 페이지마다 자기 폰트와 이미지 */
+} synth_resources_t;
+
+typedef struct synth_pdf_options {
+    int page_count;                 /* 페이지 수 (1 이상) */
+    int page_bytes;                 /* 페이지당 content stream 크기 (대략) */
+    int image_bytes;                /* 이미지 stream 크기 (SHARED_IMAGE / PRIVATE_RESOURCES) */
+    synth_resources_t resources;
+    unsigned int seed;              /* filler 바이트 seed (seed가 다르면 다른 파일) */
+} synth_pdf_options_t;
+
+/*
+ * Write a PDF as described by options.
+ * Content streams are padded with comment lines; image data is random
+ * bytes, so neither compresses much.
+ *
+ * @return 1 on success, 0 on failure
+ */
+int synth_pdf_write_ex(const WCHAR* path, const synth_pdf_options_t* options);
+
+/*
+ * Write a simple PDF with page_count pages.
+ * Every page shares one font object and has its own content stream,
+ * padded with comment lines up to about page_bytes bytes.
+ *
+ * @param path output PDF path
+ * @param page_count number of pages (1 or more)
+ * @param page_bytes approximate content stream size per page
+ * @param seed seed for the filler bytes (different seeds give different files)
+ * @return 1 on success, 0 on failure
+ */
+int synth_pdf_write(const WCHAR* path, int page_count, int page_bytes, unsigned int seed);
+
+/*
+ * Page count that makes a file of about target_bytes with these options
+ * (page_count is ignored). At least 1.
+ */
+int synth_pdf_pages_for_size(const synth_pdf_options_t* options, unsigned long long target_bytes);
+
+#endif /* SYNTH_PDF_H */
@@ -0,0 +1,553 @@
+/*
+ * cli.c - Command-line front end (no GUI, runs on Windows and Linux)
+ *
+ * Usage:
+ *   jun-pdf-cli pages [options] <in.pdf>...
+ *   jun-pdf-cli split [options] <in.pdf> <start-end:out.pdf>...
+ *   jun-pdf-cli merge [options] -o <out.pdf> <in.pdf>...
+ *   jun-pdf-cli check-linear <in.pdf>...
+ *
+ * Options:
+ *   --mode <m>       merge: single | sequential | tree | streaming
+ *                    split: serial | parallel
+ *   --threads <n>    worker threads for tree merge / parallel split
+ *   --profile <p>    output: fast | standard | compact
+ *                    (default: compact for split, standard for merge)
+ *   --linearize      write linearized ("fast web view") output
+ *   --dedup          merge: store identical streams (fonts, images) once
+ *   --duplicates <d> merge: report | drop pages equal to an earlier page;
+ *                    each one is listed on stdout as
+ *                    "duplicate|dropped <TAB> file <TAB> page <TAB> first file <TAB> first page"
+ *   --timeout <ms>   cancel the operation after ms milliseconds
+ *   --progress       page progress on stderr
+ *   --stats          timing and counters on stderr when done
+ *   --log <file>     debug log, appended to file ("-" = stderr)
+ *   --log-level <l>  error | warn | info | debug (default debug)
+ *   --trace <file>   timeline of the operation as Chrome trace JSON (Perfetto)
+ *
+ * Exit code: 0 on success, otherwise -pdf_error_t of the first failure
+ * (1 = file not found ... 9 = cancelled, 10 = invalid argument (path too long),
+ * 99 = unknown), 64 for bad usage.
+ * check-linear exits with 65 if a readable file is not linearized or its
+ * hint tables are invalid.
+ * Ctrl+C cancels the running operation; no partial output is left behind.
+ */
+
+#include "pdf_tools.h"
+#include "pdf_compat.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXIT_USAGE 64
+#define EXIT_NOT_LINEARIZED 65
+#define DUPLICATES_MAX 4096         /* duplicate pages listed by merge --duplicates */
+
+static pdf_cancel_t g_cancel;
+
+static void on_interrupt(int sig)
+{
+    (void)sig;
+    pdf_cancel_request(&g_cancel);
+}
+
+static int exit_code(pdf_error_t error)
+{
+    return error == PDF_OK ? 0 : -(int)error;
+}
+
+/* Print a wide string as UTF-8 */
+static void put_w(FILE* f, const wchar_t* s)
+{
+    char buf[MAX_PATH * 4];
+    if (WideCharToMultiByte(CP_UTF8, 0, s, -1, buf, (int)sizeof(buf), NULL, NULL) == 0) {
+        fputs("?", f);
+        return;
+    }
+    fputs(buf, f);
+}
+
+static void report_error(const wchar_t* path, pdf_error_t error)
+{
+    if (path) {
+        put_w(stderr, path);
+        fputs(": ", stderr);
+    }
+    put_w(stderr, pdf_error_message(error));
+    fprintf(stderr, " (%d)\n", (int)error);
+}
+
+static void print_progress(const pdf_progress_info_t* info, void* user_data)
+{
+    (void)user_data;
+    fprintf(stderr, "\r%lld/%lld pages  %.1f MB/s", info->pages_done, info->pages_total, info->mb_per_sec);
+    if (info->eta >= 0) fprintf(stderr, "  ETA %.0fs  ", info->eta);
+    if (info->pages_done >= info->pages_total) fputc('\n', stderr);
+    fflush(stderr);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: jun-pdf-cli pages [options] <in.pdf>...\n"
+            "       jun-pdf-cli split [options] <in.pdf> <pages:out.pdf>...\n"
+            "       jun-pdf-cli merge [options] -o <out.pdf> <in.pdf>...\n"
+            "       jun-pdf-cli check-linear <in.pdf>...\n"
+            "options: --mode <m> --threads <n> --profile <fast|standard|compact>\n"
+            "         --linearize --dedup --duplicates <report|drop>\n"
+            "         --timeout <ms> --progress --stats\n"
+            "         --log <file> --log-level <error|warn|info|debug> --trace <file.json>\n"
+            "pages:   1-10, 1-3,10,7-9 (in that order), 5-1 (reverse), 8-$ ($ = last page)\n");
+}
+
+static void print_stats(const pdf_stats_t* stats)
+{
+    wchar_t buf[320];
+    pdf_stats_format(stats, buf, (int)(sizeof(buf) / sizeof(buf[0])));
+    fputs("stats: ", stderr);
+    put_w(stderr, buf);
+    fputc('\n', stderr);
+}
+
+/* Options shared by the commands */
+typedef struct cli_options {
+    const wchar_t* mode;
+    const wchar_t* profile;
+    const wchar_t* output;
+    int threads;
+    unsigned long timeout_ms;
+    int progress;
+    int stats;
+    int linearize;
+    int dedup;
+    const wchar_t* duplicates;
+    const wchar_t* log_path;
+    pdf_log_level_t log_level;
+    const wchar_t* trace_path;
+} cli_options_t;
+
+static int parse_log_level(const wchar_t* name, pdf_log_level_t* level)
+{
+    if (wcscmp(name, L"error") == 0) {
+        *level = PDF_LOG_ERROR;
+    } else if (wcscmp(name, L"warn") == 0) {
+        *level = PDF_LOG_WARN;
+    } else if (wcscmp(name, L"info") == 0) {
+        *level = PDF_LOG_INFO;
+    } else if (wcscmp(name, L"debug") == 0) {
+        *level = PDF_LOG_DEBUG;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/* Leaves *profile unchanged when name is NULL */
+static int parse_profile(const wchar_t* name, pdf_output_profile_t* profile)
+{
+    if (!name) return 1;
+    if (wcscmp(name, L"fast") == 0) {
+        *profile = PDF_OUTPUT_FAST;
+    } else if (wcscmp(name, L"standard") == 0) {
+        *profile = PDF_OUTPUT_STANDARD;
+    } else if (wcscmp(name, L"compact") == 0) {
+        *profile = PDF_OUTPUT_COMPACT;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Consume leading options. Returns the index of the first operand, or -1
+ * on a bad option.
+ */
+static int parse_options(int argc, wchar_t** argv, int i, cli_options_t* opts)
+{
+    memset(opts, 0, sizeof(*opts));
+    opts->log_level = PDF_LOG_DEBUG;
+    for (; i < argc && argv[i][0] == L'-' && argv[i][1]; i++) {
+        const wchar_t* arg = argv[i];
+        if (wcscmp(arg, L"--") == 0) return i + 1;
+        if (wcscmp(arg, L"--progress") == 0) {
+            opts->progress = 1;
+            continue;
+        }
+        if (wcscmp(arg, L"--stats") == 0) {
+            opts->stats = 1;
+            continue;
+        }
+        if (wcscmp(arg, L"--linearize") == 0) {
+            opts->linearize = 1;
+            continue;
+        }
+        if (wcscmp(arg, L"--dedup") == 0) {
+            opts->dedup = 1;
+            continue;
+        }
+        if (i + 1 >= argc) return -1;
+        if (wcscmp(arg, L"--mode") == 0) {
+            opts->mode = argv[++i];
+        } else if (wcscmp(arg, L"--profile") == 0) {
+            opts->profile = argv[++i];
+        } else if (wcscmp(arg, L"--duplicates") == 0) {
+            opts->duplicates = argv[++i];
+        } else if (wcscmp(arg, L"-o") == 0 || wcscmp(arg, L"--output") == 0) {
+            opts->output = argv[++i];
+        } else if (wcscmp(arg, L"--threads") == 0) {
+            opts->threads = (int)wcstol(argv[++i], NULL, 10);
+            if (opts->threads < 0) return -1;
+        } else if (wcscmp(arg, L"--timeout") == 0) {
+            opts->timeout_ms = wcstoul(argv[++i], NULL, 10);
+        } else if (wcscmp(arg, L"--log") == 0) {
+            opts->log_path = argv[++i];
+        } else if (wcscmp(arg, L"--log-level") == 0) {
+            if (!parse_log_level(argv[++i], &opts->log_level)) return -1;
+        } else if (wcscmp(arg, L"--trace") == 0) {
+            opts->trace_path = argv[++i];
+        } else {
+            return -1;
+        }
+    }
+    return i;
+}
+
+static int g_tracing = 0;
+
+/* Start the debug log and the trace if asked for; closed in cli_main */
+static void open_log(const cli_options_t* opts)
+{
+    if (opts->log_path &&
+        !pdf_log_open(wcscmp(opts->log_path, L"-") == 0 ? NULL : opts->log_path, opts->log_level)) {
+        fprintf(stderr, "warning: cannot open log file, logging disabled\n");
+    }
+    if (opts->trace_path) {
+        g_tracing = pdf_trace_open(opts->trace_path);
+        if (!g_tracing) fprintf(stderr, "warning: cannot start trace, tracing disabled\n");
+    }
+}
+
+static int cmd_pages(int argc, wchar_t** argv)
+{
+    cli_options_t opts;
+    pdf_stats_t stats;
+    pdf_error_t error;
+    pdf_error_t first = PDF_OK;
+    int i, count;
+
+    i = parse_options(argc, argv, 0, &opts);
+    if (i < 0 || i >= argc) {
+        usage();
+        return EXIT_USAGE;
+    }
+    pdf_cancel_set_timeout(&g_cancel, opts.timeout_ms);
+    open_log(&opts);
+
+    for (; i < argc; i++) {
+        count = pdf_get_page_count_ex(argv[i], &g_cancel, opts.stats ? &stats : NULL, &error);
+        if (opts.stats) print_stats(&stats);
+        if (count < 0) {
+            report_error(argv[i], error);
+            if (first == PDF_OK) first = error;
+            if (error == PDF_ERR_CANCELLED) break;
+            continue;
+        }
+        printf("%d\t", count);
+        put_w(stdout, argv[i]);
+        fputc('\n', stdout);
+    }
+    return exit_code(first);
+}
+
+static int cmd_check_linear(int argc, wchar_t** argv)
+{
+    pdf_linearization_t info;
+    pdf_error_t error;
+    pdf_error_t first = PDF_OK;
+    int i, result, invalid = 0;
+
+    if (argc < 1) {
+        usage();
+        return EXIT_USAGE;
+    }
+    for (i = 0; i < argc; i++) {
+        result = pdf_check_linearization_ex(argv[i], &info, &error);
+        if (result < 0) {
+            report_error(argv[i], error);
+            if (first == PDF_OK) first = error;
+            continue;
+        }
+        if (!result) invalid = 1;
+        fputs(result ? "linearized\t" : "not linearized\t", stdout);
+        if (info.file_size > 0) {
+            /* First page section: bytes a viewer needs before showing page 1 */
+            printf("first page %llu/%llu bytes\t", info.first_page_end, info.file_size);
+        }
+        put_w(stdout, argv[i]);
+        fputc('\n', stdout);
+    }
+    if (first != PDF_OK) return exit_code(first);
+    return invalid ? EXIT_NOT_LINEARIZED : 0;
+}
+
+/* "pages:path" (pages = page-range expression, e.g. 1-3,10,7-9 or 8-$).
+ * The expression is cut off in place at the colon. */
+static int parse_chapter(wchar_t* spec, pdf_split_chapter_t* chapter)
+{
+    wchar_t* colon = wcschr(spec, L':');
+
+    if (!colon || !colon[1]) return 0;
+    *colon = L'\0';
+    if (pdf_page_ranges_count(spec, 0, NULL) < 0) {
+        *colon = L':';
+        return 0;
+    }
+
+    chapter->start_page = 0;
+    chapter->end_page = 0;
+    chapter->pages = spec;
+    chapter->output_path = colon + 1;
+    return 1;
+}
+
+static int cmd_split(int argc, wchar_t** argv)
+{
+    cli_options_t opts;
+    pdf_split_options_t options;
+    pdf_stats_t stats;
+    pdf_split_chapter_t* chapters;
+    pdf_error_t* results;
+    pdf_error_t error = PDF_OK;
+    pdf_error_t first = PDF_OK;
+    int first_arg, count, i, written;
+
+    first_arg = parse_options(argc, argv, 0, &opts);
+    if (first_arg < 0 || argc - first_arg < 2) {
+        usage();
+        return EXIT_USAGE;
+    }
+
+    pdf_split_options_init(&options);
+    if (opts.mode) {
+        if (wcscmp(opts.mode, L"serial") == 0) {
+            options.mode = PDF_SPLIT_SERIAL;
+        } else if (wcscmp(opts.mode, L"parallel") == 0) {
+            options.mode = PDF_SPLIT_PARALLEL;
+        } else {
+            usage();
+            return EXIT_USAGE;
+        }
+    }
+    if (!parse_profile(opts.profile, &options.profile)) {
+        usage();
+        return EXIT_USAGE;
+    }
+    options.thread_count = opts.threads;
+    options.linearize = opts.linearize;
+    options.cancel = &g_cancel;
+    if (opts.progress) options.page_progress = print_progress;
+    if (opts.stats) options.stats = &stats;
+    pdf_cancel_set_timeout(&g_cancel, opts.timeout_ms);
+    open_log(&opts);
+
+    count = argc - first_arg - 1;
+    chapters = (pdf_split_chapter_t*)calloc((size_t)count, sizeof(*chapters));
+    results = (pdf_error_t*)calloc((size_t)count, sizeof(*results));
+    if (!chapters || !results) {
+        free(chapters);
+        free(results);
+        report_error(NULL, PDF_ERR_MEMORY);
+        return exit_code(PDF_ERR_MEMORY);
+    }
+    for (i = 0; i < count; i++) {
+        if (!parse_chapter(argv[first_arg + 1 + i], &chapters[i])) {
+            fputs("bad chapter (expected pages:out.pdf, pages like 1-3,10,7-9 or 8-$): ", stderr);
+            put_w(stderr, argv[first_arg + 1 + i]);
+            fputc('\n', stderr);
+            free(chapters);
+            free(results);
+            return EXIT_USAGE;
+        }
+    }
+
+    written = pdf_split_batch_ex(argv[first_arg], chapters, count, &options, results, NULL, NULL, &error);
+    if (error != PDF_OK && written == 0) {
+        /* Input error (or cancelled before any chapter): same code for all */
+        report_error(argv[first_arg], error);
+        first = error;
+    } else {
+        for (i = 0; i < count; i++) {
+            if (results[i] == PDF_OK) continue;
+            if (first == PDF_OK) first = results[i];
+            report_error(chapters[i].output_path, results[i]);
+        }
+    }
+    fprintf(stderr, "%d/%d chapters written\n", written, count);
+    if (opts.stats) print_stats(&stats);
+
+    free(chapters);
+    free(results);
+    return exit_code(first);
+}
+
+static void print_duplicates(const pdf_duplicate_list_t* list, wchar_t** inputs, int dropped)
+{
+    int i, n = list->count < list->capacity ? list->count : list->capacity;
+
+    for (i = 0; i < n; i++) {
+        const pdf_duplicate_page_t* dup = &list->pages[i];
+        fputs(dropped ? "dropped\t" : "duplicate\t", stdout);
+        put_w(stdout, inputs[dup->input_index]);
+        printf("\t%d\t", dup->page);
+        put_w(stdout, inputs[dup->first_input_index]);
+        printf("\t%d\n", dup->first_page);
+    }
+    if (list->count > n) fprintf(stderr, "%d more duplicate pages not listed\n", list->count - n);
+}
+
+static int cmd_merge(int argc, wchar_t** argv)
+{
+    static pdf_duplicate_page_t duplicate_pages[DUPLICATES_MAX];
+    cli_options_t opts;
+    pdf_merge_options_t options;
+    pdf_duplicate_list_t duplicates;
+    pdf_stats_t stats;
+    pdf_error_t error = PDF_OK;
+    int first_arg, ok, failed_index = -1;
+
+    first_arg = parse_options(argc, argv, 0, &opts);
+    if (first_arg < 0 || !opts.output || argc - first_arg < 1) {
+        usage();
+        return EXIT_USAGE;
+    }
+
+    pdf_merge_options_init(&options);
+    if (opts.mode) {
+        if (wcscmp(opts.mode, L"single") == 0) {
+            options.mode = PDF_MERGE_SINGLE_PASS;
+        } else if (wcscmp(opts.mode, L"sequential") == 0) {
+            options.mode = PDF_MERGE_SEQUENTIAL;
+        } else if (wcscmp(opts.mode, L"tree") == 0) {
+            options.mode = PDF_MERGE_TREE;
+        } else if (wcscmp(opts.mode, L"streaming") == 0) {
+            options.mode = PDF_MERGE_STREAMING;
+        } else {
+            usage();
+            return EXIT_USAGE;
+        }
+    }
+    if (!parse_profile(opts.profile, &options.profile)) {
+        usage();
+        return EXIT_USAGE;
+    }
+    if (opts.duplicates) {
+        if (wcscmp(opts.duplicates, L"report") == 0) {
+            options.duplicates = PDF_DUPLICATES_REPORT;
+        } else if (wcscmp(opts.duplicates, L"drop") == 0) {
+            options.duplicates = PDF_DUPLICATES_DROP;
+        } else {
+            usage();
+            return EXIT_USAGE;
+        }
+        duplicates.pages = duplicate_pages;
+        duplicates.capacity = DUPLICATES_MAX;
+        duplicates.count = 0;
+        options.duplicate_list = &duplicates;
+    }
+    options.thread_count = opts.threads;
+    options.linearize = opts.linearize;
+    options.dedup = opts.dedup;
+    options.cancel = &g_cancel;
+    if (opts.progress) options.page_progress = print_progress;
+    /* The dedup savings come back in the stats */
+    if (opts.stats || opts.dedup) options.stats = &stats;
+    pdf_cancel_set_timeout(&g_cancel, opts.timeout_ms);
+    open_log(&opts);
+
+    ok = pdf_merge_ex((const wchar_t**)(argv + first_arg), argc - first_arg, opts.output, &options,
+                      NULL, NULL, &error, &failed_index);
+    if (opts.stats) {
+        print_stats(&stats);
+    } else if (opts.dedup && ok) {
+        fprintf(stderr, "dedup: %lld duplicate streams, %.1f MB saved\n",
+                stats.streams_deduplicated, (double)stats.dedup_bytes_saved / (1024.0 * 1024.0));
+    }
+    if (ok && options.duplicate_list) {
+        print_duplicates(&duplicates, argv + first_arg, options.duplicates == PDF_DUPLICATES_DROP);
+    }
+    if (!ok) {
+        report_error(failed_index >= 0 ? argv[first_arg + failed_index] : opts.output, error);
+        return exit_code(error);
+    }
+    return 0;
+}
+
+static int cli_main(int argc, wchar_t** argv)
+{
+    int code;
+
+    if (argc < 2) {
+        usage();
+        return EXIT_USAGE;
+    }
+
+    pdf_cancel_init(&g_cancel);
+    signal(SIGINT, on_interrupt);
+
+    if (wcscmp(argv[1], L"pages") == 0) {
+        code = cmd_pages(argc - 2, argv + 2);
+    } else if (wcscmp(argv[1], L"split") == 0) {
+        code = cmd_split(argc - 2, argv + 2);
+    } else if (wcscmp(argv[1], L"merge") == 0) {
+        code = cmd_merge(argc - 2, argv + 2);
+    } else if (wcscmp(argv[1], L"check-linear") == 0) {
+        code = cmd_check_linear(argc - 2, argv + 2);
+    } else {
+        usage();
+        code = EXIT_USAGE;
+    }
+
+    if (g_tracing && !pdf_trace_close()) {
+        fprintf(stderr, "warning: cannot write trace file\n");
+    }
+    pdf_index_close();
+    pdf_log_close();
+    return code;
+}
+
+#ifdef _WIN32
+
+int wmain(int argc, wchar_t** argv)
+{
+    SetConsoleOutputCP(CP_UTF8);
+    return cli_main(argc, argv);
+}
+
+#else
+
+/* Arguments are taken as UTF-8, the encoding the library uses for paths
+   (bytes that are not UTF-8 are kept as is, so other file names still open) */
+int main(int argc, char** argv)
+{
+    wchar_t** wargv;
+    int i, len, code;
+
+    wargv = (wchar_t**)calloc((size_t)argc + 1, sizeof(*wargv));
+    if (!wargv) return exit_code(PDF_ERR_MEMORY);
+
+    for (i = 0; i < argc; i++) {
+        len = MultiByteToWideChar(CP_UTF8, 0, argv[i], -1, NULL, 0);
+        wargv[i] = (wchar_t*)malloc((size_t)len * sizeof(wchar_t));
+        if (!wargv[i]) return exit_code(PDF_ERR_MEMORY);
+        MultiByteToWideChar(CP_UTF8, 0, argv[i], -1, wargv[i], len);
+    }
+
+    code = cli_main(argc, wargv);
+
+    for (i = 0; i < argc; i++) free(wargv[i]);
+    free(wargv);
+    return code;
+}
+
+#endif
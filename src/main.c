@@ -8,6 +8,7 @@
 #include <shlobj.h>
 #include <shellapi.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "pdf_tools.h"
 
@@ -24,8 +25,7 @@
 #define ID_SPLIT_BTN_OUT    203
 #define ID_SPLIT_LIST       204
 #define ID_SPLIT_NAME       205
-#define ID_SPLIT_START      206
-#define ID_SPLIT_END        207
+#define ID_SPLIT_PAGES      206
 #define ID_SPLIT_BTN_ADD    208
 #define ID_SPLIT_BTN_DEL    209
 #define ID_SPLIT_BTN_CLR    210
@@ -45,8 +45,14 @@
 #define ID_MERGE_PROGRESS   308
 
 #define MAX_CHAPTERS        100
+#define PROGRESS_RANGE      1000            /* 진행 막대 범위 (페이지 비율) */
 #define MAX_MERGE_FILES     50
 #define NAME_LENGTH         64
+#define PAGES_LENGTH        64              /* 페이지 범위 식 최대 길이 */
+
+/* Worker -> main window messages */
+#define WM_APP_JOB_PROGRESS (WM_APP + 1)    /* lparam = job_t*, 최신 진행률은 job->progress */
+#define WM_APP_JOB_DONE     (WM_APP + 2)    /* lparam = job_t* */
 
 #define TAB_SPLIT           0
 #define TAB_MERGE           1
@@ -54,10 +60,44 @@
 
 typedef struct chapter {
     WCHAR name[NAME_LENGTH];
-    int start_page;
-    int end_page;
+    WCHAR pages[PAGES_LENGTH];      /* 페이지 범위 식 (예: 1-3,10,7-9) */
 } chapter_t;
 
+/* 작업 스레드에서 실행하는 PDF 작업 (입력은 시작 시 복사, 결과는 완료 메시지로 전달) */
+typedef enum job_kind {
+    JOB_LOAD,
+    JOB_SPLIT,
+    JOB_MERGE
+} job_kind_t;
+
+typedef struct job {
+    job_kind_t kind;
+    pdf_error_t error;
+    pdf_cancel_t cancel;            /* 취소 버튼, 창 닫기 */
+    /* 페이지 진행률: 작업 스레드가 갱신, UI는 메시지를 받을 때 최신 값만 읽음 */
+    SRWLOCK progress_lock;
+    pdf_progress_info_t progress;
+    volatile LONG progress_posted;  /* 1 = 처리되지 않은 진행률 메시지가 있음 */
+    pdf_stats_t stats;              /* JOB_SPLIT, JOB_MERGE: 소요 시간과 처리량 (상태 표시줄) */
+    /* JOB_LOAD, JOB_SPLIT: 입력 PDF */
+    WCHAR path[MAX_PATH];
+    /* JOB_LOAD 결과 */
+    pdf_document_t* doc;
+    int page_count;
+    /* JOB_SPLIT */
+    chapter_t chapters[MAX_CHAPTERS];
+    int chapter_count;
+    WCHAR out_dir[MAX_PATH];
+    WCHAR chapter_paths[MAX_CHAPTERS][MAX_PATH];
+    pdf_error_t results[MAX_CHAPTERS];
+    int success;
+    /* JOB_MERGE */
+    WCHAR merge_files[MAX_MERGE_FILES][MAX_PATH];
+    int merge_count;
+    WCHAR out_path[MAX_PATH];
+    int failed_index;
+} job_t;
+
 /* Main window */
 static HWND s_hwnd_main;
 static HWND s_hwnd_tab;
@@ -67,6 +107,11 @@ static HFONT s_hfont_title;
 static int s_current_tab = 0;
 static float s_dpi_scale = 1.0f;
 
+/* Background job (한 번에 하나) */
+static job_t* s_job = NULL;
+static HANDLE s_job_thread = NULL;
+static int s_close_pending = 0;     /* 작업 중 창을 닫으면 완료 후 종료 */
+
 /* DPI 스케일링 함수 */
 static int dpi(int value)
 {
@@ -80,8 +125,7 @@ static HWND s_hwnd_split_pdf_path;
 static HWND s_hwnd_split_out_path;
 static HWND s_hwnd_split_list;
 static HWND s_hwnd_split_name;
-static HWND s_hwnd_split_start;
-static HWND s_hwnd_split_end;
+static HWND s_hwnd_split_pages;
 static HWND s_hwnd_split_page_info;
 static HWND s_hwnd_split_btn_run;
 static HWND s_hwnd_split_progress;
@@ -90,6 +134,7 @@ static WCHAR s_split_out_path[MAX_PATH];
 static chapter_t s_chapters[MAX_CHAPTERS];
 static int s_chapter_count = 0;
 static int s_split_total_pages = 0;
+static pdf_document_t* s_split_doc = NULL;  /* 로드한 PDF (분할 시 파싱 결과 재사용) */
 static WNDPROC s_orig_edit_proc;
 
 /* Merge tab */
@@ -110,12 +155,9 @@ static LRESULT CALLBACK edit_subclass_proc(HWND hwnd, UINT msg, WPARAM wparam, L
         /* Enter key */
         if (wparam == VK_RETURN) {
             if (hwnd == s_hwnd_split_name) {
-                SetFocus(s_hwnd_split_start);
-                return 0;
-            } else if (hwnd == s_hwnd_split_start) {
-                SetFocus(s_hwnd_split_end);
+                SetFocus(s_hwnd_split_pages);
                 return 0;
-            } else if (hwnd == s_hwnd_split_end) {
+            } else if (hwnd == s_hwnd_split_pages) {
                 SendMessage(s_hwnd_main, WM_COMMAND, ID_SPLIT_BTN_ADD, 0);
                 return 0;
             }
@@ -125,20 +167,14 @@ static LRESULT CALLBACK edit_subclass_proc(HWND hwnd, UINT msg, WPARAM wparam, L
             int shift_pressed = GetKeyState(VK_SHIFT) & 0x8000;
             if (shift_pressed) {
                 /* Shift+Tab: backward */
-                if (hwnd == s_hwnd_split_end) {
-                    SetFocus(s_hwnd_split_start);
-                    return 0;
-                } else if (hwnd == s_hwnd_split_start) {
+                if (hwnd == s_hwnd_split_pages) {
                     SetFocus(s_hwnd_split_name);
                     return 0;
                 }
             } else {
                 /* Tab: forward */
                 if (hwnd == s_hwnd_split_name) {
-                    SetFocus(s_hwnd_split_start);
-                    return 0;
-                } else if (hwnd == s_hwnd_split_start) {
-                    SetFocus(s_hwnd_split_end);
+                    SetFocus(s_hwnd_split_pages);
                     return 0;
                 }
             }
@@ -164,6 +200,12 @@ static void set_control_font(HWND hwnd, HFONT font);
 static void update_status(const WCHAR* message);
 static void handle_drop_files(HDROP hdrop);
 
+/* Background jobs */
+static int job_start(job_t* job);
+static int job_check_idle(void);
+static void job_on_progress(job_t* job);
+static void job_on_done(job_t* job);
+
 /* Split functions */
 static void split_select_pdf(HWND hwnd);
 static void split_select_output(HWND hwnd);
@@ -173,6 +215,8 @@ static void split_clear_chapters(void);
 static void split_refresh_list(void);
 static void split_run(HWND hwnd);
 static void split_load_pdf(const WCHAR* path);
+static void split_load_finish(job_t* job);
+static void split_finish(job_t* job);
 
 /* Merge functions */
 static void merge_add_files(HWND hwnd);
@@ -183,6 +227,7 @@ static void merge_move_down(void);
 static void merge_select_output(HWND hwnd);
 static void merge_run(HWND hwnd);
 static void merge_refresh_list(void);
+static void merge_finish(job_t* job);
 
 int WINAPI wWinMain(HINSTANCE hinstance, HINSTANCE hprev_instance, LPWSTR cmd_line, int cmd_show)
 {
@@ -190,10 +235,20 @@ int WINAPI wWinMain(HINSTANCE hinstance, HINSTANCE hprev_instance, LPWSTR cmd_li
     MSG msg;
     INITCOMMONCONTROLSEX icex;
     HDC hdc;
+    const WCHAR* log_path;
+    const WCHAR* trace_path;
 
     (void)hprev_instance;
     (void)cmd_line;
 
+    /* 디버그 로그: 환경 변수 JUN_PDF_TOOLS_LOG에 경로가 있을 때만 */
+    log_path = _wgetenv(L"JUN_PDF_TOOLS_LOG");
+    if (log_path && log_path[0]) pdf_log_open(log_path, PDF_LOG_DEBUG);
+
+    /* 타임라인 트레이스: JUN_PDF_TOOLS_TRACE에 경로가 있을 때만, 종료 시 JSON으로 기록 */
+    trace_path = _wgetenv(L"JUN_PDF_TOOLS_TRACE");
+    if (trace_path && trace_path[0]) pdf_trace_open(trace_path);
+
     /* DPI Awareness 설정 - 고해상도 디스플레이에서 선명하게 표시 */
     SetProcessDPIAware();
 
@@ -236,6 +291,10 @@ int WINAPI wWinMain(HINSTANCE hinstance, HINSTANCE hprev_instance, LPWSTR cmd_li
         DispatchMessage(&msg);
     }
 
+    pdf_document_close(s_split_doc);
+    pdf_trace_close();
+    pdf_index_close();
+    pdf_log_close();
     DeleteObject(s_hfont_ui);
     DeleteObject(s_hfont_title);
 
@@ -297,6 +356,14 @@ static LRESULT CALLBACK window_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM l
         }
         break;
 
+    case WM_APP_JOB_PROGRESS:
+        job_on_progress((job_t*)lparam);
+        break;
+
+    case WM_APP_JOB_DONE:
+        job_on_done((job_t*)lparam);
+        break;
+
     case WM_CTLCOLORSTATIC:
         {
             int ctrl_id = GetDlgCtrlID((HWND)lparam);
@@ -315,6 +382,17 @@ static LRESULT CALLBACK window_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM l
         SetBkMode((HDC)wparam, TRANSPARENT);
         return (LRESULT)GetStockObject(NULL_BRUSH);
 
+    case WM_CLOSE:
+        /* 작업을 취소하고, 스레드가 끝날 때까지 창만 숨긴 뒤 완료 메시지에서 종료 */
+        if (s_job) {
+            pdf_cancel_request(&s_job->cancel);
+            s_close_pending = 1;
+            ShowWindow(hwnd, SW_HIDE);
+        } else {
+            DestroyWindow(hwnd);
+        }
+        break;
+
     case WM_DESTROY:
         PostQuitMessage(0);
         break;
@@ -429,9 +507,11 @@ static void show_tab(int tab_index)
         ShowWindow(s_merge_ctrls[i], show_merge);
     }
 
-    /* Always hide progress bars on tab switch (they show only during operation) */
-    ShowWindow(s_hwnd_split_progress, SW_HIDE);
-    ShowWindow(s_hwnd_merge_progress, SW_HIDE);
+    /* Progress bars show only during an operation on their own tab */
+    ShowWindow(s_hwnd_split_progress,
+               (s_job && s_job->kind == JOB_SPLIT && tab_index == TAB_SPLIT) ? SW_SHOW : SW_HIDE);
+    ShowWindow(s_hwnd_merge_progress,
+               (s_job && s_job->kind == JOB_MERGE && tab_index == TAB_MERGE) ? SW_SHOW : SW_HIDE);
 
     s_current_tab = tab_index;
 
@@ -452,6 +532,160 @@ static void update_status(const WCHAR* message)
     UpdateWindow(s_hwnd_main);
 }
 
+/* ==================== Background Jobs ==================== */
+
+/*
+ * Page progress callback (작업 스레드에서 호출, 라이브러리가 간격을 제한)
+ * UI가 이전 메시지를 아직 처리하지 않았으면 값만 바꾸고 메시지는 보내지 않음
+ */
+static void job_page_progress(const pdf_progress_info_t* info, void* user_data)
+{
+    job_t* job = (job_t*)user_data;
+
+    AcquireSRWLockExclusive(&job->progress_lock);
+    job->progress = *info;
+    ReleaseSRWLockExclusive(&job->progress_lock);
+
+    if (InterlockedExchange(&job->progress_posted, 1) == 0) {
+        PostMessageW(s_hwnd_main, WM_APP_JOB_PROGRESS, 0, (LPARAM)job);
+    }
+}
+
+static DWORD WINAPI job_thread_proc(LPVOID param)
+{
+    job_t* job = (job_t*)param;
+    pdf_split_chapter_t batch[MAX_CHAPTERS];
+    pdf_split_options_t options;
+    pdf_merge_options_t merge_options;
+    const WCHAR* paths[MAX_MERGE_FILES];
+    int i;
+
+    job->error = PDF_OK;
+    switch (job->kind) {
+    case JOB_LOAD:
+        job->doc = pdf_document_open(job->path, &job->error);
+        job->page_count = job->doc ? pdf_document_get_page_count(job->doc, &job->error) : -1;
+        break;
+
+    case JOB_SPLIT:
+        /* 모든 챕터를 한 번에 분할 (원본은 한 번만 읽음) */
+        for (i = 0; i < job->chapter_count; i++) {
+            swprintf_s(job->chapter_paths[i], MAX_PATH, L"%s\\%s.pdf", job->out_dir, job->chapters[i].name);
+            batch[i].output_path = job->chapter_paths[i];
+            batch[i].start_page = 0;
+            batch[i].end_page = 0;
+            batch[i].pages = job->chapters[i].pages;
+        }
+
+        /* 챕터 기록은 작업 스레드에서 동시에 (스레드 수 = CPU 코어 수) */
+        pdf_split_options_init(&options);
+        options.mode = PDF_SPLIT_PARALLEL;
+        options.cancel = &job->cancel;
+        options.page_progress = job_page_progress;
+        options.stats = &job->stats;
+
+        job->success = pdf_split_batch_ex(job->path, batch, job->chapter_count, &options, job->results,
+                                          NULL, job, &job->error);
+        break;
+
+    case JOB_MERGE:
+        for (i = 0; i < job->merge_count; i++) {
+            paths[i] = job->merge_files[i];
+        }
+        job->failed_index = -1;
+        pdf_merge_options_init(&merge_options);
+        merge_options.cancel = &job->cancel;
+        merge_options.page_progress = job_page_progress;
+        merge_options.stats = &job->stats;
+        job->success = pdf_merge_ex(paths, job->merge_count, job->out_path, &merge_options,
+                                    NULL, job, &job->error, &job->failed_index);
+        break;
+    }
+
+    PostMessageW(s_hwnd_main, WM_APP_JOB_DONE, 0, (LPARAM)job);
+    return 0;
+}
+
+/* Takes ownership of job (freed here on failure, in job_on_done otherwise) */
+static int job_start(job_t* job)
+{
+    pdf_cancel_init(&job->cancel);
+    InitializeSRWLock(&job->progress_lock);
+    s_job = job;
+    s_job_thread = CreateThread(NULL, 0, job_thread_proc, job, 0, NULL);
+    if (!s_job_thread) {
+        s_job = NULL;
+        free(job);
+        MessageBoxW(s_hwnd_main, L"작업 스레드를 시작할 수 없습니다.", L"오류", MB_OK | MB_ICONERROR);
+        return 0;
+    }
+    return 1;
+}
+
+/* 진행 중인 작업이 있으면 알리고 0 반환 */
+static int job_check_idle(void)
+{
+    if (!s_job) return 1;
+    MessageBoxW(s_hwnd_main, L"진행 중인 작업이 끝난 후 다시 시도하세요.", L"알림", MB_OK | MB_ICONINFORMATION);
+    return 0;
+}
+
+static void job_on_progress(job_t* job)
+{
+    pdf_progress_info_t info;
+    WCHAR msg[160];
+    const WCHAR* verb;
+    int pos, eta;
+
+    if (!s_job || s_job != job) return;
+
+    /* 다음 콜백부터 다시 메시지를 보내도록 먼저 해제 */
+    InterlockedExchange(&job->progress_posted, 0);
+    AcquireSRWLockShared(&job->progress_lock);
+    info = job->progress;
+    ReleaseSRWLockShared(&job->progress_lock);
+
+    pos = info.pages_total > 0 ? (int)(info.pages_done * PROGRESS_RANGE / info.pages_total) : 0;
+    verb = job->kind == JOB_SPLIT ? L"분할 중" : L"병합 중";
+    if (info.eta >= 0) {
+        eta = (int)(info.eta + 0.5);
+        swprintf_s(msg, 160, L"%s... %lld/%lld 페이지, %.1f MB/s, 남은 시간 %d:%02d",
+                   verb, info.pages_done, info.pages_total, info.mb_per_sec, eta / 60, eta % 60);
+    } else {
+        swprintf_s(msg, 160, L"%s... %lld/%lld 페이지", verb, info.pages_done, info.pages_total);
+    }
+
+    if (job->kind == JOB_SPLIT) {
+        SendMessageW(s_hwnd_split_progress, PBM_SETPOS, pos, 0);
+    } else if (job->kind == JOB_MERGE) {
+        SendMessageW(s_hwnd_merge_progress, PBM_SETPOS, pos, 0);
+    }
+    update_status(msg);
+}
+
+static void job_on_done(job_t* job)
+{
+    /* 완료 메시지가 마지막 동작이므로 스레드는 곧 종료됨 */
+    WaitForSingleObject(s_job_thread, INFINITE);
+    CloseHandle(s_job_thread);
+    s_job_thread = NULL;
+    s_job = NULL;
+
+    if (s_close_pending) {
+        if (job->kind == JOB_LOAD) pdf_document_close(job->doc);
+        free(job);
+        DestroyWindow(s_hwnd_main);
+        return;
+    }
+
+    switch (job->kind) {
+    case JOB_LOAD: split_load_finish(job); break;
+    case JOB_SPLIT: split_finish(job); break;
+    case JOB_MERGE: merge_finish(job); break;
+    }
+    free(job);
+}
+
 /* ==================== Split Tab ==================== */
 static void create_split_tab(HWND hwnd, HINSTANCE hinst)
 {
@@ -523,23 +757,16 @@ static void create_split_tab(HWND hwnd, HINSTANCE hinst)
         lm + dpi(40), y, dpi(130), dpi(24), hwnd, (HMENU)ID_SPLIT_NAME, hinst, NULL);
     set_control_font(s_hwnd_split_name, s_hfont_ui); ADD_SPLIT_CTRL(s_hwnd_split_name);
 
-    h = CreateWindowW(L"STATIC", L"시작", WS_CHILD | WS_VISIBLE,
-        lm + dpi(185), y + dpi(3), dpi(35), dpi(20), hwnd, NULL, hinst, NULL);
+    h = CreateWindowW(L"STATIC", L"페이지", WS_CHILD | WS_VISIBLE,
+        lm + dpi(185), y + dpi(3), dpi(45), dpi(20), hwnd, NULL, hinst, NULL);
     set_control_font(h, s_hfont_ui); ADD_SPLIT_CTRL(h);
 
-    s_hwnd_split_start = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"",
-        WS_CHILD | WS_VISIBLE | ES_NUMBER,
-        lm + dpi(225), y, dpi(60), dpi(24), hwnd, (HMENU)ID_SPLIT_START, hinst, NULL);
-    set_control_font(s_hwnd_split_start, s_hfont_ui); ADD_SPLIT_CTRL(s_hwnd_split_start);
-
-    h = CreateWindowW(L"STATIC", L"끝", WS_CHILD | WS_VISIBLE,
-        lm + dpi(300), y + dpi(3), dpi(25), dpi(20), hwnd, NULL, hinst, NULL);
-    set_control_font(h, s_hfont_ui); ADD_SPLIT_CTRL(h);
-
-    s_hwnd_split_end = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"",
-        WS_CHILD | WS_VISIBLE | ES_NUMBER,
-        lm + dpi(330), y, dpi(60), dpi(24), hwnd, (HMENU)ID_SPLIT_END, hinst, NULL);
-    set_control_font(s_hwnd_split_end, s_hfont_ui); ADD_SPLIT_CTRL(s_hwnd_split_end);
+    /* 페이지 범위 식: 1-3,10,7-9 / 5-1 (역순) / 8-$ ($ = 마지막 페이지) */
+    s_hwnd_split_pages = CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"",
+        WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL,
+        lm + dpi(235), y, dpi(155), dpi(24), hwnd, (HMENU)ID_SPLIT_PAGES, hinst, NULL);
+    SendMessageW(s_hwnd_split_pages, EM_LIMITTEXT, PAGES_LENGTH - 1, 0);
+    set_control_font(s_hwnd_split_pages, s_hfont_ui); ADD_SPLIT_CTRL(s_hwnd_split_pages);
 
     h = CreateWindowW(L"BUTTON", L"추가", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
         lm + dpi(410), y - dpi(1), dpi(70), dpi(26), hwnd, (HMENU)ID_SPLIT_BTN_ADD, hinst, NULL);
@@ -579,8 +806,7 @@ static void create_split_tab(HWND hwnd, HINSTANCE hinst)
 
     /* Subclass edit controls for Enter key */
     s_orig_edit_proc = (WNDPROC)SetWindowLongPtr(s_hwnd_split_name, GWLP_WNDPROC, (LONG_PTR)edit_subclass_proc);
-    SetWindowLongPtr(s_hwnd_split_start, GWLP_WNDPROC, (LONG_PTR)edit_subclass_proc);
-    SetWindowLongPtr(s_hwnd_split_end, GWLP_WNDPROC, (LONG_PTR)edit_subclass_proc);
+    SetWindowLongPtr(s_hwnd_split_pages, GWLP_WNDPROC, (LONG_PTR)edit_subclass_proc);
 
     #undef ADD_SPLIT_CTRL
 }
@@ -588,18 +814,17 @@ static void create_split_tab(HWND hwnd, HINSTANCE hinst)
 static void split_load_pdf(const WCHAR* path)
 {
     WCHAR* last_slash;
-    WCHAR msg[256];
-    int page_count;
     HWND hwnd_pdf;
     HWND hwnd_out;
-    pdf_error_t error = PDF_OK;
+    job_t* job;
+
+    if (!job_check_idle()) return;
 
     /* Clear chapter list when loading new PDF */
     s_chapter_count = 0;
     split_refresh_list();
     SetWindowTextW(s_hwnd_split_name, L"");
-    SetWindowTextW(s_hwnd_split_start, L"");
-    SetWindowTextW(s_hwnd_split_end, L"");
+    SetWindowTextW(s_hwnd_split_pages, L"");
 
     /* Reset progress bar */
     ShowWindow(s_hwnd_split_progress, SW_HIDE);
@@ -623,18 +848,36 @@ static void split_load_pdf(const WCHAR* path)
         SetWindowTextW(hwnd_out, s_split_out_path);
     }
 
-    page_count = pdf_get_page_count(s_split_pdf_path, &error);
-    if (page_count > 0) {
-        s_split_total_pages = page_count;
-        swprintf_s(msg, 256, L"총 %d 페이지", page_count);
+    pdf_document_close(s_split_doc);
+    s_split_doc = NULL;
+    s_split_total_pages = 0;
+    SetWindowTextW(s_hwnd_split_page_info, L"");
+
+    job = (job_t*)calloc(1, sizeof(job_t));
+    if (!job) return;
+    job->kind = JOB_LOAD;
+    wcscpy_s(job->path, MAX_PATH, s_split_pdf_path);
+
+    update_status(L"PDF 불러오는 중...");
+    job_start(job);
+}
+
+static void split_load_finish(job_t* job)
+{
+    WCHAR msg[256];
+
+    /* Keep the document open so split_run reuses the parsed file */
+    if (job->page_count > 0) {
+        s_split_doc = job->doc;
+        s_split_total_pages = job->page_count;
+        swprintf_s(msg, 256, L"총 %d 페이지", job->page_count);
         SetWindowTextW(s_hwnd_split_page_info, msg);
         update_status(L"PDF 로드 완료");
     } else {
-        s_split_total_pages = 0;
-        SetWindowTextW(s_hwnd_split_page_info, L"");
+        pdf_document_close(job->doc);
         /* 구체적인 오류 메시지 표시 */
-        update_status(pdf_error_message(error));
-        MessageBoxW(s_hwnd_main, pdf_error_message(error), L"PDF 로드 오류", MB_OK | MB_ICONERROR);
+        update_status(pdf_error_message(job->error));
+        MessageBoxW(s_hwnd_main, pdf_error_message(job->error), L"PDF 로드 오류", MB_OK | MB_ICONERROR);
     }
 }
 
@@ -684,9 +927,9 @@ static void split_select_output(HWND hwnd)
 
 static void split_add_chapter(HWND hwnd)
 {
-    WCHAR name[NAME_LENGTH], start_str[16], end_str[16];
+    WCHAR name[NAME_LENGTH], pages[PAGES_LENGTH];
     WCHAR msg[256];
-    int start, end;
+    int count, bad_page = 0;
 
     if (s_chapter_count >= MAX_CHAPTERS) {
         MessageBoxW(hwnd, L"최대 100개까지 추가 가능합니다.", L"알림", MB_OK | MB_ICONWARNING);
@@ -694,10 +937,7 @@ static void split_add_chapter(HWND hwnd)
     }
 
     GetWindowTextW(s_hwnd_split_name, name, NAME_LENGTH);
-    GetWindowTextW(s_hwnd_split_start, start_str, 16);
-    GetWindowTextW(s_hwnd_split_end, end_str, 16);
-    start = _wtoi(start_str);
-    end = _wtoi(end_str);
+    GetWindowTextW(s_hwnd_split_pages, pages, PAGES_LENGTH);
 
     /* 입력값 유효성 검사 - 구체적인 오류 메시지 */
     if (wcslen(name) == 0) {
@@ -706,51 +946,41 @@ static void split_add_chapter(HWND hwnd)
         return;
     }
 
-    if (wcslen(start_str) == 0 || start <= 0) {
-        MessageBoxW(hwnd, L"시작 페이지를 1 이상의 숫자로 입력해주세요.", L"입력 오류", MB_OK | MB_ICONWARNING);
-        SetFocus(s_hwnd_split_start);
+    if (wcslen(pages) == 0) {
+        MessageBoxW(hwnd, L"페이지 범위를 입력해주세요.\n예: 1-10", L"입력 오류", MB_OK | MB_ICONWARNING);
+        SetFocus(s_hwnd_split_pages);
         return;
     }
 
-    if (wcslen(end_str) == 0 || end <= 0) {
-        MessageBoxW(hwnd, L"끝 페이지를 1 이상의 숫자로 입력해주세요.", L"입력 오류", MB_OK | MB_ICONWARNING);
-        SetFocus(s_hwnd_split_end);
+    /* PDF가 로드된 경우 총 페이지 수로 범위까지 검증 */
+    count = pdf_page_ranges_count(pages, s_split_total_pages, &bad_page);
+    if (count == -1) {
+        MessageBoxW(hwnd, L"페이지 범위 형식이 올바르지 않습니다.\n\n"
+                          L"예: 1-10 / 1-3,10,7-9 (순서대로)\n"
+                          L"     5-1 (역순) / 8-$ ($ = 마지막 페이지)",
+                    L"입력 오류", MB_OK | MB_ICONWARNING);
+        SetFocus(s_hwnd_split_pages);
         return;
     }
-
-    if (end < start) {
-        swprintf_s(msg, 256, L"끝 페이지(%d)가 시작 페이지(%d)보다 작습니다.\n페이지 범위를 확인해주세요.", end, start);
-        MessageBoxW(hwnd, msg, L"입력 오류", MB_OK | MB_ICONWARNING);
-        SetFocus(s_hwnd_split_end);
-        return;
-    }
-
-    /* PDF가 로드된 경우 페이지 범위 검증 */
-    if (s_split_total_pages > 0) {
-        if (start > s_split_total_pages) {
-            swprintf_s(msg, 256, L"시작 페이지(%d)가 총 페이지 수(%d)를 초과합니다.", start, s_split_total_pages);
-            MessageBoxW(hwnd, msg, L"페이지 범위 오류", MB_OK | MB_ICONWARNING);
-            SetFocus(s_hwnd_split_start);
-            return;
-        }
-        if (end > s_split_total_pages) {
-            swprintf_s(msg, 256, L"끝 페이지(%d)가 총 페이지 수(%d)를 초과합니다.", end, s_split_total_pages);
-            MessageBoxW(hwnd, msg, L"페이지 범위 오류", MB_OK | MB_ICONWARNING);
-            SetFocus(s_hwnd_split_end);
-            return;
+    if (count == -2) {
+        if (bad_page < 1) {
+            swprintf_s(msg, 256, L"페이지 번호는 1 이상이어야 합니다.");
+        } else {
+            swprintf_s(msg, 256, L"페이지(%d)가 총 페이지 수(%d)를 초과합니다.", bad_page, s_split_total_pages);
         }
+        MessageBoxW(hwnd, msg, L"페이지 범위 오류", MB_OK | MB_ICONWARNING);
+        SetFocus(s_hwnd_split_pages);
+        return;
     }
 
     wcscpy_s(s_chapters[s_chapter_count].name, NAME_LENGTH, name);
-    s_chapters[s_chapter_count].start_page = start;
-    s_chapters[s_chapter_count].end_page = end;
+    wcscpy_s(s_chapters[s_chapter_count].pages, PAGES_LENGTH, pages);
     s_chapter_count++;
 
     split_refresh_list();
 
     SetWindowTextW(s_hwnd_split_name, L"");
-    SetWindowTextW(s_hwnd_split_start, L"");
-    SetWindowTextW(s_hwnd_split_end, L"");
+    SetWindowTextW(s_hwnd_split_pages, L"");
     SetFocus(s_hwnd_split_name);
 }
 
@@ -779,18 +1009,16 @@ static void split_clear_chapters(void)
     s_chapter_count = 0;
     split_refresh_list();
     SetWindowTextW(s_hwnd_split_name, L"");
-    SetWindowTextW(s_hwnd_split_start, L"");
-    SetWindowTextW(s_hwnd_split_end, L"");
+    SetWindowTextW(s_hwnd_split_pages, L"");
 }
 
 static void split_refresh_list(void)
 {
     int i;
-    WCHAR item[128];
+    WCHAR item[192];
     SendMessageW(s_hwnd_split_list, LB_RESETCONTENT, 0, 0);
     for (i = 0; i < s_chapter_count; i++) {
-        swprintf_s(item, 128, L"  %s    (페이지 %d ~ %d)",
-            s_chapters[i].name, s_chapters[i].start_page, s_chapters[i].end_page);
+        swprintf_s(item, 192, L"  %s    (페이지 %s)", s_chapters[i].name, s_chapters[i].pages);
         SendMessageW(s_hwnd_split_list, LB_ADDSTRING, 0, (LPARAM)item);
     }
 }
@@ -798,19 +1026,25 @@ static void split_refresh_list(void)
 /* 실패한 챕터 정보 저장 구조체 */
 typedef struct failed_chapter {
     WCHAR name[NAME_LENGTH];
-    int start_page;
-    int end_page;
+    WCHAR pages[PAGES_LENGTH];
     pdf_error_t error;
 } failed_chapter_t;
 
 static void split_run(HWND hwnd)
 {
-    int i, success = 0, existing_count = 0, fail_count = 0;
+    int i, existing_count = 0;
     WCHAR out_path[MAX_PATH], msg[1024];
-    MSG winmsg;
-    pdf_error_t error;
-    failed_chapter_t failed_chapters[MAX_CHAPTERS];
+    job_t* job;
 
+    /* 분할 중에는 실행 버튼이 취소 버튼 */
+    if (s_job && s_job->kind == JOB_SPLIT) {
+        pdf_cancel_request(&s_job->cancel);
+        EnableWindow(s_hwnd_split_btn_run, FALSE);
+        update_status(L"취소하는 중...");
+        return;
+    }
+
+    if (!job_check_idle()) return;
     if (wcslen(s_split_pdf_path) == 0) {
         MessageBoxW(hwnd, L"PDF 파일을 선택하세요.", L"오류", MB_OK | MB_ICONERROR);
         return;
@@ -842,46 +1076,60 @@ static void split_run(HWND hwnd)
         }
     }
 
-    EnableWindow(s_hwnd_split_btn_run, FALSE);
+    job = (job_t*)calloc(1, sizeof(job_t));
+    if (!job) return;
+    job->kind = JOB_SPLIT;
+    wcscpy_s(job->path, MAX_PATH, s_split_pdf_path);
+    wcscpy_s(job->out_dir, MAX_PATH, s_split_out_path);
+    memcpy(job->chapters, s_chapters, sizeof(chapter_t) * s_chapter_count);
+    job->chapter_count = s_chapter_count;
+
+    SetWindowTextW(s_hwnd_split_btn_run, L"분할 취소");
 
     /* Show and setup progress bar */
     ShowWindow(s_hwnd_split_progress, SW_SHOW);
-    SendMessageW(s_hwnd_split_progress, PBM_SETRANGE32, 0, s_chapter_count);
+    SendMessageW(s_hwnd_split_progress, PBM_SETRANGE32, 0, PROGRESS_RANGE);
     SendMessageW(s_hwnd_split_progress, PBM_SETPOS, 0, 0);
 
-    for (i = 0; i < s_chapter_count; i++) {
-        /* Update progress */
-        SendMessageW(s_hwnd_split_progress, PBM_SETPOS, i + 1, 0);
-        swprintf_s(msg, 1024, L"분할 중... (%d/%d)", i + 1, s_chapter_count);
-        update_status(msg);
+    if (!job_start(job)) {
+        ShowWindow(s_hwnd_split_progress, SW_HIDE);
+        SetWindowTextW(s_hwnd_split_btn_run, L"PDF 분할 실행");
+    }
+}
 
-        /* Process messages to keep UI responsive */
-        while (PeekMessage(&winmsg, NULL, 0, 0, PM_REMOVE)) {
-            TranslateMessage(&winmsg);
-            DispatchMessage(&winmsg);
-        }
+static void split_finish(job_t* job)
+{
+    int i, fail_count = 0;
+    int success = job->success;
+    WCHAR msg[256];
+    WCHAR stats[192];
+    failed_chapter_t failed_chapters[MAX_CHAPTERS];
+    HWND hwnd = s_hwnd_main;
 
-        swprintf_s(out_path, MAX_PATH, L"%s\\%s.pdf", s_split_out_path, s_chapters[i].name);
-        error = PDF_OK;
-        if (pdf_split(s_split_pdf_path, out_path, s_chapters[i].start_page, s_chapters[i].end_page, &error)) {
-            success++;
-        } else {
+    for (i = 0; i < job->chapter_count; i++) {
+        if (job->results[i] != PDF_OK && fail_count < MAX_CHAPTERS) {
             /* 실패한 챕터 정보 저장 */
-            if (fail_count < MAX_CHAPTERS) {
-                wcscpy_s(failed_chapters[fail_count].name, NAME_LENGTH, s_chapters[i].name);
-                failed_chapters[fail_count].start_page = s_chapters[i].start_page;
-                failed_chapters[fail_count].end_page = s_chapters[i].end_page;
-                failed_chapters[fail_count].error = error;
-                fail_count++;
-            }
+            wcscpy_s(failed_chapters[fail_count].name, NAME_LENGTH, job->chapters[i].name);
+            wcscpy_s(failed_chapters[fail_count].pages, PAGES_LENGTH, job->chapters[i].pages);
+            failed_chapters[fail_count].error = job->results[i];
+            fail_count++;
         }
     }
 
     /* Hide progress bar */
     ShowWindow(s_hwnd_split_progress, SW_HIDE);
+    SetWindowTextW(s_hwnd_split_btn_run, L"PDF 분할 실행");
     EnableWindow(s_hwnd_split_btn_run, TRUE);
 
-    swprintf_s(msg, 256, L"완료: %d/%d 챕터 분할됨", success, s_chapter_count);
+    /* 취소: 이미 기록된 챕터는 남아 있음 */
+    if (job->error == PDF_ERR_CANCELLED) {
+        swprintf_s(msg, 256, L"취소됨: %d/%d 챕터 분할됨", success, job->chapter_count);
+        update_status(msg);
+        return;
+    }
+
+    pdf_stats_format(&job->stats, stats, 192);
+    swprintf_s(msg, 256, L"완료: %d/%d 챕터 분할됨 - %s", success, job->chapter_count, stats);
     update_status(msg);
 
     /* 결과 표시 */
@@ -891,20 +1139,19 @@ static void split_run(HWND hwnd)
 
         if (success > 0) {
             offset = swprintf_s(result_msg, 2048, L"분할 완료\n\n성공: %d/%d 챕터\n실패: %d개\n\n",
-                               success, s_chapter_count, fail_count);
+                               success, job->chapter_count, fail_count);
         } else {
             offset = swprintf_s(result_msg, 2048, L"분할 실패\n\n모든 챕터(%d개)가 실패했습니다.\n\n",
-                               s_chapter_count);
+                               job->chapter_count);
         }
 
         /* 실패한 챕터 목록 (최대 5개까지만 표시) */
         wcscat_s(result_msg, 2048, L"실패한 챕터:\n");
         for (i = 0; i < fail_count && i < 5; i++) {
             WCHAR fail_item[256];
-            swprintf_s(fail_item, 256, L"  - %s (페이지 %d~%d): %s\n",
+            swprintf_s(fail_item, 256, L"  - %s (페이지 %s): %s\n",
                       failed_chapters[i].name,
-                      failed_chapters[i].start_page,
-                      failed_chapters[i].end_page,
+                      failed_chapters[i].pages,
                       pdf_error_message(failed_chapters[i].error));
             wcscat_s(result_msg, 2048, fail_item);
         }
@@ -918,11 +1165,11 @@ static void split_run(HWND hwnd)
                     success > 0 ? MB_OK | MB_ICONWARNING : MB_OK | MB_ICONERROR);
 
         if (success > 0 && MessageBoxW(hwnd, L"폴더를 열까요?", L"확인", MB_YESNO) == IDYES) {
-            ShellExecuteW(NULL, L"open", s_split_out_path, NULL, NULL, SW_SHOWNORMAL);
+            ShellExecuteW(NULL, L"open", job->out_dir, NULL, NULL, SW_SHOWNORMAL);
         }
     } else if (success > 0) {
         if (MessageBoxW(hwnd, L"분할 완료! 폴더를 열까요?", L"완료", MB_YESNO) == IDYES) {
-            ShellExecuteW(NULL, L"open", s_split_out_path, NULL, NULL, SW_SHOWNORMAL);
+            ShellExecuteW(NULL, L"open", job->out_dir, NULL, NULL, SW_SHOWNORMAL);
         }
     }
 }
@@ -1134,28 +1381,6 @@ static void merge_refresh_list(void)
     update_status(msg);
 }
 
-/* Progress callback for merge */
-static void merge_progress_callback(int current, int total, void* user_data)
-{
-    WCHAR msg[64];
-    (void)user_data;
-
-    /* Update progress bar */
-    SendMessageW(s_hwnd_merge_progress, PBM_SETRANGE32, 0, total);
-    SendMessageW(s_hwnd_merge_progress, PBM_SETPOS, current, 0);
-
-    /* Update status text */
-    swprintf_s(msg, 64, L"병합 중... (%d/%d)", current, total);
-    update_status(msg);
-
-    /* Process messages to keep UI responsive */
-    MSG winmsg;
-    while (PeekMessage(&winmsg, NULL, 0, 0, PM_REMOVE)) {
-        TranslateMessage(&winmsg);
-        DispatchMessage(&winmsg);
-    }
-}
-
 /* 출력 경로 검증 헬퍼 함수 */
 static int validate_output_path(HWND hwnd, const WCHAR* path)
 {
@@ -1206,13 +1431,18 @@ static int validate_output_path(HWND hwnd, const WCHAR* path)
 
 static void merge_run(HWND hwnd)
 {
-    const WCHAR* paths[MAX_MERGE_FILES];
-    WCHAR msg[512];
     int i;
-    pdf_error_t error = PDF_OK;
-    int failed_index = -1;
-    WCHAR* failed_filename;
+    job_t* job;
+
+    /* 병합 중에는 실행 버튼이 취소 버튼 */
+    if (s_job && s_job->kind == JOB_MERGE) {
+        pdf_cancel_request(&s_job->cancel);
+        EnableWindow(s_hwnd_merge_btn_run, FALSE);
+        update_status(L"취소하는 중...");
+        return;
+    }
 
+    if (!job_check_idle()) return;
     if (s_merge_file_count < 2) {
         MessageBoxW(hwnd, L"2개 이상의 PDF 파일을 추가하세요.", L"오류", MB_OK | MB_ICONERROR);
         return;
@@ -1227,43 +1457,67 @@ static void merge_run(HWND hwnd)
         return;
     }
 
+    job = (job_t*)calloc(1, sizeof(job_t));
+    if (!job) return;
+    job->kind = JOB_MERGE;
     for (i = 0; i < s_merge_file_count; i++) {
-        paths[i] = s_merge_files[i];
+        wcscpy_s(job->merge_files[i], MAX_PATH, s_merge_files[i]);
     }
+    job->merge_count = s_merge_file_count;
+    wcscpy_s(job->out_path, MAX_PATH, s_merge_out_path);
 
-    EnableWindow(s_hwnd_merge_btn_run, FALSE);
+    SetWindowTextW(s_hwnd_merge_btn_run, L"병합 취소");
 
     /* Show and reset progress bar */
     ShowWindow(s_hwnd_merge_progress, SW_SHOW);
+    SendMessageW(s_hwnd_merge_progress, PBM_SETRANGE32, 0, PROGRESS_RANGE);
     SendMessageW(s_hwnd_merge_progress, PBM_SETPOS, 0, 0);
     update_status(L"병합 시작...");
 
-    if (pdf_merge(paths, s_merge_file_count, s_merge_out_path, merge_progress_callback, NULL, &error, &failed_index)) {
-        /* Hide progress bar on success */
+    if (!job_start(job)) {
         ShowWindow(s_hwnd_merge_progress, SW_HIDE);
-        swprintf_s(msg, 512, L"병합 완료: %d개 파일", s_merge_file_count);
+        SetWindowTextW(s_hwnd_merge_btn_run, L"PDF 병합 실행");
+    }
+}
+
+static void merge_finish(job_t* job)
+{
+    WCHAR msg[512];
+    WCHAR stats[192];
+    WCHAR* failed_filename;
+    HWND hwnd = s_hwnd_main;
+
+    ShowWindow(s_hwnd_merge_progress, SW_HIDE);
+    SetWindowTextW(s_hwnd_merge_btn_run, L"PDF 병합 실행");
+    EnableWindow(s_hwnd_merge_btn_run, TRUE);
+
+    if (!job->success && job->error == PDF_ERR_CANCELLED) {
+        update_status(L"병합 취소됨");
+        return;
+    }
+
+    if (job->success) {
+        pdf_stats_format(&job->stats, stats, 192);
+        swprintf_s(msg, 512, L"병합 완료: %d개 파일 - %s", job->merge_count, stats);
         update_status(msg);
         if (MessageBoxW(hwnd, L"병합 완료! 폴더를 열까요?", L"완료", MB_YESNO) == IDYES) {
             /* Open folder and select the merged file */
             WCHAR cmd[MAX_PATH + 16];
-            swprintf_s(cmd, MAX_PATH + 16, L"/select,\"%s\"", s_merge_out_path);
+            swprintf_s(cmd, MAX_PATH + 16, L"/select,\"%s\"", job->out_path);
             ShellExecuteW(NULL, L"open", L"explorer.exe", cmd, NULL, SW_SHOWNORMAL);
         }
     } else {
-        ShowWindow(s_hwnd_merge_progress, SW_HIDE);
         update_status(L"병합 실패");
 
         /* 구체적인 오류 메시지 생성 */
-        if (failed_index >= 0 && failed_index < s_merge_file_count) {
-            failed_filename = wcsrchr(s_merge_files[failed_index], L'\\');
-            failed_filename = failed_filename ? failed_filename + 1 : s_merge_files[failed_index];
+        if (job->failed_index >= 0 && job->failed_index < job->merge_count) {
+            failed_filename = wcsrchr(job->merge_files[job->failed_index], L'\\');
+            failed_filename = failed_filename ? failed_filename + 1 : job->merge_files[job->failed_index];
             swprintf_s(msg, 512, L"병합에 실패했습니다.\n\n문제 파일: %s\n\n%s",
-                       failed_filename, pdf_error_message(error));
+                       failed_filename, pdf_error_message(job->error));
         } else {
-            swprintf_s(msg, 512, L"병합에 실패했습니다.\n\n%s", pdf_error_message(error));
+            swprintf_s(msg, 512, L"병합에 실패했습니다.\n\n%s", pdf_error_message(job->error));
         }
         MessageBoxW(hwnd, msg, L"병합 오류", MB_OK | MB_ICONERROR);
     }
-
-    EnableWindow(s_hwnd_merge_btn_run, TRUE);
 }
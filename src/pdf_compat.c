@@ -0,0 +1,625 @@
+/*
+ * pdf_compat.c - Win32 subset on POSIX (see pdf_compat.h)
+ */
+
+#include "pdf_compat.h"
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+/* 100 ns intervals between 1601-01-01 and 1970-01-01 */
+#define FILETIME_UNIX_EPOCH 116444736000000000ull
+
+typedef enum { HANDLE_FILE, HANDLE_MAPPING, HANDLE_THREAD } handle_kind_t;
+
+typedef struct compat_handle {
+    handle_kind_t kind;
+    int fd;                         /* file; mapping (dup of the file) */
+    long long pos;                  /* file pointer for SetEndOfFile */
+    pthread_t thread;
+    LPTHREAD_START_ROUTINE start;
+    LPVOID param;
+} compat_handle_t;
+
+DWORD GetLastError(void)
+{
+    switch (errno) {
+        case 0: return ERROR_SUCCESS;
+        case ENOENT: return ERROR_FILE_NOT_FOUND;
+        case ENOTDIR: case ENAMETOOLONG: return ERROR_PATH_NOT_FOUND;
+        case EACCES: case EPERM: case EROFS: return ERROR_ACCESS_DENIED;
+        case EBUSY: case ETXTBSY: return ERROR_SHARING_VIOLATION;
+        case ENOMEM: return ERROR_NOT_ENOUGH_MEMORY;
+        case ECANCELED: return ERROR_REQUEST_ABORTED;
+        default: return ERROR_GEN_FAILURE;
+    }
+}
+
+/* ==================== Strings ==================== */
+
+int WideCharToMultiByte(unsigned int code_page, DWORD flags, const WCHAR* wstr, int wlen,
+                        char* str, int len, const char* default_char, BOOL* used_default)
+{
+    int out = 0;
+    int i;
+
+    (void)code_page; (void)flags; (void)default_char;
+    if (used_default) *used_default = FALSE;
+    if (wlen < 0) wlen = (int)wcslen(wstr) + 1;
+
+    for (i = 0; i < wlen; i++) {
+        unsigned long c = (unsigned long)wstr[i];
+        unsigned char buf[4];
+        int n, k;
+
+        if (c >= 0xDC80 && c <= 0xDCFF) {
+            /* Byte that was not valid UTF-8 (see MultiByteToWideChar) */
+            buf[0] = (unsigned char)(c & 0xFF); n = 1;
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            buf[0] = 0xEF; buf[1] = 0xBF; buf[2] = 0xBD; n = 3;
+        } else if (c < 0x80) {
+            buf[0] = (unsigned char)c; n = 1;
+        } else if (c < 0x800) {
+            buf[0] = (unsigned char)(0xC0 | (c >> 6));
+            buf[1] = (unsigned char)(0x80 | (c & 0x3F)); n = 2;
+        } else if (c < 0x10000) {
+            buf[0] = (unsigned char)(0xE0 | (c >> 12));
+            buf[1] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            buf[2] = (unsigned char)(0x80 | (c & 0x3F)); n = 3;
+        } else if (c < 0x110000) {
+            buf[0] = (unsigned char)(0xF0 | (c >> 18));
+            buf[1] = (unsigned char)(0x80 | ((c >> 12) & 0x3F));
+            buf[2] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            buf[3] = (unsigned char)(0x80 | (c & 0x3F)); n = 4;
+        } else {
+            buf[0] = 0xEF; buf[1] = 0xBF; buf[2] = 0xBD; n = 3;
+        }
+
+        if (len > 0) {
+            if (out + n > len) { errno = ENAMETOOLONG; return 0; }
+            for (k = 0; k < n; k++) str[out + k] = (char)buf[k];
+        }
+        out += n;
+    }
+    return out;
+}
+
+int MultiByteToWideChar(unsigned int code_page, DWORD flags, const char* str, int len,
+                        WCHAR* wstr, int wlen)
+{
+    const unsigned char* s = (const unsigned char*)str;
+    int out = 0;
+    int i = 0;
+
+    (void)code_page; (void)flags;
+    if (len < 0) len = (int)strlen(str) + 1;
+
+    while (i < len) {
+        static const unsigned long min_code[4] = { 0, 0x80, 0x800, 0x10000 };
+        unsigned long c = s[i];
+        int n = c < 0x80 ? 0 : c >= 0xF8 ? -1 : c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+        int k;
+
+        if (n > 0 && i + n >= len) {
+            n = -1;
+        } else if (n > 0) {
+            c &= 0x3F >> n;
+            for (k = 1; k <= n; k++) {
+                if ((s[i + k] & 0xC0) != 0x80) break;
+                c = (c << 6) | (s[i + k] & 0x3F);
+            }
+            /* Truncated, overlong, surrogate or out of range: not valid UTF-8 */
+            if (k <= n || c < min_code[n] || (c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) n = -1;
+        }
+        if (n < 0) {
+            /* Keep the byte as U+DC80..U+DCFF so WideCharToMultiByte restores it
+               (file names in other encodings still open) */
+            c = 0xDC00 | s[i]; n = 0;
+        }
+        i += n + 1;
+
+        if (wlen > 0) {
+            if (out >= wlen) { errno = ENAMETOOLONG; return 0; }
+            wstr[out] = (WCHAR)c;
+        }
+        out++;
+    }
+    return out;
+}
+
+/* Wide path to a UTF-8 buffer of PATH_BYTES bytes */
+#define PATH_BYTES (MAX_PATH * 4)
+
+static int path_to_utf8(const WCHAR* path, char* out)
+{
+    return WideCharToMultiByte(CP_UTF8, 0, path, -1, out, PATH_BYTES, NULL, NULL) != 0;
+}
+
+int wcscpy_s(WCHAR* dst, size_t size, const WCHAR* src)
+{
+    size_t len = wcslen(src);
+    if (len >= size) {
+        if (size) dst[0] = L'\0';
+        return ERANGE;
+    }
+    wmemcpy(dst, src, len + 1);
+    return 0;
+}
+
+int wcscat_s(WCHAR* dst, size_t size, const WCHAR* src)
+{
+    size_t used = wcslen(dst);
+    if (used >= size) return EINVAL;
+    return wcscpy_s(dst + used, size - used, src);
+}
+
+/* ==================== Files ==================== */
+
+HANDLE CreateFileW(const WCHAR* path, DWORD access, DWORD share, void* security,
+                   DWORD disposition, DWORD flags, HANDLE template_file)
+{
+    char path_a[PATH_BYTES];
+    compat_handle_t* h;
+    int mode = (access & GENERIC_WRITE) ? ((access & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+    int fd;
+
+    (void)share; (void)security; (void)disposition; (void)flags; (void)template_file;
+    if (!path_to_utf8(path, path_a)) return INVALID_HANDLE_VALUE;
+    fd = open(path_a, mode | O_CLOEXEC);
+    if (fd < 0) return INVALID_HANDLE_VALUE;
+
+    h = (compat_handle_t*)calloc(1, sizeof(*h));
+    if (!h) {
+        close(fd);
+        errno = ENOMEM;
+        return INVALID_HANDLE_VALUE;
+    }
+    h->kind = HANDLE_FILE;
+    h->fd = fd;
+    return h;
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+    compat_handle_t* h = (compat_handle_t*)handle;
+    int ok = 1;
+
+    if (!h || handle == INVALID_HANDLE_VALUE) return FALSE;
+    if (h->kind == HANDLE_THREAD) {
+        /* Already joined by WaitForSingleObject, or never waited for */
+        if (h->start) ok = pthread_detach(h->thread) == 0;
+    } else {
+        ok = close(h->fd) == 0;
+    }
+    free(h);
+    return ok;
+}
+
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* size)
+{
+    struct stat st;
+    if (fstat(((compat_handle_t*)file)->fd, &st) != 0) return FALSE;
+    size->QuadPart = (LONGLONG)st.st_size;
+    return TRUE;
+}
+
+BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* new_pos, DWORD method)
+{
+    compat_handle_t* h = (compat_handle_t*)file;
+    if (method != FILE_BEGIN || distance.QuadPart < 0) {
+        errno = EINVAL;
+        return FALSE;
+    }
+    h->pos = distance.QuadPart;
+    if (new_pos) new_pos->QuadPart = h->pos;
+    return TRUE;
+}
+
+BOOL SetEndOfFile(HANDLE file)
+{
+    compat_handle_t* h = (compat_handle_t*)file;
+    return ftruncate(h->fd, (off_t)h->pos) == 0;
+}
+
+BOOL GetFileAttributesExW(const WCHAR* path, GET_FILEEX_INFO_LEVELS level, void* info)
+{
+    WIN32_FILE_ATTRIBUTE_DATA* attr = (WIN32_FILE_ATTRIBUTE_DATA*)info;
+    char path_a[PATH_BYTES];
+    struct stat st;
+    unsigned long long size, mtime;
+
+    (void)level;
+    if (!path_to_utf8(path, path_a) || stat(path_a, &st) != 0) return FALSE;
+
+    size = (unsigned long long)st.st_size;
+    mtime = FILETIME_UNIX_EPOCH + (unsigned long long)st.st_mtim.tv_sec * 10000000ull +
+            (unsigned long long)st.st_mtim.tv_nsec / 100;
+
+    memset(attr, 0, sizeof(*attr));
+    attr->nFileSizeHigh = (DWORD)(size >> 32);
+    attr->nFileSizeLow = (DWORD)(size & 0xFFFFFFFFu);
+    attr->ftLastWriteTime.dwHighDateTime = (DWORD)(mtime >> 32);
+    attr->ftLastWriteTime.dwLowDateTime = (DWORD)(mtime & 0xFFFFFFFFu);
+    return TRUE;
+}
+
+LONG CompareFileTime(const FILETIME* a, const FILETIME* b)
+{
+    if (a->dwHighDateTime != b->dwHighDateTime) return a->dwHighDateTime < b->dwHighDateTime ? -1 : 1;
+    if (a->dwLowDateTime != b->dwLowDateTime) return a->dwLowDateTime < b->dwLowDateTime ? -1 : 1;
+    return 0;
+}
+
+BOOL DeleteFileW(const WCHAR* path)
+{
+    char path_a[PATH_BYTES];
+    return path_to_utf8(path, path_a) && unlink(path_a) == 0;
+}
+
+/* rename() replaces atomically; the flags are what the library always asks for */
+BOOL MoveFileExW(const WCHAR* from, const WCHAR* to, DWORD flags)
+{
+    char from_a[PATH_BYTES], to_a[PATH_BYTES];
+    (void)flags;
+    return path_to_utf8(from, from_a) && path_to_utf8(to, to_a) && rename(from_a, to_a) == 0;
+}
+
+BOOL CreateDirectoryW(const WCHAR* path, void* security)
+{
+    char path_a[PATH_BYTES];
+    (void)security;
+    return path_to_utf8(path, path_a) && mkdir(path_a, 0777) == 0;
+}
+
+DWORD GetFullPathNameW(const WCHAR* path, DWORD len, WCHAR* buf, WCHAR** file_part)
+{
+    char path_a[PATH_BYTES];
+    char* full;
+    int n;
+
+    if (file_part) *file_part = NULL;
+    if (!path_to_utf8(path, path_a)) return 0;
+    full = realpath(path_a, NULL);
+    if (!full) return 0;
+    n = MultiByteToWideChar(CP_UTF8, 0, full, -1, buf, (int)len);
+    free(full);
+    return n > 0 ? (DWORD)(n - 1) : 0;
+}
+
+/* $TMPDIR or /tmp, with a trailing slash */
+DWORD GetTempPathW(DWORD len, WCHAR* buf)
+{
+    const char* dir = getenv("TMPDIR");
+    int n;
+
+    if (!dir || !dir[0]) dir = "/tmp";
+    n = MultiByteToWideChar(CP_UTF8, 0, dir, -1, buf, (int)len - 1);
+    if (n == 0) return 0;
+    if (n >= 2 && buf[n - 2] != L'/') {
+        buf[n - 1] = L'/';
+        buf[n] = L'\0';
+        n++;
+    }
+    return (DWORD)(n - 1);
+}
+
+/*
+ * Creates dir/<prefix>XXXXXX (first 3 prefix characters, like Win32).
+ * Not mkstemp: its 0600 would carry over to the output renamed from the
+ * temp file, so the file is created 0666 and the umask applies, as with
+ * CopyFileExW.
+ */
+unsigned int GetTempFileNameW(const WCHAR* dir, const WCHAR* prefix, unsigned int unique, WCHAR* out)
+{
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    static volatile LONG counter = 0;
+    char path_a[PATH_BYTES];
+    WCHAR name[MAX_PATH];
+    size_t dir_len = wcslen(dir);
+    size_t len;
+    struct timespec ts;
+    unsigned long long seed;
+    int fd = -1, attempt, i;
+
+    (void)unique;
+    if (swprintf(name, MAX_PATH, L"%ls%ls%.3lsXXXXXX", dir,
+                 (dir_len && dir[dir_len - 1] != L'/') ? L"/" : L"", prefix) < 0) {
+        errno = ENAMETOOLONG;
+        return 0;
+    }
+    if (!path_to_utf8(name, path_a)) return 0;
+
+    len = strlen(path_a);
+    for (attempt = 0; attempt < 100 && fd < 0; attempt++) {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        seed = (unsigned long long)ts.tv_nsec ^ ((unsigned long long)getpid() << 32) ^
+               (unsigned long long)InterlockedIncrement(&counter) * 0x9E3779B97F4A7C15ull;
+        for (i = 0; i < 6; i++) {
+            path_a[len - 6 + i] = chars[seed % 62];
+            seed /= 62;
+        }
+        fd = open(path_a, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0 && errno != EEXIST) return 0;
+    }
+    if (fd < 0) return 0;
+    close(fd);
+
+    if (MultiByteToWideChar(CP_UTF8, 0, path_a, -1, out, MAX_PATH) == 0) {
+        unlink(path_a);
+        return 0;
+    }
+    return 1;
+}
+
+BOOL CopyFileExW(const WCHAR* src, const WCHAR* dst, LPPROGRESS_ROUTINE progress, LPVOID data,
+                 BOOL* cancel, DWORD flags)
+{
+    char src_a[PATH_BYTES], dst_a[PATH_BYTES];
+    LARGE_INTEGER total, done;
+    struct stat st;
+    char* buf;
+    int in, out;
+    int ok = 0;
+
+    (void)cancel; (void)flags;
+    if (!path_to_utf8(src, src_a) || !path_to_utf8(dst, dst_a)) return FALSE;
+
+    in = open(src_a, O_RDONLY | O_CLOEXEC);
+    if (in < 0) return FALSE;
+    if (fstat(in, &st) != 0) {
+        close(in);
+        return FALSE;
+    }
+    out = open(dst_a, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (out < 0) {
+        close(in);
+        return FALSE;
+    }
+
+    buf = (char*)malloc(1 << 20);
+    total.QuadPart = (LONGLONG)st.st_size;
+    done.QuadPart = 0;
+
+    if (!buf) {
+        errno = ENOMEM;
+    } else {
+        for (;;) {
+            ssize_t n = read(in, buf, 1 << 20);
+            ssize_t w = 0;
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) break;
+            if (n == 0) { ok = 1; break; }
+            while (w < n) {
+                ssize_t k = write(out, buf + w, (size_t)(n - w));
+                if (k < 0 && errno == EINTR) continue;
+                if (k <= 0) break;
+                w += k;
+            }
+            if (w < n) break;
+            done.QuadPart += n;
+            if (progress && progress(total, done, total, done, 1, 0, NULL, NULL, data) == PROGRESS_CANCEL) {
+                errno = ECANCELED;
+                break;
+            }
+        }
+    }
+
+    free(buf);
+    close(in);
+    if (close(out) != 0) ok = 0;
+    if (!ok) {
+        int err = errno;
+        unlink(dst_a);
+        errno = err;
+    }
+    return ok;
+}
+
+HANDLE CreateFileMappingW(HANDLE file, void* security, DWORD protect, DWORD size_high,
+                          DWORD size_low, const WCHAR* name)
+{
+    compat_handle_t* h;
+    int fd;
+
+    (void)security; (void)protect; (void)size_high; (void)size_low; (void)name;
+    fd = dup(((compat_handle_t*)file)->fd);
+    if (fd < 0) return NULL;
+
+    h = (compat_handle_t*)calloc(1, sizeof(*h));
+    if (!h) {
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+    h->kind = HANDLE_MAPPING;
+    h->fd = fd;
+    return h;
+}
+
+/* munmap() needs the length, so live views are kept in a short list */
+typedef struct view_entry {
+    const void* addr;
+    size_t size;
+    struct view_entry* next;
+} view_entry_t;
+
+static view_entry_t* g_views;
+static pthread_mutex_t g_views_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void* MapViewOfFile(HANDLE mapping, DWORD access, DWORD offset_high, DWORD offset_low, size_t size)
+{
+    compat_handle_t* h = (compat_handle_t*)mapping;
+    view_entry_t* entry;
+    struct stat st;
+    void* view;
+
+    (void)access; (void)offset_high; (void)offset_low;
+    if (size == 0) {
+        if (fstat(h->fd, &st) != 0) return NULL;
+        size = (size_t)st.st_size;
+    }
+    entry = (view_entry_t*)malloc(sizeof(*entry));
+    if (!entry) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    view = mmap(NULL, size, PROT_READ, MAP_SHARED, h->fd, 0);
+    if (view == MAP_FAILED) {
+        free(entry);
+        return NULL;
+    }
+
+    entry->addr = view;
+    entry->size = size;
+    pthread_mutex_lock(&g_views_lock);
+    entry->next = g_views;
+    g_views = entry;
+    pthread_mutex_unlock(&g_views_lock);
+    return view;
+}
+
+BOOL UnmapViewOfFile(const void* view)
+{
+    view_entry_t** link;
+    view_entry_t* entry = NULL;
+    int ok;
+
+    pthread_mutex_lock(&g_views_lock);
+    for (link = &g_views; *link; link = &(*link)->next) {
+        if ((*link)->addr == view) {
+            entry = *link;
+            *link = entry->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_views_lock);
+
+    if (!entry) {
+        errno = EINVAL;
+        return FALSE;
+    }
+    ok = munmap((void*)entry->addr, entry->size) == 0;
+    free(entry);
+    return ok;
+}
+
+FILE* _wfopen(const WCHAR* path, const WCHAR* mode)
+{
+    char path_a[PATH_BYTES];
+    char mode_a[8];
+
+    if (!path_to_utf8(path, path_a)) return NULL;
+    if (WideCharToMultiByte(CP_UTF8, 0, mode, -1, mode_a, (int)sizeof(mode_a), NULL, NULL) == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return fopen(path_a, mode_a);
+}
+
+/* ==================== Threads ==================== */
+
+static void* thread_main(void* param)
+{
+    compat_handle_t* h = (compat_handle_t*)param;
+    h->start(h->param);
+    return NULL;
+}
+
+HANDLE CreateThread(void* security, size_t stack_size, LPTHREAD_START_ROUTINE start, LPVOID param,
+                    DWORD flags, DWORD* thread_id)
+{
+    compat_handle_t* h;
+    int rc;
+
+    (void)security; (void)stack_size; (void)flags;
+    if (thread_id) *thread_id = 0;
+
+    h = (compat_handle_t*)calloc(1, sizeof(*h));
+    if (!h) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    h->kind = HANDLE_THREAD;
+    h->start = start;
+    h->param = param;
+
+    rc = pthread_create(&h->thread, NULL, thread_main, h);
+    if (rc != 0) {
+        free(h);
+        errno = rc;
+        return NULL;
+    }
+    return h;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD ms)
+{
+    compat_handle_t* h = (compat_handle_t*)handle;
+
+    (void)ms;
+    if (h->kind != HANDLE_THREAD || !h->start) return 0;
+    pthread_join(h->thread, NULL);
+    h->start = NULL;                /* joined: CloseHandle must not detach */
+    return 0;
+}
+
+void GetSystemInfo(SYSTEM_INFO* info)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    memset(info, 0, sizeof(*info));
+    info->dwNumberOfProcessors = n > 0 ? (DWORD)n : 1;
+}
+
+ULONGLONG GetTickCount64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ULONGLONG)ts.tv_sec * 1000ull + (ULONGLONG)ts.tv_nsec / 1000000ull;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    counter->QuadPart = (LONGLONG)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* freq)
+{
+    freq->QuadPart = 1000000000LL;
+    return TRUE;
+}
+
+void Sleep(DWORD ms)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ms / 1000);
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+DWORD GetCurrentThreadId(void)
+{
+#ifdef __linux__
+    return (DWORD)syscall(SYS_gettid);
+#else
+    return (DWORD)(uintptr_t)pthread_self();
+#endif
+}
+
+#endif /* !_WIN32 */
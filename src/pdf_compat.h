@@ -0,0 +1,202 @@
+/*
+ * pdf_compat.h
+ * Platform layer (internal)
+ *
+ * The library is written against the Win32 API. On Windows this header is
+ * just <windows.h>; elsewhere it declares the small subset the library
+ * uses (files, mappings, threads, locks, UTF-8 conversion) on top of
+ * POSIX, so pdf_tools.c and friends compile unchanged. Only the flags and
+ * error codes the library actually passes or checks are provided.
+ */
+
+#ifndef PDF_COMPAT_H
+#define PDF_COMPAT_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+/* Paths are case-insensitive on Windows */
+#define pdf_path_cmp _wcsicmp
+
+#else /* POSIX */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <wchar.h>
+
+typedef int BOOL;
+typedef wchar_t WCHAR;
+typedef long LONG;
+typedef unsigned long DWORD;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef union { LONGLONG QuadPart; } LARGE_INTEGER;
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+#define WINAPI
+#define CALLBACK
+#define INFINITE 0xFFFFFFFFul
+#define MAX_PATH 1024
+
+#define pdf_path_cmp wcscmp
+
+/* GetLastError() values (mapped from errno) */
+#define ERROR_SUCCESS 0
+#define ERROR_FILE_NOT_FOUND 2
+#define ERROR_PATH_NOT_FOUND 3
+#define ERROR_ACCESS_DENIED 5
+#define ERROR_NOT_ENOUGH_MEMORY 8
+#define ERROR_SHARING_VIOLATION 32
+#define ERROR_REQUEST_ABORTED 1235
+#define ERROR_GEN_FAILURE 31
+
+DWORD GetLastError(void);
+
+/* ---- Files ---- */
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONGLONG)-1)
+#define GENERIC_READ 0x80000000ul
+#define GENERIC_WRITE 0x40000000ul
+#define FILE_SHARE_READ 0x1
+#define FILE_SHARE_WRITE 0x2
+#define FILE_SHARE_DELETE 0x4
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_BEGIN 0
+#define MOVEFILE_REPLACE_EXISTING 0x1
+#define MOVEFILE_WRITE_THROUGH 0x8
+
+typedef struct { DWORD dwLowDateTime; DWORD dwHighDateTime; } FILETIME;
+
+typedef struct {
+    DWORD dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD nFileSizeHigh;
+    DWORD nFileSizeLow;
+} WIN32_FILE_ATTRIBUTE_DATA;
+
+typedef enum { GetFileExInfoStandard } GET_FILEEX_INFO_LEVELS;
+
+/* Share mode, security and template arguments are ignored */
+HANDLE CreateFileW(const WCHAR* path, DWORD access, DWORD share, void* security,
+                   DWORD disposition, DWORD flags, HANDLE template_file);
+BOOL CloseHandle(HANDLE h);
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* size);
+BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* new_pos, DWORD method);
+BOOL SetEndOfFile(HANDLE file);
+BOOL GetFileAttributesExW(const WCHAR* path, GET_FILEEX_INFO_LEVELS level, void* info);
+LONG CompareFileTime(const FILETIME* a, const FILETIME* b);
+BOOL DeleteFileW(const WCHAR* path);
+BOOL MoveFileExW(const WCHAR* from, const WCHAR* to, DWORD flags);
+BOOL CreateDirectoryW(const WCHAR* path, void* security);
+DWORD GetTempPathW(DWORD len, WCHAR* buf);
+/* realpath(): the file must exist; 0 (not the needed size) if buf is too small */
+DWORD GetFullPathNameW(const WCHAR* path, DWORD len, WCHAR* buf, WCHAR** file_part);
+unsigned int GetTempFileNameW(const WCHAR* dir, const WCHAR* prefix, unsigned int unique, WCHAR* out);
+
+#define PROGRESS_CONTINUE 0
+#define PROGRESS_CANCEL 1
+
+typedef DWORD (*LPPROGRESS_ROUTINE)(LARGE_INTEGER total_size, LARGE_INTEGER transferred,
+                                    LARGE_INTEGER stream_size, LARGE_INTEGER stream_transferred,
+                                    DWORD stream_number, DWORD reason, HANDLE src, HANDLE dst,
+                                    LPVOID data);
+
+/* Only a cancelled copy is reported through progress; the destination is replaced */
+BOOL CopyFileExW(const WCHAR* src, const WCHAR* dst, LPPROGRESS_ROUTINE progress, LPVOID data,
+                 BOOL* cancel, DWORD flags);
+
+/* Whole-file, read-only mappings only */
+#define PAGE_READONLY 0x02
+#define FILE_MAP_READ 0x04
+
+HANDLE CreateFileMappingW(HANDLE file, void* security, DWORD protect, DWORD size_high,
+                          DWORD size_low, const WCHAR* name);
+void* MapViewOfFile(HANDLE mapping, DWORD access, DWORD offset_high, DWORD offset_low, size_t size);
+BOOL UnmapViewOfFile(const void* view);
+
+FILE* _wfopen(const WCHAR* path, const WCHAR* mode);
+#define _ftelli64 ftello
+#define _fseeki64 fseeko
+
+/* ---- Strings ---- */
+
+#define CP_UTF8 65001
+
+/*
+ * UTF-8 <-> UTF-32 wchar_t; same return conventions as Win32 (0 = failed).
+ * Bytes that are not valid UTF-8 become U+DC80..U+DCFF and are written back
+ * unchanged, so any POSIX file name survives the round trip.
+ */
+int WideCharToMultiByte(unsigned int code_page, DWORD flags, const WCHAR* wstr, int wlen,
+                        char* str, int len, const char* default_char, BOOL* used_default);
+int MultiByteToWideChar(unsigned int code_page, DWORD flags, const char* str, int len,
+                        WCHAR* wstr, int wlen);
+
+int wcscpy_s(WCHAR* dst, size_t size, const WCHAR* src);
+int wcscat_s(WCHAR* dst, size_t size, const WCHAR* src);
+#define _wcsdup wcsdup
+#define _wcsicmp wcscasecmp
+#define swprintf_s swprintf
+
+/* ---- Threads and synchronization ---- */
+
+typedef pthread_rwlock_t SRWLOCK;
+#define SRWLOCK_INIT PTHREAD_RWLOCK_INITIALIZER
+#define InitializeSRWLock(l) pthread_rwlock_init((l), NULL)
+#define AcquireSRWLockExclusive(l) pthread_rwlock_wrlock(l)
+#define ReleaseSRWLockExclusive(l) pthread_rwlock_unlock(l)
+#define AcquireSRWLockShared(l) pthread_rwlock_rdlock(l)
+#define ReleaseSRWLockShared(l) pthread_rwlock_unlock(l)
+
+typedef pthread_mutex_t CRITICAL_SECTION;
+#define InitializeCriticalSection(cs) pthread_mutex_init((cs), NULL)
+#define DeleteCriticalSection(cs) pthread_mutex_destroy(cs)
+#define EnterCriticalSection(cs) pthread_mutex_lock(cs)
+#define LeaveCriticalSection(cs) pthread_mutex_unlock(cs)
+
+typedef pthread_cond_t CONDITION_VARIABLE;
+#define InitializeConditionVariable(cv) pthread_cond_init((cv), NULL)
+#define WakeConditionVariable(cv) pthread_cond_signal(cv)
+#define WakeAllConditionVariable(cv) pthread_cond_broadcast(cv)
+/* Only INFINITE waits are supported */
+#define SleepConditionVariableCS(cv, cs, ms) pthread_cond_wait((cv), (cs))
+
+#define InterlockedIncrement(p) __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define InterlockedDecrement(p) __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define InterlockedExchange(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define InterlockedExchangeAdd64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+/* Returns the initial value, like the Win32 call */
+#define InterlockedCompareExchange(p, x, cmp) __sync_val_compare_and_swap((p), (cmp), (x))
+#define InterlockedCompareExchange64(p, x, cmp) __sync_val_compare_and_swap((p), (cmp), (x))
+
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID param);
+
+/* Stack size, flags and thread id are ignored */
+HANDLE CreateThread(void* security, size_t stack_size, LPTHREAD_START_ROUTINE start, LPVOID param,
+                    DWORD flags, DWORD* thread_id);
+/* Thread handles only; the timeout must be INFINITE */
+DWORD WaitForSingleObject(HANDLE h, DWORD ms);
+
+typedef struct { DWORD dwNumberOfProcessors; } SYSTEM_INFO;
+
+void GetSystemInfo(SYSTEM_INFO* info);
+ULONGLONG GetTickCount64(void);
+/* Monotonic clock in nanoseconds (frequency 1e9) */
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* freq);
+void Sleep(DWORD ms);
+DWORD GetCurrentThreadId(void);
+
+#endif /* _WIN32 */
+
+#endif /* PDF_COMPAT_H */
@@ -0,0 +1,629 @@
+/*
+ * pdf_dedup.c - Stream deduplication
+ *
+ * The objects below each page are walked depth first, every indirect
+ * object once. A stream is resolved when it is first reached: its
+ * dictionary is walked (collapsing the streams it references), then
+ * serialized with stream references replaced by their first copies, and
+ * the serialization plus the raw data are looked up among the streams
+ * seen so far. A match replaces the reference that led to the stream.
+ *
+ * Pages are compared the same way: after the walk, a page serializes to
+ * the same text as an earlier one exactly when its attributes, resources
+ * and content streams are equal by value.
+ */
+
+#include "pdf_dedup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEDUP_MAX_DEPTH 64          /* nesting walked below a page */
+#define DEDUP_INLINE_DEPTH 8        /* indirect objects inlined into a serialization */
+#define DEDUP_SERIALIZE_BUDGET 100000   /* values per serialization; larger ones never match */
+
+/* Indirect object reached by the walk */
+typedef struct seen_entry {
+    unsigned long long key;         /* (objid, generation), 0 = 빈 칸 */
+    int canon_id;                   /* 스트림의 첫 사본 객체 번호 (자기 자신 = 중복 아님) */
+    int canon_generation;
+} seen_entry_t;
+
+/* First copy of a stream */
+typedef struct stream_entry {
+    unsigned long long hash;        /* 사전 직렬화와 데이터의 해시 */
+    char* dict_text;                /* 사전 직렬화 (/Length 제외) */
+    size_t dict_len;
+    size_t data_len;
+    int objid;                      /* 0 = 빈 칸 */
+    int generation;
+} stream_entry_t;
+
+typedef struct text_buf {
+    char* data;
+    size_t len;
+    size_t cap;
+} text_buf_t;
+
+/* Page by serialization hash */
+typedef struct page_entry {
+    unsigned long long hash;
+    int index;                      /* 페이지 인덱스 + 1, 0 = 빈 칸 */
+} page_entry_t;
+
+typedef struct dedup {
+    qpdf_data qpdf;
+    const pdf_cancel_t* cancel;
+    pdf_dedup_result_t* result;
+    pdf_error_t error;              /* 첫 오류, 이후 탐색 중단 */
+    int rewrite;                    /* 1 = 중복 스트림 참조를 첫 사본으로 교체 */
+    long budget;                    /* 현재 직렬화에 남은 값 수 */
+    int self_id;                    /* 직렬화 중인 페이지 (자기 참조는 "self"), 0 = 없음 */
+    int self_generation;
+
+    seen_entry_t* seen;
+    size_t seen_cap;
+    size_t seen_count;
+
+    stream_entry_t* streams;
+    size_t streams_cap;
+    size_t streams_count;
+} dedup_t;
+
+/* ==================== Tables ==================== */
+
+static unsigned long long seen_key(int objid, int generation)
+{
+    return ((unsigned long long)(unsigned int)objid << 32) | (unsigned int)generation;
+}
+
+static size_t slot_of(unsigned long long hash, size_t cap)
+{
+    return (size_t)((hash * 0x9E3779B97F4A7C15ULL) >> 17) & (cap - 1);
+}
+
+static seen_entry_t* seen_find(const dedup_t* d, int objid, int generation)
+{
+    unsigned long long key = seen_key(objid, generation);
+    size_t i;
+
+    if (d->seen_cap == 0) return NULL;
+    for (i = slot_of(key, d->seen_cap); d->seen[i].key; i = (i + 1) & (d->seen_cap - 1)) {
+        if (d->seen[i].key == key) return &d->seen[i];
+    }
+    return NULL;
+}
+
+/* Record an object as its own first copy. Returns 0 if out of memory. */
+static int seen_add(dedup_t* d, int objid, int generation)
+{
+    unsigned long long key = seen_key(objid, generation);
+    seen_entry_t* grown;
+    size_t i, j;
+
+    /* Keep load factor under 1/2 */
+    if ((d->seen_count + 1) * 2 > d->seen_cap) {
+        size_t new_cap = d->seen_cap ? d->seen_cap * 2 : 1024;
+        grown = (seen_entry_t*)calloc(new_cap, sizeof(seen_entry_t));
+        if (!grown) {
+            d->error = PDF_ERR_MEMORY;
+            return 0;
+        }
+        for (i = 0; i < d->seen_cap; i++) {
+            if (!d->seen[i].key) continue;
+            for (j = slot_of(d->seen[i].key, new_cap); grown[j].key; j = (j + 1) & (new_cap - 1)) {}
+            grown[j] = d->seen[i];
+        }
+        free(d->seen);
+        d->seen = grown;
+        d->seen_cap = new_cap;
+    }
+
+    for (i = slot_of(key, d->seen_cap); d->seen[i].key; i = (i + 1) & (d->seen_cap - 1)) {}
+    d->seen[i].key = key;
+    d->seen[i].canon_id = objid;
+    d->seen[i].canon_generation = generation;
+    d->seen_count++;
+    return 1;
+}
+
+/* Takes over entry->dict_text on success. Returns 0 if out of memory. */
+static int streams_add(dedup_t* d, const stream_entry_t* entry)
+{
+    stream_entry_t* grown;
+    size_t i, j;
+
+    if ((d->streams_count + 1) * 2 > d->streams_cap) {
+        size_t new_cap = d->streams_cap ? d->streams_cap * 2 : 256;
+        grown = (stream_entry_t*)calloc(new_cap, sizeof(stream_entry_t));
+        if (!grown) {
+            d->error = PDF_ERR_MEMORY;
+            return 0;
+        }
+        for (i = 0; i < d->streams_cap; i++) {
+            if (!d->streams[i].objid) continue;
+            for (j = slot_of(d->streams[i].hash, new_cap); grown[j].objid; j = (j + 1) & (new_cap - 1)) {}
+            grown[j] = d->streams[i];
+        }
+        free(d->streams);
+        d->streams = grown;
+        d->streams_cap = new_cap;
+    }
+
+    for (i = slot_of(entry->hash, d->streams_cap); d->streams[i].objid; i = (i + 1) & (d->streams_cap - 1)) {}
+    d->streams[i] = *entry;
+    d->streams_count++;
+    return 1;
+}
+
+/* ==================== Helpers ==================== */
+
+/* 8 bytes per step; it only picks candidates, which are then compared */
+static unsigned long long hash_bytes(unsigned long long h, const void* data, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    unsigned long long w;
+    size_t i;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+    }
+    for (; i < len; i++) {
+        h = (h ^ p[i]) * 1099511628211ULL;
+    }
+    return h ^ (unsigned long long)len;
+}
+
+static void buf_append(dedup_t* d, text_buf_t* b, const char* s, size_t n)
+{
+    char* grown;
+    size_t cap;
+
+    if (d->error) return;
+    if (b->len + n + 1 > b->cap) {
+        cap = b->cap ? b->cap : 256;
+        while (cap < b->len + n + 1) cap *= 2;
+        grown = (char*)realloc(b->data, cap);
+        if (!grown) {
+            d->error = PDF_ERR_MEMORY;
+            return;
+        }
+        b->data = grown;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+    b->data[b->len] = '\0';
+}
+
+static void buf_puts(dedup_t* d, text_buf_t* b, const char* s)
+{
+    buf_append(d, b, s, strlen(s));
+}
+
+/* A failed object access leaves an error on the handle; take it off */
+static void clear_error(dedup_t* d)
+{
+    if (qpdf_has_error(d->qpdf)) qpdf_get_error(d->qpdf);
+}
+
+/*
+ * Keys of a dictionary. Copied because QPDF has a single key iterator
+ * per document and the walk recurses into the values.
+ */
+static char** dict_keys(dedup_t* d, qpdf_oh dict, int* count)
+{
+    char** keys = NULL;
+    char** grown;
+    const char* key;
+    int cap = 0;
+
+    *count = 0;
+    qpdf_oh_begin_dict_key_iter(d->qpdf, dict);
+    while (qpdf_oh_dict_more_keys(d->qpdf)) {
+        key = qpdf_oh_dict_next_key(d->qpdf);
+        if (*count == cap) {
+            grown = (char**)realloc(keys, (size_t)(cap ? cap * 2 : 16) * sizeof(char*));
+            if (!grown) {
+                d->error = PDF_ERR_MEMORY;
+                break;
+            }
+            keys = grown;
+            cap = cap ? cap * 2 : 16;
+        }
+        keys[*count] = (char*)malloc(strlen(key) + 1);
+        if (!keys[*count]) {
+            d->error = PDF_ERR_MEMORY;
+            break;
+        }
+        strcpy(keys[*count], key);
+        (*count)++;
+    }
+    return keys;
+}
+
+static void free_keys(char** keys, int count)
+{
+    int i;
+    for (i = 0; i < count; i++) free(keys[i]);
+    free(keys);
+}
+
+/* Pages, the page tree and the catalog are not walked into or inlined */
+static int is_structural(dedup_t* d, qpdf_oh oh)
+{
+    return qpdf_oh_is_dictionary_of_type(d->qpdf, oh, "/Page", "") ||
+           qpdf_oh_is_dictionary_of_type(d->qpdf, oh, "/Pages", "") ||
+           qpdf_oh_is_dictionary_of_type(d->qpdf, oh, "/Catalog", "");
+}
+
+/* ==================== Serialization ==================== */
+
+static void serialize_value(dedup_t* d, text_buf_t* b, qpdf_oh oh, int depth);
+
+/* Contents of a dictionary or array (also of an indirect one), skip_key left out */
+static void serialize_direct(dedup_t* d, text_buf_t* b, qpdf_oh oh, const char* skip_key, int depth)
+{
+    char** keys;
+    qpdf_oh item;
+    int i, n;
+
+    if (qpdf_oh_is_array(d->qpdf, oh)) {
+        buf_puts(d, b, "[");
+        n = qpdf_oh_get_array_n_items(d->qpdf, oh);
+        for (i = 0; i < n && !d->error; i++) {
+            item = qpdf_oh_get_array_item(d->qpdf, oh, i);
+            if (i > 0) buf_puts(d, b, " ");
+            serialize_value(d, b, item, depth);
+            qpdf_oh_release(d->qpdf, item);
+        }
+        buf_puts(d, b, "]");
+    } else if (qpdf_oh_is_dictionary(d->qpdf, oh)) {
+        keys = dict_keys(d, oh, &n);
+        buf_puts(d, b, "<<");
+        for (i = 0; i < n && !d->error; i++) {
+            if (skip_key && strcmp(keys[i], skip_key) == 0) continue;
+            item = qpdf_oh_get_key(d->qpdf, oh, keys[i]);
+            buf_puts(d, b, " ");
+            buf_puts(d, b, keys[i]);
+            buf_puts(d, b, " ");
+            serialize_value(d, b, item, depth);
+            qpdf_oh_release(d->qpdf, item);
+        }
+        buf_puts(d, b, " >>");
+        free_keys(keys, n);
+    } else {
+        buf_puts(d, b, qpdf_oh_unparse_resolved(d->qpdf, oh));
+    }
+}
+
+/*
+ * A stream reference becomes its first copy. Other indirect objects are
+ * inlined, because each input brings its own copy of e.g. an ICC color
+ * space array and only the contents can match.
+ */
+static void serialize_value(dedup_t* d, text_buf_t* b, qpdf_oh oh, int depth)
+{
+    seen_entry_t* e;
+    char ref[32];
+    int objid, generation;
+
+    /* Cycles through inlined objects can fan out; give up on the serialization */
+    if (d->budget <= 0) return;
+    d->budget--;
+
+    if (!qpdf_oh_is_indirect(d->qpdf, oh)) {
+        serialize_direct(d, b, oh, NULL, depth);
+        return;
+    }
+
+    objid = qpdf_oh_get_object_id(d->qpdf, oh);
+    generation = qpdf_oh_get_generation(d->qpdf, oh);
+    if (objid == d->self_id && generation == d->self_generation) {
+        /* e.g. /P of the page's own annotations */
+        buf_puts(d, b, "self");
+        return;
+    }
+    if (qpdf_oh_is_stream(d->qpdf, oh)) {
+        e = seen_find(d, objid, generation);
+        if (e) {
+            objid = e->canon_id;
+            generation = e->canon_generation;
+        }
+    } else if (depth < DEDUP_INLINE_DEPTH && !is_structural(d, oh)) {
+        buf_puts(d, b, "{");
+        serialize_direct(d, b, oh, NULL, depth + 1);
+        buf_puts(d, b, "}");
+        return;
+    }
+    sprintf(ref, "%d %d R", objid, generation);
+    buf_puts(d, b, ref);
+}
+
+/* ==================== Walk ==================== */
+
+static void walk(dedup_t* d, qpdf_oh oh, int depth);
+
+/* Raw data of the first copy equals data (len bytes) */
+static int same_data(dedup_t* d, const stream_entry_t* first, const unsigned char* data, size_t len)
+{
+    qpdf_oh oh = qpdf_get_object_by_id(d->qpdf, first->objid, first->generation);
+    unsigned char* other = NULL;
+    size_t other_len = 0;
+    QPDF_BOOL filtered = QPDF_FALSE;
+    int same = 0;
+
+    if (qpdf_oh_get_stream_data(d->qpdf, oh, qpdf_dl_none, &filtered, &other, &other_len) < QPDF_ERRORS) {
+        same = other_len == len && (len == 0 || memcmp(other, data, len) == 0);
+    } else {
+        clear_error(d);
+    }
+    free(other);
+    qpdf_oh_release(d->qpdf, oh);
+    return same;
+}
+
+/* Earlier stream with the same dictionary and raw data, NULL if none */
+static stream_entry_t* streams_find(dedup_t* d, const stream_entry_t* entry, const unsigned char* data)
+{
+    stream_entry_t* s;
+    size_t i;
+
+    if (d->streams_cap == 0) return NULL;
+    for (i = slot_of(entry->hash, d->streams_cap); d->streams[i].objid; i = (i + 1) & (d->streams_cap - 1)) {
+        s = &d->streams[i];
+        if (s->hash == entry->hash && s->dict_len == entry->dict_len && s->data_len == entry->data_len &&
+            memcmp(s->dict_text, entry->dict_text, entry->dict_len) == 0 &&
+            same_data(d, s, data, entry->data_len)) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static void resolve_stream(dedup_t* d, qpdf_oh stream, int objid, int generation, int depth)
+{
+    stream_entry_t entry;
+    stream_entry_t* first;
+    seen_entry_t* e;
+    text_buf_t text;
+    unsigned char* data = NULL;
+    size_t len = 0;
+    QPDF_BOOL filtered = QPDF_FALSE;
+    qpdf_oh dict;
+
+    if (!seen_add(d, objid, generation)) return;
+    if (pdf_cancel_requested(d->cancel)) {
+        d->error = PDF_ERR_CANCELLED;
+        return;
+    }
+
+    /* Streams it references first, so the serialization names their first copies */
+    memset(&text, 0, sizeof(text));
+    dict = qpdf_oh_get_dict(d->qpdf, stream);
+    walk(d, dict, depth + 1);
+    d->budget = DEDUP_SERIALIZE_BUDGET;
+    serialize_direct(d, &text, dict, "/Length", 0);
+    qpdf_oh_release(d->qpdf, dict);
+    if (d->error || d->budget <= 0) {
+        free(text.data);
+        return;
+    }
+
+    if (qpdf_oh_get_stream_data(d->qpdf, stream, qpdf_dl_none, &filtered, &data, &len) >= QPDF_ERRORS) {
+        /* Unreadable: left as it is */
+        clear_error(d);
+        free(text.data);
+        return;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    entry.hash = hash_bytes(hash_bytes(14695981039346656037ULL, text.data, text.len), data, len);
+    entry.dict_text = text.data;
+    entry.dict_len = text.len;
+    entry.data_len = len;
+    entry.objid = objid;
+    entry.generation = generation;
+
+    first = streams_find(d, &entry, data);
+    if (first) {
+        e = seen_find(d, objid, generation);
+        e->canon_id = first->objid;
+        e->canon_generation = first->generation;
+        if (d->rewrite) {
+            d->result->streams++;
+            d->result->bytes_saved += len;
+        }
+        free(text.data);
+    } else if (!streams_add(d, &entry)) {
+        free(text.data);
+    }
+    free(data);
+}
+
+/*
+ * Visit a value held by a dictionary or array.
+ * @return first copy to store in its place (the value is a duplicate
+ *         stream and d->rewrite is set), 0 to keep the value
+ */
+static qpdf_oh visit(dedup_t* d, qpdf_oh value, int depth)
+{
+    seen_entry_t* e;
+    int objid, generation;
+
+    if (d->error || depth >= DEDUP_MAX_DEPTH) return 0;
+
+    if (!qpdf_oh_is_indirect(d->qpdf, value)) {
+        if (qpdf_oh_is_array(d->qpdf, value) || qpdf_oh_is_dictionary(d->qpdf, value)) {
+            walk(d, value, depth + 1);
+        }
+        return 0;
+    }
+
+    objid = qpdf_oh_get_object_id(d->qpdf, value);
+    generation = qpdf_oh_get_generation(d->qpdf, value);
+    if (!seen_find(d, objid, generation)) {
+        if (qpdf_oh_is_stream(d->qpdf, value)) {
+            resolve_stream(d, value, objid, generation, depth);
+        } else if (!is_structural(d, value) && seen_add(d, objid, generation)) {
+            walk(d, value, depth + 1);
+        }
+    }
+
+    e = seen_find(d, objid, generation);
+    if (!d->rewrite || !e || (e->canon_id == objid && e->canon_generation == generation)) return 0;
+    return qpdf_get_object_by_id(d->qpdf, e->canon_id, e->canon_generation);
+}
+
+/* Visit the values of a dictionary or array, replacing duplicate streams */
+static void walk(dedup_t* d, qpdf_oh oh, int depth)
+{
+    char** keys;
+    qpdf_oh item, first;
+    int i, n;
+
+    if (qpdf_oh_is_array(d->qpdf, oh)) {
+        n = qpdf_oh_get_array_n_items(d->qpdf, oh);
+        for (i = 0; i < n && !d->error; i++) {
+            item = qpdf_oh_get_array_item(d->qpdf, oh, i);
+            first = visit(d, item, depth);
+            if (first) {
+                qpdf_oh_set_array_item(d->qpdf, oh, i, first);
+                qpdf_oh_release(d->qpdf, first);
+            }
+            qpdf_oh_release(d->qpdf, item);
+        }
+    } else if (qpdf_oh_is_dictionary(d->qpdf, oh)) {
+        keys = dict_keys(d, oh, &n);
+        for (i = 0; i < n && !d->error; i++) {
+            item = qpdf_oh_get_key(d->qpdf, oh, keys[i]);
+            first = visit(d, item, depth);
+            if (first) {
+                qpdf_oh_replace_key(d->qpdf, oh, keys[i], first);
+                qpdf_oh_release(d->qpdf, first);
+            }
+            qpdf_oh_release(d->qpdf, item);
+        }
+        free_keys(keys, n);
+    }
+}
+
+static void dedup_init(dedup_t* d, qpdf_data qpdf, const pdf_cancel_t* cancel, pdf_dedup_result_t* result)
+{
+    memset(result, 0, sizeof(*result));
+    memset(d, 0, sizeof(*d));
+    d->qpdf = qpdf;
+    d->cancel = cancel;
+    d->result = result;
+    d->error = PDF_OK;
+}
+
+static void dedup_free(dedup_t* d)
+{
+    size_t i;
+
+    for (i = 0; i < d->streams_cap; i++) {
+        if (d->streams[i].objid) free(d->streams[i].dict_text);
+    }
+    free(d->streams);
+    free(d->seen);
+}
+
+pdf_error_t pdf_dedup_streams(qpdf_data qpdf, const pdf_cancel_t* cancel, pdf_dedup_result_t* result)
+{
+    dedup_t d;
+    qpdf_oh page;
+    int page_count, p;
+
+    dedup_init(&d, qpdf, cancel, result);
+    d.rewrite = 1;
+
+    page_count = qpdf_get_num_pages(qpdf);
+    for (p = 0; p < page_count && !d.error; p++) {
+        page = qpdf_get_page_n(qpdf, (size_t)p);
+        walk(&d, page, 0);
+        qpdf_oh_release(qpdf, page);
+    }
+
+    dedup_free(&d);
+    return d.error;
+}
+
+/* ==================== Pages ==================== */
+
+/*
+ * Page index -> serialization, /Parent left out. Returns 0 if the page
+ * cannot be compared (too large to serialize, or out of memory).
+ */
+static int serialize_page(dedup_t* d, int index, text_buf_t* text)
+{
+    qpdf_oh page = qpdf_get_page_n(d->qpdf, (size_t)index);
+
+    text->len = 0;
+    d->self_id = qpdf_oh_get_object_id(d->qpdf, page);
+    d->self_generation = qpdf_oh_get_generation(d->qpdf, page);
+    d->budget = DEDUP_SERIALIZE_BUDGET;
+    serialize_direct(d, text, page, "/Parent", 0);
+    d->self_id = 0;
+    d->self_generation = 0;
+    qpdf_oh_release(d->qpdf, page);
+    return !d->error && d->budget > 0;
+}
+
+pdf_error_t pdf_dedup_pages(qpdf_data qpdf, int collapse, const pdf_cancel_t* cancel,
+                            int* first_of, pdf_dedup_result_t* result)
+{
+    dedup_t d;
+    page_entry_t* pages = NULL;
+    text_buf_t text, other;
+    unsigned long long hash;
+    size_t cap = 16, i;
+    qpdf_oh page;
+    int page_count, p;
+
+    dedup_init(&d, qpdf, cancel, result);
+    d.rewrite = collapse;
+    memset(&text, 0, sizeof(text));
+    memset(&other, 0, sizeof(other));
+
+    page_count = qpdf_get_num_pages(qpdf);
+    while (cap < (size_t)(page_count > 0 ? page_count : 0) * 2) cap *= 2;
+    pages = (page_entry_t*)calloc(cap, sizeof(page_entry_t));
+    if (!pages) d.error = PDF_ERR_MEMORY;
+
+    for (p = 0; p < page_count && !d.error; p++) {
+        first_of[p] = -1;
+        if (pdf_cancel_requested(cancel)) {
+            d.error = PDF_ERR_CANCELLED;
+            break;
+        }
+
+        /* Resolve the streams below the page, then compare its serialization */
+        page = qpdf_get_page_n(qpdf, (size_t)p);
+        walk(&d, page, 0);
+        qpdf_oh_release(qpdf, page);
+        if (d.error || !serialize_page(&d, p, &text)) continue;
+
+        hash = hash_bytes(14695981039346656037ULL, text.data, text.len);
+        for (i = slot_of(hash, cap); pages[i].index; i = (i + 1) & (cap - 1)) {
+            if (pages[i].hash == hash && serialize_page(&d, pages[i].index - 1, &other) &&
+                other.len == text.len && memcmp(other.data, text.data, text.len) == 0) {
+                first_of[p] = pages[i].index - 1;
+                break;
+            }
+        }
+        if (first_of[p] < 0) {
+            pages[i].hash = hash;
+            pages[i].index = p + 1;
+        }
+    }
+    for (; p < page_count; p++) first_of[p] = -1;
+
+    free(text.data);
+    free(other.data);
+    free(pages);
+    dedup_free(&d);
+    return d.error;
+}
@@ -0,0 +1,54 @@
+/*
+ * pdf_dedup.h
+ * Stream and page deduplication (internal)
+ *
+ * Merged inputs that come from one template each carry their own copy of
+ * the same fonts, logos and ICC profiles. This pass finds streams whose
+ * dictionary and raw (still encoded) data are identical and points every
+ * reference at the first copy. The other copies are left unreferenced,
+ * so QPDF does not write them. The same comparison finds duplicate pages.
+ */
+
+#ifndef PDF_DEDUP_H
+#define PDF_DEDUP_H
+
+#include <qpdf/qpdf-c.h>
+#include "pdf_tools.h"
+
+typedef struct pdf_dedup_result {
+    long long streams;              /* 첫 사본으로 합친 중복 스트림 수 */
+    unsigned long long bytes_saved; /* 합친 중복 스트림의 원본(인코딩된) 데이터 크기 합 */
+} pdf_dedup_result_t;
+
+/*
+ * Collapse identical streams reachable from the pages of a document.
+ *
+ * A stream's dictionary is compared after the streams it references have
+ * been collapsed, so an image with its /SMask or ICC color space matches
+ * as a unit. Candidates are found by hash and confirmed byte for byte.
+ * Streams whose data cannot be read are left alone.
+ *
+ * @param qpdf document to change in place (before qpdf_init_write)
+ * @param cancel checked between streams (NULL = never)
+ * @param result counts, filled also on failure
+ * @return PDF_OK, PDF_ERR_MEMORY or PDF_ERR_CANCELLED
+ */
+pdf_error_t pdf_dedup_streams(qpdf_data qpdf, const pdf_cancel_t* cancel, pdf_dedup_result_t* result);
+
+/*
+ * Find pages that equal an earlier page of the document: same attributes
+ * (/Parent aside), resources, annotations and content streams, compared
+ * by value, so the same scan imported twice or a file added twice
+ * matches its first occurrence. References a page makes to itself (/P of
+ * its annotations) compare equal; references to other pages do not.
+ *
+ * @param collapse 1 = also collapse identical streams (pdf_dedup_streams)
+ * @param first_of set for each page (qpdf_get_num_pages() entries) to the
+ *                 index of the first identical page, -1 if none
+ * @param result stream counts (0 unless collapse is set)
+ * @return PDF_OK, PDF_ERR_MEMORY or PDF_ERR_CANCELLED
+ */
+pdf_error_t pdf_dedup_pages(qpdf_data qpdf, int collapse, const pdf_cancel_t* cancel,
+                            int* first_of, pdf_dedup_result_t* result);
+
+#endif /* PDF_DEDUP_H */
@@ -0,0 +1,385 @@
+/*
+ * pdf_index.c - Persistent metadata index
+ *
+ * File layout (little-endian):
+ *   "JPTIDX1\n"
+ *   record*: u32 path_bytes, u64 size, u64 mtime, i32 page_count,
+ *            i32 object_count, u8 encrypted, char version[8],
+ *            path (UTF-8, path_bytes bytes)
+ */
+
+#include "pdf_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#define INDEX_MAGIC "JPTIDX1\n"
+#define INDEX_MAGIC_LEN 8
+#define INDEX_RECORD_FIXED 37       /* record bytes before the path */
+#define INDEX_MAX_PATH_BYTES (MAX_PATH * 3)
+
+typedef struct index_entry {
+    WCHAR* path;                    /* NULL = empty slot */
+    unsigned long long size;
+    unsigned long long mtime;
+    pdf_file_info_t info;
+} index_entry_t;
+
+static SRWLOCK g_index_lock = SRWLOCK_INIT;
+static int g_index_loaded;
+static int g_index_disabled;
+static WCHAR g_index_file[MAX_PATH];        /* empty = default location */
+static FILE* g_index_out;                   /* append handle */
+static index_entry_t* g_entries;
+static size_t g_entry_cap;
+static size_t g_entry_count;
+
+/* ==================== Hash table ==================== */
+
+static unsigned int path_hash(const WCHAR* path)
+{
+    unsigned int h = 2166136261u;
+    for (; *path; path++) {
+        h ^= (unsigned int)towlower(*path);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static index_entry_t* find_slot(index_entry_t* entries, size_t cap, const WCHAR* path)
+{
+    size_t i = path_hash(path) & (cap - 1);
+    while (entries[i].path && pdf_path_cmp(entries[i].path, path) != 0) {
+        i = (i + 1) & (cap - 1);
+    }
+    return &entries[i];
+}
+
+static int grow_table(void)
+{
+    size_t new_cap = g_entry_cap ? g_entry_cap * 2 : 256;
+    index_entry_t* grown = (index_entry_t*)calloc(new_cap, sizeof(index_entry_t));
+    size_t i;
+
+    if (!grown) return 0;
+    for (i = 0; i < g_entry_cap; i++) {
+        if (g_entries[i].path) *find_slot(grown, new_cap, g_entries[i].path) = g_entries[i];
+    }
+    free(g_entries);
+    g_entries = grown;
+    g_entry_cap = new_cap;
+    return 1;
+}
+
+/* Insert or replace; takes ownership of path */
+static int put_entry(WCHAR* path, unsigned long long size, unsigned long long mtime,
+                     const pdf_file_info_t* info)
+{
+    index_entry_t* slot;
+
+    if ((g_entry_count + 1) * 4 > g_entry_cap * 3 && !grow_table()) {
+        free(path);
+        return 0;
+    }
+    slot = find_slot(g_entries, g_entry_cap, path);
+    if (slot->path) {
+        free(slot->path);
+    } else {
+        g_entry_count++;
+    }
+    slot->path = path;
+    slot->size = size;
+    slot->mtime = mtime;
+    slot->info = *info;
+    return 1;
+}
+
+static void free_table(void)
+{
+    size_t i;
+    for (i = 0; i < g_entry_cap; i++) free(g_entries[i].path);
+    free(g_entries);
+    g_entries = NULL;
+    g_entry_cap = 0;
+    g_entry_count = 0;
+}
+
+/* ==================== File ==================== */
+
+static int index_file_path(WCHAR* out)
+{
+    WCHAR dir[MAX_PATH];
+    DWORD len;
+
+    if (g_index_file[0]) {
+        wcscpy_s(out, MAX_PATH, g_index_file);
+        return 1;
+    }
+
+#ifdef _WIN32
+    len = GetEnvironmentVariableW(L"LOCALAPPDATA", dir, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH - 32) return 0;
+    wcscat_s(dir, MAX_PATH, L"\\JunPdfTools");
+    CreateDirectoryW(dir, NULL);
+    swprintf_s(out, MAX_PATH, L"%ls\\pdf_index.dat", dir);
+#else
+    {
+        const char* base = getenv("XDG_CACHE_HOME");
+        int in_home = 0;
+
+        if (!base || !base[0]) {
+            base = getenv("HOME");
+            in_home = 1;
+        }
+        if (!base || !base[0]) return 0;
+        len = (DWORD)MultiByteToWideChar(CP_UTF8, 0, base, -1, dir, MAX_PATH - 48);
+        if (len == 0) return 0;
+        if (in_home) {
+            wcscat_s(dir, MAX_PATH, L"/.cache");
+            CreateDirectoryW(dir, NULL);
+        }
+    }
+    wcscat_s(dir, MAX_PATH, L"/jun-pdf-tools");
+    CreateDirectoryW(dir, NULL);
+    swprintf_s(out, MAX_PATH, L"%ls/pdf_index.dat", dir);
+#endif
+    return 1;
+}
+
+static void put_u32(unsigned char* p, unsigned int v)
+{
+    p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16); p[3] = (unsigned char)(v >> 24);
+}
+
+static void put_u64(unsigned char* p, unsigned long long v)
+{
+    put_u32(p, (unsigned int)v);
+    put_u32(p + 4, (unsigned int)(v >> 32));
+}
+
+static unsigned int get_u32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+           ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned long long get_u64(const unsigned char* p)
+{
+    return (unsigned long long)get_u32(p) | ((unsigned long long)get_u32(p + 4) << 32);
+}
+
+/* @return record length written to buf, 0 if the path is too long */
+static size_t encode_record(unsigned char* buf, const WCHAR* path, unsigned long long size,
+                            unsigned long long mtime, const pdf_file_info_t* info)
+{
+    int path_bytes = WideCharToMultiByte(CP_UTF8, 0, path, -1, (char*)buf + INDEX_RECORD_FIXED,
+                                         INDEX_MAX_PATH_BYTES, NULL, NULL);
+    if (path_bytes <= 1) return 0;
+    path_bytes--;   /* without the terminator */
+
+    put_u32(buf, (unsigned int)path_bytes);
+    put_u64(buf + 4, size);
+    put_u64(buf + 12, mtime);
+    put_u32(buf + 20, (unsigned int)info->page_count);
+    put_u32(buf + 24, (unsigned int)info->object_count);
+    buf[28] = (unsigned char)(info->encrypted ? 1 : 0);
+    memcpy(buf + 29, info->version, 8);
+    return INDEX_RECORD_FIXED + (size_t)path_bytes;
+}
+
+/*
+ * Read every complete record into the table.
+ * @return number of records read, -1 if the file is not an index
+ */
+static long long load_records(FILE* f, int* truncated)
+{
+    unsigned char fixed[INDEX_RECORD_FIXED];
+    char path_a[INDEX_MAX_PATH_BYTES + 1];
+    WCHAR path_w[MAX_PATH];
+    WCHAR* path;
+    pdf_file_info_t info;
+    unsigned int path_bytes;
+    long long records = 0;
+
+    *truncated = 0;
+    if (fread(path_a, 1, INDEX_MAGIC_LEN, f) != INDEX_MAGIC_LEN ||
+        memcmp(path_a, INDEX_MAGIC, INDEX_MAGIC_LEN) != 0) {
+        return -1;
+    }
+
+    for (;;) {
+        size_t got = fread(fixed, 1, INDEX_RECORD_FIXED, f);
+        if (got == 0) break;
+        path_bytes = get_u32(fixed);
+        if (got != INDEX_RECORD_FIXED || path_bytes == 0 || path_bytes > INDEX_MAX_PATH_BYTES ||
+            fread(path_a, 1, path_bytes, f) != path_bytes) {
+            *truncated = 1;
+            break;
+        }
+        path_a[path_bytes] = '\0';
+        if (MultiByteToWideChar(CP_UTF8, 0, path_a, -1, path_w, MAX_PATH) == 0) continue;
+
+        memset(&info, 0, sizeof(info));
+        info.page_count = (int)get_u32(fixed + 20);
+        info.object_count = (int)get_u32(fixed + 24);
+        info.encrypted = fixed[28];
+        memcpy(info.version, fixed + 29, 8);
+        info.version[7] = '\0';
+
+        path = _wcsdup(path_w);
+        if (!path || !put_entry(path, get_u64(fixed + 4), get_u64(fixed + 12), &info)) break;
+        records++;
+    }
+    return records;
+}
+
+/* Rewrite the file with one record per path (temp file + rename) */
+static void compact(const WCHAR* file)
+{
+    WCHAR temp[MAX_PATH];
+    unsigned char buf[INDEX_RECORD_FIXED + INDEX_MAX_PATH_BYTES + 1];
+    FILE* f;
+    size_t i, len;
+    int ok;
+
+    if (swprintf_s(temp, MAX_PATH, L"%ls.tmp", file) < 0) return;
+    f = _wfopen(temp, L"wb");
+    if (!f) return;
+
+    ok = fwrite(INDEX_MAGIC, 1, INDEX_MAGIC_LEN, f) == INDEX_MAGIC_LEN;
+    for (i = 0; ok && i < g_entry_cap; i++) {
+        if (!g_entries[i].path) continue;
+        len = encode_record(buf, g_entries[i].path, g_entries[i].size, g_entries[i].mtime,
+                            &g_entries[i].info);
+        if (len && fwrite(buf, 1, len, f) != len) ok = 0;
+    }
+    if (fclose(f) != 0) ok = 0;
+
+    if (!ok || !MoveFileExW(temp, file, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(temp);
+    }
+}
+
+/* Load once; called with g_index_lock held exclusively */
+static void ensure_loaded(void)
+{
+    WCHAR file[MAX_PATH];
+    FILE* f;
+    long long records;
+    int truncated = 0;
+
+    if (g_index_loaded || g_index_disabled) return;
+    g_index_loaded = 1;
+
+    if (!index_file_path(file)) return;
+
+    f = _wfopen(file, L"rb");
+    if (f) {
+        setvbuf(f, NULL, _IOFBF, 1 << 16);
+        records = load_records(f, &truncated);
+        fclose(f);
+        /* Not an index, a torn tail or mostly superseded records: rewrite */
+        if (records < 0 || truncated ||
+            (unsigned long long)records > 2 * (unsigned long long)g_entry_count + 64) {
+            compact(file);
+        }
+    }
+
+    g_index_out = _wfopen(file, L"ab");
+    if (g_index_out && _ftelli64(g_index_out) == 0) {
+        fwrite(INDEX_MAGIC, 1, INDEX_MAGIC_LEN, g_index_out);
+        fflush(g_index_out);
+    }
+}
+
+/* ==================== API ==================== */
+
+/*
+ * Entries are keyed on the absolute path: the CLI gets relative paths, and
+ * "a.pdf" run from two folders must not share one entry (or one file get
+ * two). NULL if the path cannot be resolved; such files are not indexed.
+ */
+static const WCHAR* index_key(const WCHAR* path, WCHAR* buf)
+{
+    DWORD n = GetFullPathNameW(path, MAX_PATH, buf, NULL);
+    return n > 0 && n < MAX_PATH ? buf : NULL;
+}
+
+int pdf_index_lookup(const WCHAR* path, unsigned long long size, unsigned long long mtime,
+                     pdf_file_info_t* info)
+{
+    WCHAR key_buf[MAX_PATH];
+    const WCHAR* key = index_key(path, key_buf);
+    index_entry_t* slot;
+    int found = 0;
+
+    if (!key) return 0;
+    AcquireSRWLockExclusive(&g_index_lock);
+    ensure_loaded();
+    if (g_entry_cap) {
+        slot = find_slot(g_entries, g_entry_cap, key);
+        if (slot->path && slot->size == size && slot->mtime == mtime) {
+            *info = slot->info;
+            found = 1;
+        }
+    }
+    ReleaseSRWLockExclusive(&g_index_lock);
+    return found;
+}
+
+void pdf_index_store(const WCHAR* path, unsigned long long size, unsigned long long mtime,
+                     const pdf_file_info_t* info)
+{
+    unsigned char buf[INDEX_RECORD_FIXED + INDEX_MAX_PATH_BYTES + 1];
+    WCHAR key_buf[MAX_PATH];
+    const WCHAR* key = index_key(path, key_buf);
+    WCHAR* copy;
+    size_t len;
+
+    if (!key) return;
+    AcquireSRWLockExclusive(&g_index_lock);
+    ensure_loaded();
+    if (!g_index_disabled) {
+        copy = _wcsdup(key);
+        if (copy && put_entry(copy, size, mtime, info) && g_index_out) {
+            /* One fwrite per record so concurrent appenders do not interleave */
+            len = encode_record(buf, key, size, mtime, info);
+            if (len) {
+                fwrite(buf, 1, len, g_index_out);
+                fflush(g_index_out);
+            }
+        }
+    }
+    ReleaseSRWLockExclusive(&g_index_lock);
+}
+
+void pdf_index_close(void)
+{
+    AcquireSRWLockExclusive(&g_index_lock);
+    if (g_index_out) fclose(g_index_out);
+    g_index_out = NULL;
+    free_table();
+    g_index_loaded = 0;
+    ReleaseSRWLockExclusive(&g_index_lock);
+}
+
+int pdf_index_set_file(const WCHAR* index_path)
+{
+    /* Rejected paths disable the index instead of falling back to the default file */
+    int accepted = !index_path || (index_path[0] && wcslen(index_path) < MAX_PATH);
+
+    pdf_index_close();
+
+    AcquireSRWLockExclusive(&g_index_lock);
+    g_index_disabled = !index_path || !accepted;
+    if (g_index_disabled) {
+        g_index_file[0] = L'\0';
+    } else {
+        wcscpy(g_index_file, index_path);
+    }
+    ReleaseSRWLockExclusive(&g_index_lock);
+    return accepted;
+}
@@ -0,0 +1,31 @@
+/*
+ * pdf_index.h
+ * Persistent metadata index (internal)
+ *
+ * Maps (absolute path, size, mtime) to pdf_file_info_t. The file is append-only:
+ * every new result is one record at the end, a later record for the same
+ * path replaces an earlier one, and a record cut short by a crash is
+ * ignored. The file is compacted when it is loaded with many superseded
+ * records.
+ */
+
+#ifndef PDF_INDEX_H
+#define PDF_INDEX_H
+
+#include "pdf_tools.h"
+#include "pdf_compat.h"
+
+/*
+ * Look up a file. The index is loaded on first use.
+ * @return 1 and fills info if the key matches, 0 otherwise
+ */
+int pdf_index_lookup(const WCHAR* path, unsigned long long size, unsigned long long mtime,
+                     pdf_file_info_t* info);
+
+/*
+ * Record a result (in memory and appended to the file).
+ */
+void pdf_index_store(const WCHAR* path, unsigned long long size, unsigned long long mtime,
+                     const pdf_file_info_t* info);
+
+#endif /* PDF_INDEX_H */
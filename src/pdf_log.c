@@ -0,0 +1,184 @@
+/*
+ * pdf_log.c - Asynchronous debug log
+ *
+ * Producers claim a slot of a bounded ring by advancing g_tail with a
+ * compare-exchange, format straight into it and publish it through the
+ * slot's sequence number (bounded MPMC queue, Vyukov). A single writer
+ * thread takes slots in order, writes them out and hands them back for
+ * the next lap. The ring is static and never freed, so a message that
+ * races with pdf_log_close only lands in the ring.
+ */
+
+#include "pdf_log.h"
+#include "pdf_compat.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#define LOG_SLOTS 1024              /* power of two */
+#define LOG_TEXT_MAX 232
+#define LOG_IDLE_MS 20              /* writer poll interval while the ring is empty */
+
+/* Sequence arithmetic wraps; do it unsigned */
+#define SEQ_ADD(a, n) ((LONG)((unsigned long)(a) + (unsigned long)(n)))
+#define SEQ_DIFF(a, b) ((long)((unsigned long)(a) - (unsigned long)(b)))
+
+typedef struct log_slot {
+    volatile LONG seq;              /* == 위치: 비어 있음, == 위치 + 1: 기록 완료 */
+    int level;
+    DWORD thread_id;
+    ULONGLONG tick;
+    char text[LOG_TEXT_MAX];
+} log_slot_t;
+
+volatile long g_pdf_log_level = PDF_LOG_OFF;
+
+static log_slot_t g_ring[LOG_SLOTS];
+static int g_ring_ready = 0;
+static volatile LONG g_tail = 0;    /* 다음에 쓸 위치 (producer) */
+static LONG g_head = 0;             /* 다음에 읽을 위치 (writer만) */
+static volatile LONG g_dropped = 0;
+
+static FILE* g_sink = NULL;
+static HANDLE g_writer = NULL;
+static volatile LONG g_stop = 0;
+static ULONGLONG g_open_tick = 0;
+static LONG g_dropped_reported = 0;
+
+static LONG load_acquire(volatile LONG* p)
+{
+    return InterlockedCompareExchange(p, 0, 0);
+}
+
+/* Seconds since pdf_log_open (0 for messages left over from an earlier log) */
+static double since_open(ULONGLONG tick)
+{
+    return tick > g_open_tick ? (double)(tick - g_open_tick) / 1000.0 : 0.0;
+}
+
+void pdf_log_write(pdf_log_level_t level, const char* fmt, ...)
+{
+    log_slot_t* slot;
+    LONG pos = g_tail;
+    long diff;
+    va_list ap;
+
+    for (;;) {
+        slot = &g_ring[(unsigned long)pos & (LOG_SLOTS - 1)];
+        diff = SEQ_DIFF(load_acquire(&slot->seq), pos);
+        if (diff == 0) {
+            if (InterlockedCompareExchange(&g_tail, SEQ_ADD(pos, 1), pos) == pos) break;
+        } else if (diff < 0) {
+            /* The writer has not freed this slot yet: ring full */
+            InterlockedIncrement(&g_dropped);
+            return;
+        }
+        pos = g_tail;
+    }
+
+    slot->level = (int)level;
+    slot->thread_id = GetCurrentThreadId();
+    slot->tick = GetTickCount64();
+    va_start(ap, fmt);
+    vsnprintf(slot->text, LOG_TEXT_MAX, fmt, ap);
+    va_end(ap);
+    InterlockedExchange(&slot->seq, SEQ_ADD(pos, 1));
+}
+
+/* Write out published slots in order. Writer thread, or the closing thread after it stopped. */
+static int drain(void)
+{
+    static const char level_chars[] = "?EWID";
+    log_slot_t* slot;
+    LONG dropped;
+    int n = 0;
+
+    for (;;) {
+        slot = &g_ring[(unsigned long)g_head & (LOG_SLOTS - 1)];
+        if (load_acquire(&slot->seq) != SEQ_ADD(g_head, 1)) break;
+        fprintf(g_sink, "[%9.3f] %5lu %c %s\n", since_open(slot->tick), (unsigned long)slot->thread_id,
+                level_chars[slot->level >= 1 && slot->level <= 4 ? slot->level : 0], slot->text);
+        InterlockedExchange(&slot->seq, SEQ_ADD(g_head, LOG_SLOTS));
+        g_head = SEQ_ADD(g_head, 1);
+        n++;
+    }
+
+    dropped = load_acquire(&g_dropped);
+    if (dropped != g_dropped_reported) {
+        fprintf(g_sink, "[%9.3f] log ring full, %ld messages dropped\n",
+                since_open(GetTickCount64()), (long)(dropped - g_dropped_reported));
+        g_dropped_reported = dropped;
+        n++;
+    }
+    return n;
+}
+
+static DWORD WINAPI writer_thread(LPVOID param)
+{
+    (void)param;
+    while (!load_acquire(&g_stop)) {
+        if (drain() > 0) {
+            fflush(g_sink);
+        } else {
+            Sleep(LOG_IDLE_MS);
+        }
+    }
+    return 0;
+}
+
+int pdf_log_open(const wchar_t* path, pdf_log_level_t level)
+{
+    int i;
+
+    pdf_log_close();
+
+    if (!g_ring_ready) {
+        for (i = 0; i < LOG_SLOTS; i++) g_ring[i].seq = i;
+        g_ring_ready = 1;
+    }
+
+    g_sink = path ? _wfopen(path, L"a") : stderr;
+    if (!g_sink) return 0;
+
+    g_open_tick = GetTickCount64();
+    InterlockedExchange(&g_dropped, 0);
+    g_dropped_reported = 0;
+    InterlockedExchange(&g_stop, 0);
+    fprintf(g_sink, "---- log opened ----\n");
+    g_writer = CreateThread(NULL, 0, writer_thread, NULL, 0, NULL);
+    if (!g_writer) {
+        if (g_sink != stderr) fclose(g_sink);
+        g_sink = NULL;
+        return 0;
+    }
+    g_pdf_log_level = level;
+    return 1;
+}
+
+void pdf_log_set_level(pdf_log_level_t level)
+{
+    if (g_sink) g_pdf_log_level = level;
+}
+
+void pdf_log_close(void)
+{
+    if (!g_sink) return;
+
+    g_pdf_log_level = PDF_LOG_OFF;
+    InterlockedExchange(&g_stop, 1);
+    WaitForSingleObject(g_writer, INFINITE);
+    CloseHandle(g_writer);
+    g_writer = NULL;
+
+    drain();
+    if (g_sink == stderr) {
+        fflush(g_sink);
+    } else {
+        fclose(g_sink);
+    }
+    g_sink = NULL;
+}
+
+unsigned long long pdf_log_dropped(void)
+{
+    return (unsigned long long)load_acquire(&g_dropped);
+}
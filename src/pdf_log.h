@@ -0,0 +1,33 @@
+/*
+ * pdf_log.h
+ * Asynchronous debug log (internal)
+ *
+ * PDF_LOG(level, fmt, ...) formats with printf syntax. The level check is
+ * inline, so a disabled message costs one load and compare and its
+ * arguments are not evaluated.
+ */
+
+#ifndef PDF_LOG_H
+#define PDF_LOG_H
+
+#include "pdf_tools.h"
+
+/* Current level (pdf_log_level_t); PDF_LOG_OFF while no log is open */
+extern volatile long g_pdf_log_level;
+
+#define PDF_LOG(level, ...) \
+    do { if ((long)(level) <= g_pdf_log_level) pdf_log_write((level), __VA_ARGS__); } while (0)
+
+#define PDF_LOG_ENABLED(level) ((long)(level) <= g_pdf_log_level)
+
+/*
+ * Queue one message (use PDF_LOG). Never blocks; drops the message if the
+ * ring is full. Longer messages are truncated.
+ */
+void pdf_log_write(pdf_log_level_t level, const char* fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+#endif /* PDF_LOG_H */
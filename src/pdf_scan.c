@@ -0,0 +1,442 @@
+/*
+ * pdf_scan.c - Minimal read-only PDF structure scanner
+ *
+ * Every failure returns -1 ("cannot answer"); it is never an error for
+ * the caller, which then lets QPDF parse the file properly.
+ */
+
+#include "pdf_scan.h"
+#include <string.h>
+
+#define SCAN_MAX_SECTIONS 64        /* /Prev chain length limit (loops, damage) */
+#define SCAN_MAX_DEPTH 32           /* nesting limit while skipping values */
+
+typedef struct scan {
+    const char* data;
+    long long size;
+    long long sections[SCAN_MAX_SECTIONS];   /* xref sections, newest first */
+    int section_count;
+} scan_t;
+
+/* ==================== Tokens ==================== */
+
+static int is_ws(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\0';
+}
+
+static int is_delim(char c)
+{
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+static int is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* Skip whitespace and comments */
+static long long skip_ws(const scan_t* s, long long pos)
+{
+    while (pos < s->size) {
+        if (is_ws(s->data[pos])) {
+            pos++;
+        } else if (s->data[pos] == '%') {
+            while (pos < s->size && s->data[pos] != '\n' && s->data[pos] != '\r') pos++;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+static int parse_uint(const scan_t* s, long long* pos, long long* value)
+{
+    long long p = *pos, v = 0;
+    if (p >= s->size || !is_digit(s->data[p])) return 0;
+    while (p < s->size && is_digit(s->data[p])) {
+        if (v > 0x7FFFFFFFFFFFLL) return 0;
+        v = v * 10 + (s->data[p] - '0');
+        p++;
+    }
+    *pos = p;
+    *value = v;
+    return 1;
+}
+
+static int match(const scan_t* s, long long pos, const char* word)
+{
+    size_t len = strlen(word);
+    return pos >= 0 && pos + (long long)len <= s->size && memcmp(s->data + pos, word, len) == 0;
+}
+
+/* Skip one token or bracketed value; @return position after it, -1 on error */
+static long long skip_token(const scan_t* s, long long pos, int depth)
+{
+    int nesting;
+
+    if (depth > SCAN_MAX_DEPTH || pos >= s->size) return -1;
+
+    if (match(s, pos, "<<")) {
+        pos += 2;
+        for (;;) {
+            pos = skip_ws(s, pos);
+            if (pos >= s->size) return -1;
+            if (match(s, pos, ">>")) return pos + 2;
+            pos = skip_token(s, pos, depth + 1);
+            if (pos < 0) return -1;
+        }
+    }
+    if (s->data[pos] == '[') {
+        pos++;
+        for (;;) {
+            pos = skip_ws(s, pos);
+            if (pos >= s->size) return -1;
+            if (s->data[pos] == ']') return pos + 1;
+            pos = skip_token(s, pos, depth + 1);
+            if (pos < 0) return -1;
+        }
+    }
+    if (s->data[pos] == '<') {
+        while (pos < s->size && s->data[pos] != '>') pos++;
+        return pos < s->size ? pos + 1 : -1;
+    }
+    if (s->data[pos] == '(') {
+        nesting = 0;
+        for (; pos < s->size; pos++) {
+            if (s->data[pos] == '\\') {
+                pos++;
+            } else if (s->data[pos] == '(') {
+                nesting++;
+            } else if (s->data[pos] == ')' && --nesting == 0) {
+                return pos + 1;
+            }
+        }
+        return -1;
+    }
+    if (s->data[pos] == '/') pos++;
+    else if (is_delim(s->data[pos])) return -1;
+
+    /* Name, number or keyword: up to the next whitespace or delimiter */
+    while (pos < s->size && !is_ws(s->data[pos]) && !is_delim(s->data[pos])) pos++;
+    return pos;
+}
+
+/* Skip a value, treating "N G R" as one value */
+static long long skip_value(const scan_t* s, long long pos)
+{
+    long long end = skip_token(s, pos, 0), p, num;
+
+    if (end < 0 || !is_digit(s->data[pos])) return end;
+
+    p = skip_ws(s, end);
+    if (!parse_uint(s, &p, &num)) return end;
+    p = skip_ws(s, p);
+    if (p < s->size && s->data[p] == 'R' &&
+        (p + 1 >= s->size || is_ws(s->data[p + 1]) || is_delim(s->data[p + 1]))) {
+        return p + 1;
+    }
+    return end;
+}
+
+/*
+ * Find a key in the dictionary starting at pos ("<<").
+ * @return position of the value, -1 if missing or on error
+ */
+static long long dict_get(const scan_t* s, long long pos, const char* key)
+{
+    size_t key_len = strlen(key);
+    long long name_start, name_end;
+
+    pos = skip_ws(s, pos);
+    if (!match(s, pos, "<<")) return -1;
+    pos += 2;
+
+    for (;;) {
+        pos = skip_ws(s, pos);
+        if (pos >= s->size || match(s, pos, ">>")) return -1;
+        if (s->data[pos] != '/') return -1;
+
+        name_start = pos;
+        name_end = skip_token(s, pos, 0);
+        if (name_end < 0) return -1;
+        pos = skip_ws(s, name_end);
+
+        if (name_end - name_start == (long long)key_len &&
+            memcmp(s->data + name_start, key, key_len) == 0) {
+            return pos;
+        }
+
+        pos = skip_value(s, pos);
+        if (pos < 0) return -1;
+    }
+}
+
+static int read_ref(const scan_t* s, long long pos, long long* num, long long* gen)
+{
+    if (pos < 0 || !parse_uint(s, &pos, num)) return 0;
+    pos = skip_ws(s, pos);
+    if (!parse_uint(s, &pos, gen)) return 0;
+    pos = skip_ws(s, pos);
+    return pos < s->size && s->data[pos] == 'R';
+}
+
+/* ==================== Cross-reference tables ==================== */
+
+/*
+ * Walk one "xref" section. If objnum >= 0 and the section has an entry
+ * for it, *offset gets the object offset (-2 = free entry).
+ * @return position of the trailer dictionary, -1 if the section is damaged
+ */
+static long long walk_section(const scan_t* s, long long pos, long long objnum, long long* offset)
+{
+    long long start, count, entry, value, gen;
+    const char* e;
+
+    if (!match(s, pos, "xref")) return -1;
+    pos = skip_ws(s, pos + 4);
+
+    while (pos < s->size && is_digit(s->data[pos])) {
+        if (!parse_uint(s, &pos, &start)) return -1;
+        while (pos < s->size && (s->data[pos] == ' ' || s->data[pos] == '\t')) pos++;
+        if (!parse_uint(s, &pos, &count)) return -1;
+        pos = skip_ws(s, pos);
+
+        /* Entries are exactly 20 bytes: "oooooooooo ggggg n\r\n" */
+        if (count < 0 || count > (s->size - pos) / 20) return -1;
+
+        if (objnum >= start && objnum < start + count) {
+            entry = pos + (objnum - start) * 20;
+            e = s->data + entry;
+            if (e[10] != ' ' || e[16] != ' ' || (e[17] != 'n' && e[17] != 'f')) return -1;
+            value = entry;
+            if (!parse_uint(s, &value, offset) || value != entry + 10) return -1;
+            value = entry + 11;
+            if (!parse_uint(s, &value, &gen) || value != entry + 16) return -1;
+            if (e[17] == 'f') *offset = -2;
+        }
+
+        pos = skip_ws(s, pos + count * 20);
+    }
+
+    if (!match(s, pos, "trailer")) return -1;
+    return skip_ws(s, pos + 7);
+}
+
+/* @return offset of objnum from the newest section that lists it, -1 if none */
+static long long xref_lookup(const scan_t* s, long long objnum)
+{
+    long long offset;
+    int i;
+
+    for (i = 0; i < s->section_count; i++) {
+        offset = -1;
+        if (walk_section(s, s->sections[i], objnum, &offset) < 0) return -1;
+        if (offset == -2) return -1;
+        if (offset >= 0) return offset < s->size ? offset : -1;
+    }
+    return -1;
+}
+
+/* @return position of the object's value (after "N G obj"), -1 on error */
+static long long resolve(const scan_t* s, long long num, long long gen)
+{
+    long long pos = xref_lookup(s, num), n, g;
+
+    if (pos < 0) return -1;
+    pos = skip_ws(s, pos);
+    if (!parse_uint(s, &pos, &n) || n != num) return -1;
+    pos = skip_ws(s, pos);
+    if (!parse_uint(s, &pos, &g) || g != gen) return -1;
+    pos = skip_ws(s, pos);
+    if (!match(s, pos, "obj")) return -1;
+    return skip_ws(s, pos + 3);
+}
+
+/* ==================== Public ==================== */
+
+long long pdf_scan_startxref(const char* data, unsigned long long size, int* is_stream)
+{
+    unsigned long long tail = size > 4096 ? size - 4096 : 0;
+    unsigned long long i, pos;
+    long long offset = -1;
+
+    for (i = size; i-- > tail + 8;) {
+        if (data[i] == 's' && i + 9 <= size && memcmp(data + i, "startxref", 9) == 0) {
+            pos = i + 9;
+            while (pos < size && (data[pos] == ' ' || data[pos] == '\r' || data[pos] == '\n')) pos++;
+            if (pos >= size || data[pos] < '0' || data[pos] > '9') return -1;
+            offset = 0;
+            while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+                offset = offset * 10 + (data[pos] - '0');
+                pos++;
+            }
+            break;
+        }
+    }
+
+    if (offset < 0 || (unsigned long long)offset >= size) return -1;
+    *is_stream = !(size - (unsigned long long)offset >= 4 && memcmp(data + offset, "xref", 4) == 0);
+    return offset;
+}
+
+/* Offset of "%PDF-" in the first KB (readers allow leading junk), -1 if none */
+static long long find_header(const char* data, unsigned long long size)
+{
+    long long i;
+    for (i = 0; i + 5 <= 1024 && (unsigned long long)i + 5 <= size; i++) {
+        if (memcmp(data + i, "%PDF-", 5) == 0) return i;
+    }
+    return -1;
+}
+
+void pdf_scan_version(const char* data, unsigned long long size, char* version, int len)
+{
+    long long pos = find_header(data, size);
+    int n = 0;
+
+    if (len <= 0) return;
+    if (pos >= 0) {
+        pos += 5;
+        while ((unsigned long long)pos < size && n < len - 1 &&
+               (is_digit(data[pos]) || data[pos] == '.')) {
+            version[n++] = data[pos++];
+        }
+    }
+    version[n] = '\0';
+}
+
+int pdf_scan_page_count(const char* data, unsigned long long size, int* object_count)
+{
+    scan_t s;
+    long long section, trailer, value, root_pos, pages_pos, count_pos;
+    long long root_num = -1, root_gen = 0, num, gen, prev, count, objects = -1;
+    int is_stream = 0, i;
+
+    if (size < 32 || size > 0x3FFFFFFFFFFFFFFFULL) return -1;
+
+    memset(&s, 0, sizeof(s));
+    s.data = data;
+    s.size = (long long)size;
+
+    if (find_header(data, size) < 0) return -1;
+
+    section = pdf_scan_startxref(data, size, &is_stream);
+    if (section < 0 || is_stream) return -1;
+
+    /* Collect the /Prev chain; the newest trailer gives /Root */
+    while (section >= 0) {
+        if (s.section_count == SCAN_MAX_SECTIONS) return -1;
+        for (i = 0; i < s.section_count; i++) {
+            if (s.sections[i] == section) return -1;
+        }
+        s.sections[s.section_count++] = section;
+
+        trailer = walk_section(&s, section, -1, &value);
+        if (trailer < 0) return -1;
+
+        /* Encrypted objects cannot be read here; hybrid files keep some
+         * objects only in the /XRefStm stream */
+        if (dict_get(&s, trailer, "/Encrypt") >= 0) return -1;
+        if (dict_get(&s, trailer, "/XRefStm") >= 0) return -1;
+
+        if (root_num < 0 && !read_ref(&s, dict_get(&s, trailer, "/Root"), &root_num, &root_gen)) {
+            return -1;
+        }
+        if (objects < 0) {
+            value = dict_get(&s, trailer, "/Size");
+            if (!parse_uint(&s, &value, &objects) || objects < 1 || objects > 0x7FFFFFFF) return -1;
+        }
+
+        value = dict_get(&s, trailer, "/Prev");
+        if (value < 0) break;
+        if (!parse_uint(&s, &value, &prev) || prev >= s.size) return -1;
+        section = prev;
+    }
+
+    root_pos = resolve(&s, root_num, root_gen);
+    if (root_pos < 0 || !read_ref(&s, dict_get(&s, root_pos, "/Pages"), &num, &gen)) return -1;
+
+    pages_pos = resolve(&s, num, gen);
+    if (pages_pos < 0) return -1;
+
+    count_pos = dict_get(&s, pages_pos, "/Count");
+    if (count_pos < 0) return -1;
+    if (read_ref(&s, count_pos, &num, &gen)) {
+        count_pos = resolve(&s, num, gen);
+        if (count_pos < 0) return -1;
+    }
+    value = count_pos;
+    if (!parse_uint(&s, &value, &count) || count > 0x7FFFFFFF) return -1;
+
+    if (object_count) *object_count = (int)(objects - 1);
+    return (int)count;
+}
+
+int pdf_scan_object_count(const char* data, unsigned long long size)
+{
+    scan_t s;
+    long long pos, value, objects;
+    int is_stream = 0;
+
+    if (size < 32 || size > 0x3FFFFFFFFFFFFFFFULL) return -1;
+
+    memset(&s, 0, sizeof(s));
+    s.data = data;
+    s.size = (long long)size;
+
+    pos = pdf_scan_startxref(data, size, &is_stream);
+    if (pos < 0) return -1;
+
+    if (is_stream) {
+        /* "N G obj << /Type /XRef /Size ... >> stream" */
+        pos = skip_ws(&s, pos);
+        if (!parse_uint(&s, &pos, &value)) return -1;
+        pos = skip_ws(&s, pos);
+        if (!parse_uint(&s, &pos, &value)) return -1;
+        pos = skip_ws(&s, pos);
+        if (!match(&s, pos, "obj")) return -1;
+        pos += 3;
+    } else {
+        pos = walk_section(&s, pos, -1, &value);
+        if (pos < 0) return -1;
+    }
+
+    value = dict_get(&s, pos, "/Size");
+    if (!parse_uint(&s, &value, &objects) || objects < 1 || objects > 0x7FFFFFFF) return -1;
+    return (int)(objects - 1);
+}
+
+int pdf_scan_linearization(const char* data, unsigned long long size, long long* length,
+                           long long* first_page_end, long long* pages)
+{
+    scan_t s;
+    long long pos, value;
+
+    if (size < 32 || size > 0x3FFFFFFFFFFFFFFFULL) return -1;
+
+    memset(&s, 0, sizeof(s));
+    s.data = data;
+    s.size = (long long)size;
+
+    /* The header and binary marker lines are comments: "N G obj <<" follows */
+    pos = find_header(data, size);
+    if (pos < 0) return -1;
+    pos = skip_ws(&s, pos);
+    if (!parse_uint(&s, &pos, &value)) return -1;
+    pos = skip_ws(&s, pos);
+    if (!parse_uint(&s, &pos, &value)) return -1;
+    pos = skip_ws(&s, pos);
+    if (!match(&s, pos, "obj")) return -1;
+    pos = skip_ws(&s, pos + 3);
+    if (pos >= 1024 || dict_get(&s, pos, "/Linearized") < 0) return -1;
+
+    value = dict_get(&s, pos, "/L");
+    if (value < 0 || !parse_uint(&s, &value, length)) return -1;
+    value = dict_get(&s, pos, "/E");
+    if (value < 0 || !parse_uint(&s, &value, first_page_end)) return -1;
+    value = dict_get(&s, pos, "/N");
+    if (value < 0 || !parse_uint(&s, &value, pages)) return -1;
+    return 1;
+}
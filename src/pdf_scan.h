@@ -0,0 +1,61 @@
+/*
+ * pdf_scan.h
+ * Minimal read-only PDF structure scanner (internal)
+ *
+ * Reads the cross-reference data at the end of a file held in memory
+ * (usually a mapping) and resolves single objects from their offsets,
+ * without building an object graph. Only classic xref tables are
+ * understood; anything else is reported as "cannot answer" so the caller
+ * can fall back to QPDF.
+ */
+
+#ifndef PDF_SCAN_H
+#define PDF_SCAN_H
+
+/*
+ * Find the offset given by the last "startxref" in the file.
+ *
+ * @param is_stream set to 1 if no "xref" keyword is at that offset
+ *                  (cross-reference stream), else 0
+ * @return offset, -1 if missing or out of range
+ */
+long long pdf_scan_startxref(const char* data, unsigned long long size, int* is_stream);
+
+/*
+ * Page count from /Root -> /Pages -> /Count, reading only the trailer,
+ * the xref entries of the two objects and the objects themselves.
+ *
+ * @param object_count set to trailer /Size - 1 on success (NULL = unused)
+ * @return page count, -1 if the fast path cannot answer (cross-reference
+ *         stream, object streams, encryption or a damaged table)
+ */
+int pdf_scan_page_count(const char* data, unsigned long long size, int* object_count);
+
+/*
+ * Object count (/Size - 1) from the newest trailer or cross-reference
+ * stream dictionary. Unlike pdf_scan_page_count this also reads files with
+ * cross-reference streams, since only the dictionary at startxref is
+ * needed.
+ *
+ * @return object count, -1 if it cannot be read
+ */
+int pdf_scan_object_count(const char* data, unsigned long long size);
+
+/*
+ * Version from the "%PDF-x.y" header, "" if there is none.
+ */
+void pdf_scan_version(const char* data, unsigned long long size, char* version, int len);
+
+/*
+ * Linearization parameters from the first object of the file, which must
+ * be the /Linearized dictionary and start in the first 1024 bytes.
+ *
+ * @param length set to /L (file length the dictionary was written for)
+ * @param first_page_end set to /E (end of the first page section)
+ * @param pages set to /N
+ * @return 1 if found, -1 if the file has no readable dictionary there
+ */
+int pdf_scan_linearization(const char* data, unsigned long long size, long long* length,
+                           long long* first_page_end, long long* pages);
+
+#endif /* PDF_SCAN_H */
@@ -1,19 +1,24 @@
 /*
- * pdf_tools.c - PDF processing using QPDF (Memory-optimized sequential merge)
+ * pdf_tools.c - PDF processing using QPDF
  */
 
 #include "pdf_tools.h"
+#include "pdf_compat.h"
+#include "pdf_writer.h"
+#include "pdf_dedup.h"
+#include "pdf_scan.h"
+#include "pdf_index.h"
+#include "pdf_log.h"
+#include "pdf_trace.h"
 #include <qpdf/qpdf-c.h>
+#include <qpdf/qpdfjob-c.h>
+#include <qpdf/qpdflogger-c.h>
+#include <limits.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
-static FILE* g_log = NULL;
-static void log_msg(const char* msg) {
-    if (!g_log) g_log = _wfopen(L"C:\\Users\\mm\\Desktop\\pdf_debug.log", L"w");
-    if (g_log) { fprintf(g_log, "%s\n", msg); fflush(g_log); }
-}
-
 /* 오류 코드를 사용자 친화적 메시지로 변환 */
 const WCHAR* pdf_error_message(pdf_error_t error)
 {
@@ -36,6 +41,10 @@ const WCHAR* pdf_error_message(pdf_error_t error)
             return L"메모리가 부족합니다.\n파일 개수를 줄여서 다시 시도해주세요.";
         case PDF_ERR_TEMP_FILE:
             return L"임시 파일을 생성할 수 없습니다.\n디스크 공간을 확인해주세요.";
+        case PDF_ERR_CANCELLED:
+            return L"작업이 취소되었습니다.";
+        case PDF_ERR_INVALID_ARGUMENT:
+            return L"잘못된 인자입니다.\n파일 경로가 너무 길지 않은지 확인하세요.";
         case PDF_ERR_UNKNOWN:
         default:
             return L"알 수 없는 오류가 발생했습니다.";
@@ -45,126 +54,590 @@ const WCHAR* pdf_error_message(pdf_error_t error)
 /* 에러 코드 설정 헬퍼 매크로 */
 #define SET_ERROR(err_ptr, code) do { if (err_ptr) *(err_ptr) = (code); } while(0)
 
-/* Copy file using Windows API (handles Korean paths) */
-static int copy_file_w(const WCHAR* src, const WCHAR* dst)
+/* ==================== Cancellation ==================== */
+
+void pdf_cancel_init(pdf_cancel_t* cancel)
 {
-    return CopyFileW(src, dst, FALSE) ? 1 : 0;
+    if (!cancel) return;
+    cancel->requested = 0;
+    cancel->deadline = 0;
 }
 
-/* Generate temp file path (ASCII-safe for QPDF) */
-static int get_temp_file(WCHAR* out_path, const WCHAR* prefix)
+void pdf_cancel_request(pdf_cancel_t* cancel)
 {
-    WCHAR temp_dir[MAX_PATH];
-    if (GetTempPathW(MAX_PATH, temp_dir) == 0) return 0;
-    if (GetTempFileNameW(temp_dir, prefix, 0, out_path) == 0) return 0;
-    return 1;
+    if (cancel) InterlockedExchange(&cancel->requested, 1);
 }
 
-/* Convert wide string to narrow string (for temp paths which are ASCII) */
-static int wchar_to_utf8(const WCHAR* wstr, char* str, int len)
+void pdf_cancel_set_timeout(pdf_cancel_t* cancel, unsigned long timeout_ms)
 {
-    return WideCharToMultiByte(CP_UTF8, 0, wstr, -1, str, len, NULL, NULL);
+    if (!cancel) return;
+    cancel->deadline = timeout_ms ? GetTickCount64() + timeout_ms : 0;
 }
 
-int pdf_get_page_count(const WCHAR* pdf_path, pdf_error_t* error)
+int pdf_cancel_requested(const pdf_cancel_t* cancel)
 {
-    WCHAR temp_path[MAX_PATH];
-    char temp_path_a[MAX_PATH];
-    qpdf_data qpdf;
-    int page_count;
-    DWORD file_attr;
-    int qpdf_status;
+    if (!cancel) return 0;
+    if (cancel->requested) return 1;
+    return cancel->deadline != 0 && GetTickCount64() >= cancel->deadline;
+}
 
-    SET_ERROR(error, PDF_OK);
+/* CopyFileExW stops with ERROR_REQUEST_ABORTED when this returns PROGRESS_CANCEL */
+static DWORD CALLBACK copy_progress(LARGE_INTEGER total_size, LARGE_INTEGER transferred,
+                                   LARGE_INTEGER stream_size, LARGE_INTEGER stream_transferred,
+                                   DWORD stream_number, DWORD reason, HANDLE src, HANDLE dst, LPVOID data)
+{
+    (void)total_size; (void)transferred; (void)stream_size; (void)stream_transferred;
+    (void)stream_number; (void)reason; (void)src; (void)dst;
+    return pdf_cancel_requested((const pdf_cancel_t*)data) ? PROGRESS_CANCEL : PROGRESS_CONTINUE;
+}
 
-    /* 파일 존재 여부 확인 */
-    file_attr = GetFileAttributesW(pdf_path);
-    if (file_attr == INVALID_FILE_ATTRIBUTES) {
-        DWORD err = GetLastError();
-        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
-            SET_ERROR(error, PDF_ERR_FILE_NOT_FOUND);
-        } else if (err == ERROR_ACCESS_DENIED) {
-            SET_ERROR(error, PDF_ERR_ACCESS_DENIED);
-        } else {
-            SET_ERROR(error, PDF_ERR_UNKNOWN);
-        }
-        return -1;
+/* Copy file using Windows API (handles Korean paths), checking cancel per chunk */
+static int copy_file_w(const WCHAR* src, const WCHAR* dst, const pdf_cancel_t* cancel, pdf_error_t* error)
+{
+    if (CopyFileExW(src, dst, cancel ? copy_progress : NULL, (LPVOID)cancel, NULL, 0)) {
+        return 1;
     }
+    SET_ERROR(error, GetLastError() == ERROR_REQUEST_ABORTED ? PDF_ERR_CANCELLED : PDF_ERR_WRITE_FAILED);
+    return 0;
+}
 
-    /* Copy to temp file (ASCII path for QPDF) */
-    if (!get_temp_file(temp_path, L"pdf")) {
-        SET_ERROR(error, PDF_ERR_TEMP_FILE);
-        return -1;
+/* ==================== Operation statistics ==================== */
+
+/*
+ * Counters shared by the threads of one operation (pdf_stats_t while it
+ * runs). Phase times are performance counter ticks. Every helper accepts
+ * NULL, meaning the caller did not ask for statistics, and then does
+ * nothing, so call sites need no checks.
+ */
+typedef enum {
+    STAT_BYTES_READ = 0,
+    STAT_BYTES_WRITTEN,
+    STAT_PAGES,
+    STAT_OBJECTS,
+    STAT_DEDUP_STREAMS,
+    STAT_DEDUP_BYTES,
+    STAT_COUNTERS
+} stat_counter_t;
+
+typedef struct op_stats {
+    pdf_stats_t* out;
+    LONGLONG start;
+    volatile LONGLONG phase[PDF_PHASE_COUNT];
+    volatile LONGLONG counter[STAT_COUNTERS];
+    volatile LONGLONG temp_bytes;           /* 지금 디스크에 있는 임시 파일 크기 */
+    volatile LONGLONG peak_temp_bytes;
+} op_stats_t;
+
+/* 0 when neither stats nor a trace want the time */
+static LONGLONG stats_clock(const op_stats_t* s)
+{
+    if (!s && !PDF_TRACE_ENABLED()) return 0;
+    return pdf_trace_clock();
+}
+
+static double stats_seconds(LONGLONG ticks)
+{
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    return (double)ticks / (double)freq.QuadPart;
+}
+
+/* @return s if out is set, else NULL (what the other helpers take) */
+static op_stats_t* op_stats_begin(op_stats_t* s, pdf_stats_t* out)
+{
+    if (!out) return NULL;
+    memset(s, 0, sizeof(*s));
+    s->out = out;
+    s->start = stats_clock(s);
+    return s;
+}
+
+static void op_stats_end(op_stats_t* s)
+{
+    pdf_stats_t* out;
+    int i;
+
+    if (!s) return;
+    out = s->out;
+    memset(out, 0, sizeof(*out));
+    out->total_seconds = stats_seconds(stats_clock(s) - s->start);
+    for (i = 0; i < PDF_PHASE_COUNT; i++) {
+        out->phase_seconds[i] = stats_seconds(s->phase[i]);
     }
+    out->bytes_read = (unsigned long long)s->counter[STAT_BYTES_READ];
+    out->bytes_written = (unsigned long long)s->counter[STAT_BYTES_WRITTEN];
+    out->pages_copied = s->counter[STAT_PAGES];
+    out->objects_written = s->counter[STAT_OBJECTS];
+    out->streams_deduplicated = s->counter[STAT_DEDUP_STREAMS];
+    out->dedup_bytes_saved = (unsigned long long)s->counter[STAT_DEDUP_BYTES];
+    out->peak_temp_bytes = (unsigned long long)s->peak_temp_bytes;
+}
 
-    if (!copy_file_w(pdf_path, temp_path)) {
-        DWORD err = GetLastError();
-        DeleteFileW(temp_path);
-        if (err == ERROR_ACCESS_DENIED || err == ERROR_SHARING_VIOLATION) {
-            SET_ERROR(error, PDF_ERR_ACCESS_DENIED);
-        } else {
-            SET_ERROR(error, PDF_ERR_UNKNOWN);
-        }
-        return -1;
+/*
+ * Add the time since start (a stats_clock() value) to a phase, and record
+ * it as a trace span labelled with file (can be NULL).
+ */
+static void stats_file_phase(op_stats_t* s, pdf_phase_t phase, LONGLONG start, const WCHAR* file)
+{
+    static const char* const trace_names[PDF_PHASE_COUNT] = { "temp file", "read", "add pages", "dedup", "write", "commit" };
+
+    if (!start) return;
+    if (s) InterlockedExchangeAdd64(&s->phase[phase], stats_clock(s) - start);
+    PDF_TRACE_END(trace_names[phase], file, start);
+}
+
+static void stats_phase(op_stats_t* s, pdf_phase_t phase, LONGLONG start)
+{
+    stats_file_phase(s, phase, start, NULL);
+}
+
+static void stats_add(op_stats_t* s, stat_counter_t counter, LONGLONG n)
+{
+    if (s && n) InterlockedExchangeAdd64(&s->counter[counter], n);
+}
+
+/* Temp files appearing (delta > 0) or going away; keeps the peak */
+static void stats_temp(op_stats_t* s, LONGLONG delta)
+{
+    LONGLONG now, peak, seen;
+
+    if (!s || !delta) return;
+    now = InterlockedExchangeAdd64(&s->temp_bytes, delta) + delta;
+    peak = s->peak_temp_bytes;
+    while (now > peak) {
+        seen = InterlockedCompareExchange64(&s->peak_temp_bytes, now, peak);
+        if (seen == peak) break;
+        peak = seen;
     }
+}
 
-    wchar_to_utf8(temp_path, temp_path_a, MAX_PATH);
+static unsigned long long stats_output(op_stats_t* s, const WCHAR* path);
 
-    qpdf = qpdf_init();
-    if (qpdf == NULL) {
-        DeleteFileW(temp_path);
-        SET_ERROR(error, PDF_ERR_MEMORY);
-        return -1;
+const WCHAR* pdf_phase_name(pdf_phase_t phase)
+{
+    static const WCHAR* const names[PDF_PHASE_COUNT] = { L"temp", L"read", L"copy", L"dedup", L"write", L"commit" };
+    return (phase >= 0 && phase < PDF_PHASE_COUNT) ? names[phase] : L"?";
+}
+
+/* swprintf at buf + n, clamped to len; @return new length */
+static int append_w(WCHAR* buf, int len, int n, const WCHAR* fmt, ...)
+{
+    va_list ap;
+    int r;
+
+    if (n >= len - 1) return n;
+    va_start(ap, fmt);
+    r = vswprintf(buf + n, (size_t)(len - n), fmt, ap);
+    va_end(ap);
+    if (r < 0) {
+        buf[len - 1] = L'\0';
+        return len - 1;
+    }
+    return n + r;
+}
+
+int pdf_stats_format(const pdf_stats_t* stats, WCHAR* buf, int len)
+{
+    const double mb = 1024.0 * 1024.0;
+    int i, n, first = 1;
+
+    if (!buf || len <= 0) return 0;
+    buf[0] = L'\0';
+    if (!stats) return 0;
+
+    n = append_w(buf, len, 0, L"%.2fs", stats->total_seconds);
+    for (i = 0; i < PDF_PHASE_COUNT; i++) {
+        if (stats->phase_seconds[i] < 0.005) continue;
+        n = append_w(buf, len, n, L"%ls%ls %.2fs", first ? L" (" : L", ",
+                     pdf_phase_name((pdf_phase_t)i), stats->phase_seconds[i]);
+        first = 0;
+    }
+    if (!first) n = append_w(buf, len, n, L")");
+
+    n = append_w(buf, len, n, L", %.1f MB in, %.1f MB out, %lld pages, %lld objects",
+                 (double)stats->bytes_read / mb, (double)stats->bytes_written / mb,
+                 stats->pages_copied, stats->objects_written);
+    if (stats->peak_temp_bytes) {
+        n = append_w(buf, len, n, L", temp peak %.1f MB", (double)stats->peak_temp_bytes / mb);
+    }
+    if (stats->streams_deduplicated) {
+        n = append_w(buf, len, n, L", %lld duplicate streams (%.1f MB saved)",
+                     stats->streams_deduplicated, (double)stats->dedup_bytes_saved / mb);
+    }
+    return n;
+}
+
+/* ==================== Page progress ==================== */
+
+/*
+ * Work is counted in units: 1 when a page is copied into an output
+ * document, 1 when it is written. Workers add units with an interlocked
+ * add; only a caller that finds the interval elapsed takes the lock and
+ * reports, so per-page cost is one add and one tick read.
+ */
+typedef struct progress_tracker {
+    pdf_page_progress_cb cb;
+    void* user_data;
+    ULONGLONG interval;
+    long long total_units;
+    unsigned long long bytes_total;
+    ULONGLONG start_tick;
+    volatile LONGLONG done_units;
+    volatile LONGLONG next_tick;
+    SRWLOCK lock;
+    op_stats_t* stats;              /* 통계 (NULL = 수집 안 함), 작업 함수들이 함께 씀 */
+    const WCHAR** input_paths;      /* 병합 원본 입력 (input_pages 기록용) */
+    int input_count;
+    int* input_pages;               /* 입력별 qpdf_get_num_pages() 결과, NULL = 기록 안 함 */
+} progress_tracker_t;
+
+static void progress_init(progress_tracker_t* t, pdf_page_progress_cb cb, void* user_data, DWORD interval_ms,
+                          long long total_pages, unsigned long long bytes_total)
+{
+    memset(t, 0, sizeof(*t));
+    t->cb = cb;
+    t->user_data = user_data;
+    t->interval = interval_ms ? interval_ms : PDF_PROGRESS_DEFAULT_INTERVAL_MS;
+    t->total_units = total_pages * 2;
+    t->bytes_total = bytes_total;
+    t->start_tick = GetTickCount64();
+    t->next_tick = (LONGLONG)(t->start_tick + t->interval);
+    InitializeSRWLock(&t->lock);
+}
+
+/* Callers hold t->lock */
+static void progress_report_locked(progress_tracker_t* t, long long done, ULONGLONG now)
+{
+    pdf_progress_info_t info;
+    double fraction;
+
+    if (done > t->total_units) done = t->total_units;
+    fraction = t->total_units > 0 ? (double)done / (double)t->total_units : 0.0;
+
+    info.pages_done = done / 2;
+    info.pages_total = t->total_units / 2;
+    info.bytes_total = t->bytes_total;
+    info.bytes_done = (unsigned long long)(fraction * (double)t->bytes_total);
+    info.elapsed = (double)(now - t->start_tick) / 1000.0;
+    info.mb_per_sec = info.elapsed > 0 ? (double)info.bytes_done / (1024.0 * 1024.0) / info.elapsed : 0.0;
+    info.eta = (fraction > 0 && info.elapsed > 0) ? info.elapsed * (1.0 - fraction) / fraction : -1.0;
+    t->cb(&info, t->user_data);
+}
+
+/*
+ * Record the page count QPDF found for a merge input. Inputs are matched
+ * by path (the tree merge copies them); temp files match none.
+ */
+static void progress_input_pages(progress_tracker_t* t, const WCHAR* path, int pages)
+{
+    int i;
+    if (!t->input_pages) return;
+    for (i = 0; i < t->input_count; i++) {
+        if (wcscmp(t->input_paths[i], path) == 0) t->input_pages[i] = pages;
     }
+}
+
+static void progress_add(progress_tracker_t* t, long long units)
+{
+    LONGLONG done;
+    ULONGLONG now;
+
+    if (!t || !t->cb || units <= 0) return;
+
+    done = InterlockedExchangeAdd64(&t->done_units, units) + units;
+    now = GetTickCount64();
+    if ((LONGLONG)now < t->next_tick && done < t->total_units) return;
+
+    AcquireSRWLockExclusive(&t->lock);
+    /* Another thread may have reported meanwhile */
+    if ((LONGLONG)now >= t->next_tick || done >= t->total_units) {
+        t->next_tick = (LONGLONG)(now + t->interval);
+        if (done >= t->total_units) t->next_tick = LLONG_MAX;     /* report 100% once */
+        progress_report_locked(t, done, now);
+    }
+    ReleaseSRWLockExclusive(&t->lock);
+}
+
+/*
+ * Counts a document's pages as written while qpdf_write() runs, from
+ * QPDF's percentage callback.
+ */
+typedef struct write_progress {
+    progress_tracker_t* tracker;
+    int pages;
+    int reported;
+} write_progress_t;
+
+static void write_progress_report(int percent, void* data)
+{
+    write_progress_t* wp = (write_progress_t*)data;
+    int written = (int)((long long)wp->pages * percent / 100);
+
+    if (written > wp->reported) {
+        progress_add(wp->tracker, written - wp->reported);
+        wp->reported = written;
+    }
+}
 
-    page_count = -1;
+/* How a final output is written (from the split/merge options) */
+typedef struct output_format {
+    pdf_output_profile_t profile;
+    int linearize;
+    int dedup;                      /* 기록 전에 중복 스트림 합치기 (병합만) */
+    pdf_duplicate_mode_t duplicates;    /* 중복 페이지 처리 (병합만) */
+    pdf_duplicate_list_t* duplicate_list; /* 찾은 중복 페이지 (병합 순서 위치, dedup_output 참고) */
+} output_format_t;
 
-    /* Stream read from file (low memory) */
-    qpdf_status = qpdf_read(qpdf, temp_path_a, NULL);
-    if (qpdf_status < 2) {
-        page_count = qpdf_get_num_pages(qpdf);
+/* Intermediate merge results are read back right away: cheapest to write */
+static const output_format_t intermediate_format = { PDF_OUTPUT_FAST, 0, 0, PDF_DUPLICATES_KEEP, NULL };
+
+/* Writer settings of an output format. Call after qpdf_init_write() */
+static void set_output_format(qpdf_data qpdf_out, const output_format_t* format)
+{
+    switch (format->profile) {
+    case PDF_OUTPUT_FAST:
+        /* Stream data is copied byte for byte, objects are written plainly */
+        qpdf_set_decode_level(qpdf_out, qpdf_dl_none);
+        qpdf_set_compress_streams(qpdf_out, QPDF_FALSE);
+        qpdf_set_object_stream_mode(qpdf_out, qpdf_o_disable);
+        break;
+    case PDF_OUTPUT_COMPACT:
+        qpdf_set_decode_level(qpdf_out, qpdf_dl_generalized);
+        qpdf_set_compress_streams(qpdf_out, QPDF_TRUE);
+        qpdf_set_object_stream_mode(qpdf_out, qpdf_o_generate);
+        break;
+    case PDF_OUTPUT_STANDARD:
+    default:
+        break;
+    }
+    if (format->linearize) qpdf_set_linearization(qpdf_out, QPDF_TRUE);
+}
+
+/*
+ * Stream and page deduplication of an assembled output (format->dedup,
+ * format->duplicates). Runs once on the final document, so copies from
+ * every input are compared with each other.
+ * Duplicate pages are listed by position in the merged document, as if
+ * it were input 0; pdf_merge_ex() maps them to the inputs. With
+ * PDF_DUPLICATES_DROP they are removed and *out_pages goes down.
+ */
+static int dedup_output(qpdf_data qpdf_out, const output_format_t* format, const pdf_cancel_t* cancel,
+                        op_stats_t* stats, int* out_pages, pdf_error_t* error)
+{
+    pdf_duplicate_list_t* list = format->duplicate_list;
+    pdf_dedup_result_t saved;
+    LONGLONG start = stats_clock(stats);
+    pdf_error_t result;
+    qpdf_oh page;
+    int* first_of = NULL;
+    int i, page_count = 0, found = 0;
+
+    memset(&saved, 0, sizeof(saved));
+    if (format->duplicates == PDF_DUPLICATES_KEEP) {
+        result = pdf_dedup_streams(qpdf_out, cancel, &saved);
     } else {
-        /* QPDF 오류 - PDF 형식 문제 또는 암호화 */
-        const char* qpdf_err = qpdf_get_error_full_text(qpdf, qpdf_get_error(qpdf));
-        if (qpdf_err && strstr(qpdf_err, "password")) {
-            SET_ERROR(error, PDF_ERR_PASSWORD_PROTECTED);
-        } else {
-            SET_ERROR(error, PDF_ERR_INVALID_PDF);
+        page_count = qpdf_get_num_pages(qpdf_out);
+        first_of = (int*)malloc((size_t)(page_count > 0 ? page_count : 1) * sizeof(int));
+        result = first_of ? pdf_dedup_pages(qpdf_out, format->dedup, cancel, first_of, &saved) : PDF_ERR_MEMORY;
+    }
+
+    if (result == PDF_OK && first_of) {
+        for (i = 0; i < page_count; i++) {
+            if (first_of[i] < 0) continue;
+            if (list && list->pages && found < list->capacity) {
+                list->pages[found].input_index = 0;
+                list->pages[found].page = i + 1;
+                list->pages[found].first_input_index = 0;
+                list->pages[found].first_page = first_of[i] + 1;
+            }
+            found++;
         }
+        if (list) list->count = found;
+
+        if (format->duplicates == PDF_DUPLICATES_DROP) {
+            /* Back to front, so the indices of the pages still to go stay valid */
+            for (i = page_count - 1; i >= 0 && result == PDF_OK; i--) {
+                if (first_of[i] < 0) continue;
+                page = qpdf_get_page_n(qpdf_out, (size_t)i);
+                if (qpdf_remove_page(qpdf_out, page) >= QPDF_ERRORS) result = PDF_ERR_WRITE_FAILED;
+                qpdf_oh_release(qpdf_out, page);
+            }
+            if (result == PDF_OK) *out_pages -= found;
+        }
+        PDF_LOG(PDF_LOG_INFO, "dedup: %d duplicate pages%s", found,
+                format->duplicates == PDF_DUPLICATES_DROP ? " dropped" : "");
+    }
+    free(first_of);
+
+    stats_phase(stats, PDF_PHASE_DEDUP, start);
+    stats_add(stats, STAT_DEDUP_STREAMS, saved.streams);
+    stats_add(stats, STAT_DEDUP_BYTES, (LONGLONG)saved.bytes_saved);
+    if (format->dedup) {
+        PDF_LOG(PDF_LOG_INFO, "dedup: %lld duplicate streams, %llu bytes saved",
+                saved.streams, saved.bytes_saved);
     }
 
-    qpdf_cleanup(&qpdf);
-    DeleteFileW(temp_path);
+    if (result != PDF_OK) {
+        PDF_LOG(PDF_LOG_ERROR, "dedup failed (%d)", (int)result);
+        SET_ERROR(error, result);
+        return 0;
+    }
+    return 1;
+}
 
-    return page_count;
+/* Whether dedup_output() has anything to do */
+static int wants_dedup(const output_format_t* format)
+{
+    return format->dedup || format->duplicates != PDF_DUPLICATES_KEEP;
 }
 
-int pdf_split(const WCHAR* input_path, const WCHAR* output_path, int start_page, int end_page, pdf_error_t* error)
+/* Call after qpdf_init_write() */
+static void write_progress_begin(write_progress_t* wp, progress_tracker_t* t, qpdf_data qpdf_out, int pages)
 {
-    WCHAR temp_in[MAX_PATH];
-    WCHAR temp_out[MAX_PATH];
-    char temp_in_a[MAX_PATH];
-    char temp_out_a[MAX_PATH];
-    qpdf_data qpdf_in;
-    qpdf_data qpdf_out;
-    qpdf_oh page;
-    int i;
-    int result;
-    int total_pages;
+    wp->tracker = t;
+    wp->pages = pages;
+    wp->reported = 0;
+    if (t && t->cb) qpdf_register_progress_reporter(qpdf_out, write_progress_report, wp);
+}
 
-    SET_ERROR(error, PDF_OK);
+static void write_progress_end(write_progress_t* wp)
+{
+    progress_add(wp->tracker, wp->pages - wp->reported);
+    wp->reported = wp->pages;
+}
 
-    /* Create temp files */
-    if (!get_temp_file(temp_in, L"pin") || !get_temp_file(temp_out, L"pou")) {
-        SET_ERROR(error, PDF_ERR_TEMP_FILE);
+/* Generate temp file path in %TEMP% (intermediate merge results) */
+static int get_temp_file(WCHAR* out_path, const WCHAR* prefix)
+{
+    WCHAR temp_dir[MAX_PATH];
+    if (GetTempPathW(MAX_PATH, temp_dir) == 0) return 0;
+    if (GetTempFileNameW(temp_dir, prefix, 0, out_path) == 0) return 0;
+    return 1;
+}
+
+/* Convert wide string to UTF-8 (QPDF file names) */
+static int wchar_to_utf8(const WCHAR* wstr, char* str, int len)
+{
+    return WideCharToMultiByte(CP_UTF8, 0, wstr, -1, str, len, NULL, NULL);
+}
+
+/*
+ * Output written once, straight into a temp file next to the destination,
+ * then renamed over it. A crash or failed write never leaves a half-written
+ * file under the final name, and nothing is copied across volumes.
+ * QPDF converts UTF-8 file names to wide on Windows, so path_a can be
+ * passed to qpdf_init_write() even for Korean folders.
+ */
+typedef struct atomic_output {
+    const WCHAR* final_path;
+    WCHAR temp_path[MAX_PATH];
+    char temp_path_a[MAX_PATH * 3];
+    op_stats_t* stats;              /* output_commit()이 출력 크기와 교체 시간을 기록 */
+} atomic_output_t;
+
+static pdf_error_t output_error_from_win32(DWORD err)
+{
+    if (err == ERROR_ACCESS_DENIED || err == ERROR_SHARING_VIOLATION) {
+        return PDF_ERR_ACCESS_DENIED;
+    }
+    return PDF_ERR_WRITE_FAILED;
+}
+
+static int output_begin(const WCHAR* final_path, atomic_output_t* ao, op_stats_t* stats, pdf_error_t* error)
+{
+    WCHAR dir[MAX_PATH];
+    WCHAR* slash;
+    WCHAR* fwd;
+    LONGLONG start = stats_clock(stats);
+
+    memset(ao, 0, sizeof(*ao));
+    ao->final_path = final_path;
+    ao->stats = stats;
+
+    /* wcscpy_s would end the process on a longer path */
+    if (wcslen(final_path) >= MAX_PATH) {
+        SET_ERROR(error, PDF_ERR_INVALID_ARGUMENT);
+        return 0;
+    }
+    wcscpy_s(dir, MAX_PATH, final_path);
+    slash = wcsrchr(dir, L'\\');
+    fwd = wcsrchr(dir, L'/');
+    if (fwd > slash) slash = fwd;
+    if (slash) {
+        slash[1] = L'\0';
+    } else {
+        wcscpy_s(dir, MAX_PATH, L".");
+    }
+
+    /* Creates the (empty) temp file, so this also checks the folder is writable */
+    if (GetTempFileNameW(dir, L"jpt", 0, ao->temp_path) == 0) {
+        ao->temp_path[0] = L'\0';
+        SET_ERROR(error, output_error_from_win32(GetLastError()));
         return 0;
     }
+    wchar_to_utf8(ao->temp_path, ao->temp_path_a, (int)sizeof(ao->temp_path_a));
+    stats_phase(stats, PDF_PHASE_TEMP, start);
+    return 1;
+}
+
+static int output_commit(atomic_output_t* ao, pdf_error_t* error)
+{
+    /* The finished temp file counts as temp disk space until it is renamed */
+    LONGLONG size = (LONGLONG)stats_output(ao->stats, ao->temp_path);
+    LONGLONG start = stats_clock(ao->stats);
+    int ok = 1;
+
+    stats_temp(ao->stats, size);
+    if (!MoveFileExW(ao->temp_path, ao->final_path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        SET_ERROR(error, output_error_from_win32(GetLastError()));
+        DeleteFileW(ao->temp_path);
+        ok = 0;
+    }
+    ao->temp_path[0] = L'\0';
+    stats_phase(ao->stats, PDF_PHASE_COMMIT, start);
+    stats_temp(ao->stats, -size);
+    return ok;
+}
+
+static void output_abort(atomic_output_t* ao)
+{
+    if (ao->temp_path[0]) DeleteFileW(ao->temp_path);
+    ao->temp_path[0] = L'\0';
+}
 
-    /* Copy input to temp */
-    if (!copy_file_w(input_path, temp_in)) {
-        DWORD err = GetLastError();
-        DeleteFileW(temp_in);
-        DeleteFileW(temp_out);
+/*
+ * Read-only memory mapping of a whole file (wide path).
+ * Write and delete sharing are allowed so the file can be appended to, or
+ * replaced by an output, while mapped.
+ */
+typedef struct mapped_file {
+    HANDLE file;
+    HANDLE mapping;
+    const char* data;
+    unsigned long long size;
+} mapped_file_t;
+
+static void unmap_file(mapped_file_t* mf)
+{
+    if (mf->data) UnmapViewOfFile(mf->data);
+    if (mf->mapping) CloseHandle(mf->mapping);
+    if (mf->file != INVALID_HANDLE_VALUE && mf->file != NULL) CloseHandle(mf->file);
+    mf->data = NULL;
+    mf->mapping = NULL;
+    mf->file = INVALID_HANDLE_VALUE;
+    mf->size = 0;
+}
+
+static int map_file_w(const WCHAR* path, mapped_file_t* mf, pdf_error_t* error)
+{
+    LARGE_INTEGER size;
+    DWORD err;
+
+    memset(mf, 0, sizeof(*mf));
+    mf->file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mf->file == INVALID_HANDLE_VALUE) {
+        err = GetLastError();
         if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
             SET_ERROR(error, PDF_ERR_FILE_NOT_FOUND);
         } else if (err == ERROR_ACCESS_DENIED || err == ERROR_SHARING_VIOLATION) {
@@ -175,221 +648,1926 @@ int pdf_split(const WCHAR* input_path, const WCHAR* output_path, int start_page,
         return 0;
     }
 
-    wchar_to_utf8(temp_in, temp_in_a, MAX_PATH);
-    wchar_to_utf8(temp_out, temp_out_a, MAX_PATH);
+    /* Empty files cannot be mapped and are not PDFs anyway */
+    if (!GetFileSizeEx(mf->file, &size) || size.QuadPart == 0) {
+        unmap_file(mf);
+        SET_ERROR(error, PDF_ERR_INVALID_PDF);
+        return 0;
+    }
+    mf->size = (unsigned long long)size.QuadPart;
+
+    mf->mapping = CreateFileMappingW(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf->mapping) {
+        mf->data = (const char*)MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!mf->data) {
+        unmap_file(mf);
+        SET_ERROR(error, PDF_ERR_MEMORY);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Count a finished output file: its size and the object count from its
+ * trailer (only the tail of the file is read).
+ * @return file size, 0 if it cannot be mapped or s is NULL
+ */
+static unsigned long long stats_output(op_stats_t* s, const WCHAR* path)
+{
+    mapped_file_t mf;
+    unsigned long long size;
+    int objects;
+
+    if (!s || !map_file_w(path, &mf, NULL)) return 0;
+    size = mf.size;
+    objects = pdf_scan_object_count(mf.data, mf.size);
+    unmap_file(&mf);
+
+    stats_add(s, STAT_BYTES_WRITTEN, (LONGLONG)size);
+    if (objects > 0) stats_add(s, STAT_OBJECTS, objects);
+    return size;
+}
 
-    qpdf_in = qpdf_init();
-    qpdf_out = qpdf_init();
+static unsigned long long file_size_w(const WCHAR* path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &attr)) return 0;
+    return ((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+}
+
+/* An intermediate result in %TEMP% now holds data; counted until temp_delete() */
+static void temp_track(op_stats_t* s, const WCHAR* path)
+{
+    if (s) stats_temp(s, (LONGLONG)file_size_w(path));
+}
+
+static void temp_delete(op_stats_t* s, const WCHAR* path)
+{
+    LONGLONG start = stats_clock(s);
+    if (s) stats_temp(s, -(LONGLONG)file_size_w(path));
+    DeleteFileW(path);
+    stats_phase(s, PDF_PHASE_TEMP, start);
+}
+
+/*
+ * Parsed input document read straight from a mapping of the original file.
+ * Replaces the old "copy to %TEMP% for an ASCII path" step: the wide path
+ * is only used by CreateFileW, so Korean paths work without a copy.
+ * qpdf_read_memory() does not copy the buffer, so the mapping must stay
+ * alive as long as the qpdf handle (and any document that copied pages
+ * from it, until that document is written).
+ */
+typedef struct pdf_source {
+    mapped_file_t map;
+    qpdf_data qpdf;
+} pdf_source_t;
+
+static void source_close(pdf_source_t* src)
+{
+    if (src->qpdf) qpdf_cleanup(&src->qpdf);
+    src->qpdf = NULL;
+    unmap_file(&src->map);
+}
+
+/* QPDF read error -> pdf_error_t */
+static pdf_error_t qpdf_read_error(qpdf_data qpdf)
+{
+    const char* qpdf_err = qpdf_get_error_full_text(qpdf, qpdf_get_error(qpdf));
+    if (qpdf_err && strstr(qpdf_err, "password")) {
+        return PDF_ERR_PASSWORD_PROTECTED;
+    }
+    return PDF_ERR_INVALID_PDF;
+}
 
-    if (qpdf_in == NULL || qpdf_out == NULL) {
-        if (qpdf_in) qpdf_cleanup(&qpdf_in);
-        if (qpdf_out) qpdf_cleanup(&qpdf_out);
-        DeleteFileW(temp_in);
-        DeleteFileW(temp_out);
+/* Parse another qpdf handle from an already mapped source */
+static qpdf_data source_reopen(const pdf_source_t* src, pdf_error_t* error)
+{
+    qpdf_data qpdf = qpdf_init();
+    if (!qpdf) {
         SET_ERROR(error, PDF_ERR_MEMORY);
+        return NULL;
+    }
+    if (qpdf_read_memory(qpdf, "input", src->map.data, src->map.size, NULL) >= 2) {
+        SET_ERROR(error, qpdf_read_error(qpdf));
+        qpdf_cleanup(&qpdf);
+        return NULL;
+    }
+    return qpdf;
+}
+
+static int source_open(const WCHAR* path, pdf_source_t* src, op_stats_t* stats, pdf_error_t* error)
+{
+    LONGLONG start = stats_clock(stats);
+
+    memset(src, 0, sizeof(*src));
+    src->map.file = INVALID_HANDLE_VALUE;
+
+    if (!map_file_w(path, &src->map, error)) {
+        return 0;
+    }
+    src->qpdf = source_reopen(src, error);
+    if (!src->qpdf) {
+        unmap_file(&src->map);
         return 0;
     }
+    stats_file_phase(stats, PDF_PHASE_READ, start, path);
+    stats_add(stats, STAT_BYTES_READ, (LONGLONG)src->map.size);
+    return 1;
+}
 
-    result = 0;
+/* Cut a file back to its original size (undo a failed append) */
+static void truncate_file_w(const WCHAR* path, unsigned long long size)
+{
+    HANDLE h;
+    LARGE_INTEGER pos;
+
+    h = CreateFileW(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return;
+    pos.QuadPart = (LONGLONG)size;
+    if (SetFilePointerEx(h, pos, NULL, FILE_BEGIN)) SetEndOfFile(h);
+    CloseHandle(h);
+}
 
-    /* Stream read from file */
-    if (qpdf_read(qpdf_in, temp_in_a, NULL) < 2) {
-        /* 페이지 범위 검증 */
-        total_pages = qpdf_get_num_pages(qpdf_in);
-        if (start_page < 1 || end_page > total_pages || start_page > end_page) {
-            qpdf_cleanup(&qpdf_in);
-            qpdf_cleanup(&qpdf_out);
-            DeleteFileW(temp_in);
-            DeleteFileW(temp_out);
-            SET_ERROR(error, PDF_ERR_PAGE_OUT_OF_RANGE);
-            return 0;
+/* ==================== Worker pool ==================== */
+
+/*
+ * run_parallel - Run task_fn(0..task_count-1) on up to thread_count threads.
+ * task_fn also gets the worker number (0..threads-1) so callers can keep
+ * per-worker state such as their own qpdf handles.
+ * done_fn (can be NULL) is called on the calling thread each time a task
+ * finishes, so callers can report progress without touching the workers.
+ * @return 1 if all threads were started, 0 on failure (no task was run)
+ */
+typedef void (*parallel_task_fn)(int index, int worker, void* ctx);
+typedef void (*parallel_done_fn)(int done_count, void* ctx);
+
+typedef struct parallel_pool {
+    parallel_task_fn task_fn;
+    void* ctx;
+    int task_count;
+    volatile LONG next_task;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE done_cv;
+    int done_count;
+} parallel_pool_t;
+
+typedef struct parallel_worker_arg {
+    parallel_pool_t* pool;
+    int worker;
+} parallel_worker_arg_t;
+
+static DWORD WINAPI parallel_worker(LPVOID param)
+{
+    parallel_worker_arg_t* arg = (parallel_worker_arg_t*)param;
+    parallel_pool_t* pool = arg->pool;
+    LONG index;
+
+    for (;;) {
+        index = InterlockedIncrement(&pool->next_task) - 1;
+        if (index >= pool->task_count) break;
+
+        pool->task_fn((int)index, arg->worker, pool->ctx);
+
+        EnterCriticalSection(&pool->lock);
+        pool->done_count++;
+        LeaveCriticalSection(&pool->lock);
+        WakeConditionVariable(&pool->done_cv);
+    }
+    return 0;
+}
+
+static int default_thread_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+/* Number of workers run_parallel() will use at most */
+static int pool_thread_count(int task_count, int thread_count)
+{
+    if (thread_count <= 0) thread_count = default_thread_count();
+    if (thread_count > task_count) thread_count = task_count;
+    return thread_count > 0 ? thread_count : 1;
+}
+
+static int run_parallel(int task_count, int thread_count,
+                        parallel_task_fn task_fn, parallel_done_fn done_fn, void* ctx)
+{
+    parallel_pool_t pool;
+    HANDLE* threads;
+    parallel_worker_arg_t* args;
+    int i, started = 0, reported = 0, done;
+
+    if (task_count <= 0) return 1;
+    thread_count = pool_thread_count(task_count, thread_count);
+
+    threads = (HANDLE*)calloc((size_t)thread_count, sizeof(HANDLE));
+    args = (parallel_worker_arg_t*)calloc((size_t)thread_count, sizeof(parallel_worker_arg_t));
+    if (!threads || !args) {
+        free(threads);
+        free(args);
+        return 0;
+    }
+
+    memset(&pool, 0, sizeof(pool));
+    pool.task_fn = task_fn;
+    pool.ctx = ctx;
+    pool.task_count = task_count;
+    InitializeCriticalSection(&pool.lock);
+    InitializeConditionVariable(&pool.done_cv);
+
+    for (i = 0; i < thread_count; i++) {
+        args[i].pool = &pool;
+        args[i].worker = i;
+        threads[i] = CreateThread(NULL, 0, parallel_worker, &args[i], 0, NULL);
+        if (!threads[i]) break;
+        started++;
+    }
+
+    if (started == 0) {
+        DeleteCriticalSection(&pool.lock);
+        free(args);
+        free(threads);
+        return 0;
+    }
+
+    /* Report completions from this thread until every task is done */
+    EnterCriticalSection(&pool.lock);
+    while (reported < task_count) {
+        while (pool.done_count == reported) {
+            SleepConditionVariableCS(&pool.done_cv, &pool.lock, INFINITE);
+        }
+        done = pool.done_count;
+        LeaveCriticalSection(&pool.lock);
+        while (reported < done) {
+            reported++;
+            if (done_fn) done_fn(reported, ctx);
+        }
+        EnterCriticalSection(&pool.lock);
+    }
+    LeaveCriticalSection(&pool.lock);
+
+    for (i = 0; i < started; i++) {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+
+    DeleteCriticalSection(&pool.lock);
+    free(args);
+    free(threads);
+    return 1;
+}
+
+/*
+ * Root /Pages /Count of an already parsed document, -1 if not usable.
+ * Only the catalog and the page tree root are resolved; QPDF has read
+ * nothing else but the cross-reference data.
+ */
+static int qpdf_root_page_count(qpdf_data qpdf)
+{
+    qpdf_oh root, pages, count;
+    int page_count = -1;
+
+    root = qpdf_get_root(qpdf);
+    pages = qpdf_oh_get_key(qpdf, root, "/Pages");
+    count = qpdf_oh_get_key(qpdf, pages, "/Count");
+    if (qpdf_oh_is_dictionary(qpdf, pages) && qpdf_oh_is_integer(qpdf, count) &&
+        qpdf_oh_get_int_value(qpdf, count) >= 0 && qpdf_oh_get_int_value(qpdf, count) <= 0x7FFFFFFF) {
+        page_count = (int)qpdf_oh_get_int_value(qpdf, count);
+    }
+    qpdf_oh_release(qpdf, count);
+    qpdf_oh_release(qpdf, pages);
+    qpdf_oh_release(qpdf, root);
+
+    if (qpdf_has_error(qpdf)) return -1;
+    return page_count;
+}
+
+/*
+ * source_file_info - File facts with as little parsing as possible
+ * src->qpdf may be NULL; it is parsed from the mapping only if needed.
+ * cancel is checked before each QPDF step (can be NULL).
+ * @return 1 on success, 0 on failure
+ */
+static int source_file_info(pdf_source_t* src, pdf_file_info_t* info, const pdf_cancel_t* cancel,
+                            pdf_error_t* error)
+{
+    qpdf_oh trailer, size;
+
+    memset(info, 0, sizeof(*info));
+
+    /* 1. Classic xref table: read the tail and two objects ourselves */
+    info->page_count = pdf_scan_page_count(src->map.data, src->map.size, &info->object_count);
+    if (info->page_count >= 0) {
+        pdf_scan_version(src->map.data, src->map.size, info->version, (int)sizeof(info->version));
+        return 1;
+    }
+
+    /* 2. Cross-reference streams, object streams: QPDF reads the xref data
+     *    and we only resolve the catalog and page tree root */
+    if (pdf_cancel_requested(cancel)) {
+        SET_ERROR(error, PDF_ERR_CANCELLED);
+        return 0;
+    }
+    if (!src->qpdf) {
+        src->qpdf = source_reopen(src, error);
+        if (!src->qpdf) return 0;
+    }
+    info->encrypted = qpdf_is_encrypted(src->qpdf) ? 1 : 0;
+    strncpy(info->version, qpdf_get_pdf_version(src->qpdf), sizeof(info->version) - 1);
+
+    trailer = qpdf_get_trailer(src->qpdf);
+    size = qpdf_oh_get_key(src->qpdf, trailer, "/Size");
+    info->object_count = qpdf_oh_is_integer(src->qpdf, size) ? qpdf_oh_get_int_value_as_int(src->qpdf, size) - 1 : 0;
+    qpdf_oh_release(src->qpdf, size);
+    qpdf_oh_release(src->qpdf, trailer);
+
+    info->page_count = -1;
+    if (!info->encrypted && !qpdf_more_warnings(src->qpdf)) {
+        info->page_count = qpdf_root_page_count(src->qpdf);
+    }
+
+    /* 3. Damaged (xref rebuilt) or encrypted: count by walking the page tree */
+    if (info->page_count < 0) {
+        if (pdf_cancel_requested(cancel)) {
+            SET_ERROR(error, PDF_ERR_CANCELLED);
+            return 0;
+        }
+        info->page_count = qpdf_get_num_pages(src->qpdf);
+    }
+    if (info->page_count < 0) {
+        SET_ERROR(error, PDF_ERR_INVALID_PDF);
+        return 0;
+    }
+    return 1;
+}
+
+static int get_file_info(const WCHAR* pdf_path, pdf_file_info_t* info, const pdf_cancel_t* cancel,
+                         op_stats_t* stats, pdf_error_t* error)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    pdf_source_t src;
+    unsigned long long size, mtime;
+    LONGLONG start = stats_clock(stats);
+    int ok;
+    DWORD err;
+
+    SET_ERROR(error, PDF_OK);
+
+    /* Key: path, size, mtime (metadata only, the file is not opened) */
+    if (!GetFileAttributesExW(pdf_path, GetFileExInfoStandard, &attr)) {
+        err = GetLastError();
+        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
+            SET_ERROR(error, PDF_ERR_FILE_NOT_FOUND);
+        } else if (err == ERROR_ACCESS_DENIED) {
+            SET_ERROR(error, PDF_ERR_ACCESS_DENIED);
+        } else {
+            SET_ERROR(error, PDF_ERR_UNKNOWN);
+        }
+        return 0;
+    }
+    size = ((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+    mtime = ((unsigned long long)attr.ftLastWriteTime.dwHighDateTime << 32) | attr.ftLastWriteTime.dwLowDateTime;
+
+    if (pdf_index_lookup(pdf_path, size, mtime, info)) {
+        stats_file_phase(stats, PDF_PHASE_READ, start, pdf_path);
+        return 1;
+    }
+    if (pdf_cancel_requested(cancel)) {
+        SET_ERROR(error, PDF_ERR_CANCELLED);
+        return 0;
+    }
+
+    /* Map the file in place (handles Korean paths) */
+    memset(&src, 0, sizeof(src));
+    if (!map_file_w(pdf_path, &src.map, error)) {
+        return 0;
+    }
+    ok = source_file_info(&src, info, cancel, error);
+    source_close(&src);
+    stats_file_phase(stats, PDF_PHASE_READ, start, pdf_path);
+    stats_add(stats, STAT_BYTES_READ, (LONGLONG)size);
+
+    if (ok) {
+        pdf_index_store(pdf_path, size, mtime, info);
+    }
+    return ok;
+}
+
+int pdf_get_file_info(const WCHAR* pdf_path, pdf_file_info_t* info, pdf_error_t* error)
+{
+    return get_file_info(pdf_path, info, NULL, NULL, error);
+}
+
+int pdf_get_page_count_ex(const WCHAR* pdf_path, const pdf_cancel_t* cancel, pdf_stats_t* stats,
+                          pdf_error_t* error)
+{
+    pdf_file_info_t info;
+    op_stats_t op;
+    op_stats_t* s = op_stats_begin(&op, stats);
+    int ok = get_file_info(pdf_path, &info, cancel, s, error);
+
+    op_stats_end(s);
+    return ok ? info.page_count : -1;
+}
+
+int pdf_get_page_count(const WCHAR* pdf_path, pdf_error_t* error)
+{
+    return pdf_get_page_count_ex(pdf_path, NULL, NULL, error);
+}
+
+/*
+ * Hint table check. The QPDF C API has no checkLinearization, so this
+ * runs the job interface's --check-linearization on the file; its report
+ * goes to stderr so it does not mix with a caller's stdout.
+ * @return 1 = no linearization errors
+ */
+static int run_linearization_check(const WCHAR* pdf_path)
+{
+    char path_a[MAX_PATH * 3];
+    const char* argv[4];
+    qpdfjob_handle job;
+    qpdflogger_handle logger;
+    int status;
+
+    if (wchar_to_utf8(pdf_path, path_a, (int)sizeof(path_a)) == 0) {
+        return 0;
+    }
+    argv[0] = "qpdf";
+    argv[1] = "--check-linearization";
+    argv[2] = path_a;
+    argv[3] = NULL;
+
+    logger = qpdflogger_create();
+    qpdflogger_set_info(logger, qpdf_log_dest_stderr, NULL, NULL);
+    job = qpdfjob_init();
+    qpdfjob_set_logger(job, logger);
+    status = qpdfjob_initialize_from_argv(job, argv);
+    if (status == 0) {
+        status = qpdfjob_run(job);
+    }
+    qpdfjob_cleanup(&job);
+    qpdflogger_cleanup(&logger);
+
+    /* 0 = no errors, 3 (warnings) = linearization errors, 2 = failed */
+    return status == 0;
+}
+
+int pdf_check_linearization_ex(const WCHAR* pdf_path, pdf_linearization_t* info, pdf_error_t* error)
+{
+    pdf_source_t src;
+    long long length, first_page_end, pages;
+    int result;
+
+    SET_ERROR(error, PDF_OK);
+    if (info) memset(info, 0, sizeof(*info));
+    if (!source_open(pdf_path, &src, NULL, error)) {
+        return -1;
+    }
+
+    /* First page section from the dictionary QPDF found; a file appended
+     * to after linearizing no longer matches /L */
+    result = qpdf_is_linearized(src.qpdf) &&
+             pdf_scan_linearization(src.map.data, src.map.size, &length, &first_page_end, &pages) == 1;
+    if (result) {
+        if (info) {
+            info->file_size = src.map.size;
+            info->first_page_end = (unsigned long long)first_page_end;
+        }
+        result = (unsigned long long)length == src.map.size && first_page_end <= length &&
+                 (pages <= 1 || first_page_end < length);
+    }
+    source_close(&src);
+
+    return result && run_linearization_check(pdf_path);
+}
+
+int pdf_check_linearization(const WCHAR* pdf_path, pdf_error_t* error)
+{
+    return pdf_check_linearization_ex(pdf_path, NULL, error);
+}
+
+/* ==================== Document cache ==================== */
+
+/*
+ * Parsed documents keyed on (path, size, mtime), most recently used first.
+ * An entry is the pdf_document_t handed out to callers; refs counts open
+ * handles and running operations. Entries with refs == 0 stay cached until
+ * the byte limit (file sizes, as a proxy for mapping + parsed objects) or
+ * the entry limit evicts them.
+ * use_lock serializes operations on the entry's qpdf handle, which is not
+ * thread-safe.
+ */
+#define DOC_CACHE_MAX_ENTRIES 16
+#define DOC_CACHE_DEFAULT_LIMIT (1024ULL * 1024 * 1024)
+
+struct pdf_document {
+    WCHAR path[MAX_PATH];
+    unsigned long long size;
+    FILETIME mtime;
+    pdf_source_t src;
+    int page_count;             /* -1 until computed */
+    int refs;
+    int stale;                  /* file changed: not in the list, freed on last close */
+    SRWLOCK use_lock;
+    struct pdf_document* prev;
+    struct pdf_document* next;
+};
+
+static SRWLOCK g_doc_lock = SRWLOCK_INIT;
+static pdf_document_t* g_doc_head;
+static pdf_document_t* g_doc_tail;
+static int g_doc_count;
+static unsigned long long g_doc_bytes;
+static unsigned long long g_doc_limit = DOC_CACHE_DEFAULT_LIMIT;
+static unsigned long long g_doc_hits;
+static unsigned long long g_doc_misses;
+static unsigned long long g_doc_evictions;
+
+static void doc_free(pdf_document_t* doc)
+{
+    source_close(&doc->src);
+    free(doc);
+}
+
+/* Callers hold g_doc_lock */
+static void doc_unlink(pdf_document_t* doc)
+{
+    if (doc->prev) doc->prev->next = doc->next;
+    else g_doc_head = doc->next;
+    if (doc->next) doc->next->prev = doc->prev;
+    else g_doc_tail = doc->prev;
+    doc->prev = doc->next = NULL;
+    g_doc_count--;
+    g_doc_bytes -= doc->size;
+}
+
+static void doc_push_front(pdf_document_t* doc)
+{
+    doc->prev = NULL;
+    doc->next = g_doc_head;
+    if (g_doc_head) g_doc_head->prev = doc;
+    g_doc_head = doc;
+    if (!g_doc_tail) g_doc_tail = doc;
+    g_doc_count++;
+    g_doc_bytes += doc->size;
+}
+
+/* Unlink unreferenced entries from the LRU end while over the limits.
+ * Returns them as a list (via next) to be freed outside the lock. */
+static pdf_document_t* doc_evict_locked(int force_all)
+{
+    pdf_document_t* doc = g_doc_tail;
+    pdf_document_t* prev;
+    pdf_document_t* evicted = NULL;
+
+    while (doc && (force_all || g_doc_bytes > g_doc_limit || g_doc_count > DOC_CACHE_MAX_ENTRIES)) {
+        prev = doc->prev;
+        if (doc->refs == 0) {
+            doc_unlink(doc);
+            doc->next = evicted;
+            evicted = doc;
+            g_doc_evictions++;
+        }
+        doc = prev;
+    }
+    return evicted;
+}
+
+static void doc_free_list(pdf_document_t* list)
+{
+    pdf_document_t* next;
+    while (list) {
+        next = list->next;
+        doc_free(list);
+        list = next;
+    }
+}
+
+/* pdf_document_open(); a cache miss is counted in stats (can be NULL) */
+static pdf_document_t* document_open(const WCHAR* path, op_stats_t* stats, pdf_error_t* error)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    pdf_document_t* doc;
+    pdf_document_t* fresh;
+    pdf_document_t* evicted;
+    pdf_document_t* dropped = NULL;
+    unsigned long long size;
+    DWORD err;
+
+    SET_ERROR(error, PDF_OK);
+
+    /* The cache keeps the path in a MAX_PATH buffer */
+    if (wcslen(path) >= MAX_PATH) {
+        SET_ERROR(error, PDF_ERR_INVALID_ARGUMENT);
+        return NULL;
+    }
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &attr)) {
+        err = GetLastError();
+        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
+            SET_ERROR(error, PDF_ERR_FILE_NOT_FOUND);
+        } else if (err == ERROR_ACCESS_DENIED) {
+            SET_ERROR(error, PDF_ERR_ACCESS_DENIED);
+        } else {
+            SET_ERROR(error, PDF_ERR_UNKNOWN);
+        }
+        return NULL;
+    }
+    size = ((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+
+    AcquireSRWLockExclusive(&g_doc_lock);
+    for (doc = g_doc_head; doc; doc = doc->next) {
+        if (pdf_path_cmp(doc->path, path) != 0) continue;
+        if (doc->size == size && CompareFileTime(&doc->mtime, &attr.ftLastWriteTime) == 0) {
+            doc->refs++;
+            doc_unlink(doc);
+            doc_push_front(doc);
+            g_doc_hits++;
+            ReleaseSRWLockExclusive(&g_doc_lock);
+            return doc;
+        }
+        /* Same path, different file: drop it from the cache */
+        doc_unlink(doc);
+        if (doc->refs == 0) {
+            dropped = doc;
+        } else {
+            doc->stale = 1;
+        }
+        break;
+    }
+    g_doc_misses++;
+    ReleaseSRWLockExclusive(&g_doc_lock);
+
+    if (dropped) doc_free(dropped);
+
+    /* Parse outside the lock */
+    fresh = (pdf_document_t*)calloc(1, sizeof(pdf_document_t));
+    if (!fresh) {
+        SET_ERROR(error, PDF_ERR_MEMORY);
+        return NULL;
+    }
+    wcscpy_s(fresh->path, MAX_PATH, path);
+    fresh->size = size;
+    fresh->mtime = attr.ftLastWriteTime;
+    fresh->page_count = -1;
+    fresh->refs = 1;
+    InitializeSRWLock(&fresh->use_lock);
+    if (!source_open(path, &fresh->src, stats, error)) {
+        free(fresh);
+        return NULL;
+    }
+
+    AcquireSRWLockExclusive(&g_doc_lock);
+    /* Another thread may have opened the same file meanwhile */
+    for (doc = g_doc_head; doc; doc = doc->next) {
+        if (pdf_path_cmp(doc->path, path) == 0 && doc->size == size &&
+            CompareFileTime(&doc->mtime, &attr.ftLastWriteTime) == 0) {
+            break;
+        }
+    }
+    if (doc) {
+        doc->refs++;
+        ReleaseSRWLockExclusive(&g_doc_lock);
+        doc_free(fresh);
+        return doc;
+    }
+    doc_push_front(fresh);
+    evicted = doc_evict_locked(0);
+    ReleaseSRWLockExclusive(&g_doc_lock);
+
+    doc_free_list(evicted);
+    return fresh;
+}
+
+pdf_document_t* pdf_document_open(const WCHAR* path, pdf_error_t* error)
+{
+    return document_open(path, NULL, error);
+}
+
+void pdf_document_close(pdf_document_t* doc)
+{
+    pdf_document_t* evicted = NULL;
+    int free_now = 0;
+
+    if (!doc) return;
+
+    AcquireSRWLockExclusive(&g_doc_lock);
+    doc->refs--;
+    if (doc->stale) {
+        free_now = (doc->refs == 0);
+    } else {
+        evicted = doc_evict_locked(0);
+    }
+    ReleaseSRWLockExclusive(&g_doc_lock);
+
+    if (free_now) doc_free(doc);
+    doc_free_list(evicted);
+}
+
+int pdf_document_get_page_count(pdf_document_t* doc, pdf_error_t* error)
+{
+    int page_count;
+
+    SET_ERROR(error, PDF_OK);
+    if (!doc) {
+        SET_ERROR(error, PDF_ERR_UNKNOWN);
+        return -1;
+    }
+
+    /* The document is parsed anyway: count the page tree the way split
+     * does, not the root /Count the path-only queries trust */
+    AcquireSRWLockExclusive(&doc->use_lock);
+    if (doc->page_count < 0) {
+        doc->page_count = qpdf_get_num_pages(doc->src.qpdf);
+        if (doc->page_count < 0) SET_ERROR(error, PDF_ERR_INVALID_PDF);
+    }
+    page_count = doc->page_count;
+    ReleaseSRWLockExclusive(&doc->use_lock);
+
+    return page_count;
+}
+
+void pdf_document_cache_set_limit(unsigned long long max_bytes)
+{
+    pdf_document_t* evicted;
+
+    AcquireSRWLockExclusive(&g_doc_lock);
+    g_doc_limit = max_bytes;
+    evicted = doc_evict_locked(0);
+    ReleaseSRWLockExclusive(&g_doc_lock);
+
+    doc_free_list(evicted);
+}
+
+void pdf_document_cache_get_stats(pdf_cache_stats_t* stats)
+{
+    if (!stats) return;
+
+    AcquireSRWLockShared(&g_doc_lock);
+    stats->hits = g_doc_hits;
+    stats->misses = g_doc_misses;
+    stats->evictions = g_doc_evictions;
+    stats->entries = g_doc_count;
+    stats->bytes = g_doc_bytes;
+    stats->limit = g_doc_limit;
+    ReleaseSRWLockShared(&g_doc_lock);
+}
+
+void pdf_document_cache_clear(void)
+{
+    pdf_document_t* evicted;
+
+    AcquireSRWLockExclusive(&g_doc_lock);
+    evicted = doc_evict_locked(1);
+    ReleaseSRWLockExclusive(&g_doc_lock);
+
+    doc_free_list(evicted);
+}
+
+/* Skip blanks in a page-range expression */
+static const wchar_t* range_skip_blanks(const wchar_t* s)
+{
+    while (*s == L' ' || *s == L'\t') s++;
+    return s;
+}
+
+/* One bound of a range: a number or "$" (= last_page). 0 = syntax error */
+static int range_bound(const wchar_t** p, int last_page, int* page)
+{
+    const wchar_t* s = range_skip_blanks(*p);
+    long long value = 0;
+
+    if (*s == L'$') {
+        value = last_page;
+        s++;
+    } else if (*s >= L'0' && *s <= L'9') {
+        for (; *s >= L'0' && *s <= L'9'; s++) {
+            if (value <= INT_MAX) value = value * 10 + (*s - L'0');
+        }
+    } else {
+        return 0;
+    }
+    *page = value > INT_MAX ? INT_MAX : (int)value;
+    *p = range_skip_blanks(s);
+    return 1;
+}
+
+/*
+ * Next item of a page-range expression; *p moves past it and its comma.
+ * @return 1 = item *first..*last (reverse if first > last), 0 = end, -1 = syntax error
+ */
+static int range_next(const wchar_t** p, int last_page, int* first, int* last)
+{
+    const wchar_t* s = *p;
+
+    if (!*s) return 0;
+    if (!range_bound(&s, last_page, first)) return -1;
+    *last = *first;
+    if (*s == L'-') {
+        s++;
+        if (!range_bound(&s, last_page, last)) return -1;
+    }
+    if (*s == L',') {
+        s = range_skip_blanks(s + 1);
+        if (!*s) return -1;
+    } else if (*s) {
+        return -1;
+    }
+    *p = s;
+    return 1;
+}
+
+int pdf_page_ranges_count(const wchar_t* expr, int total_pages, int* bad_page)
+{
+    const wchar_t* p = expr;
+    int last_page = total_pages > 0 ? total_pages : INT_MAX;
+    long long count = 0;
+    int first, last, r;
+
+    if (!expr) return -1;
+    while ((r = range_next(&p, last_page, &first, &last)) > 0) {
+        if (first < 1 || first > last_page || last < 1 || last > last_page) {
+            if (bad_page) *bad_page = first < 1 || first > last_page ? first : last;
+            return -2;
+        }
+        if (total_pages > 0) {
+            count += first <= last ? last - first + 1 : first - last + 1;
+            if (count > INT_MAX) return -2;
+        }
+    }
+    if (r < 0 || p == expr) return -1;
+    return (int)count;
+}
+
+/* Pages a chapter selects; PDF_ERR_PAGE_OUT_OF_RANGE for a bad range or expression */
+static pdf_error_t chapter_page_count(const pdf_split_chapter_t* chapter, int total_pages, int* count)
+{
+    if (chapter->pages) {
+        *count = pdf_page_ranges_count(chapter->pages, total_pages, NULL);
+        return *count > 0 ? PDF_OK : PDF_ERR_PAGE_OUT_OF_RANGE;
+    }
+    if (chapter->start_page < 1 || chapter->end_page > total_pages || chapter->start_page > chapter->end_page) {
+        return PDF_ERR_PAGE_OUT_OF_RANGE;
+    }
+    *count = chapter->end_page - chapter->start_page + 1;
+    return PDF_OK;
+}
+
+/*
+ * Next range of a checked chapter: the items of its expression, or
+ * start_page-end_page once. *pos starts at NULL.
+ */
+static int chapter_next_range(const pdf_split_chapter_t* chapter, int total_pages, const wchar_t** pos,
+                              int* first, int* last)
+{
+    if (!chapter->pages) {
+        if (*pos) return 0;
+        *pos = L"";
+        *first = chapter->start_page;
+        *last = chapter->end_page;
+        return 1;
+    }
+    if (!*pos) *pos = chapter->pages;
+    return range_next(pos, total_pages, first, last) > 0;
+}
+
+/*
+ * split_write_chapter - Write one chapter from an already parsed source
+ * cancel is checked before every page and before the write.
+ * @return PDF_OK or the chapter's error code
+ */
+static pdf_error_t split_write_chapter(qpdf_data qpdf_in, int total_pages, const pdf_split_chapter_t* chapter,
+                                       const output_format_t* format, const pdf_cancel_t* cancel,
+                                       progress_tracker_t* progress)
+{
+    atomic_output_t out;
+    write_progress_t wp;
+    qpdf_data qpdf_out;
+    qpdf_oh page;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start, span;
+    const wchar_t* pos = NULL;
+    int i, first, last, page_count, copied = 0;
+    pdf_error_t result;
+
+    /* 페이지 범위 검증 */
+    result = chapter_page_count(chapter, total_pages, &page_count);
+    if (result != PDF_OK) {
+        return result;
+    }
+    if (pdf_cancel_requested(cancel)) {
+        return PDF_ERR_CANCELLED;
+    }
+
+    span = PDF_TRACE_BEGIN();
+    if (!output_begin(chapter->output_path, &out, stats, &result)) {
+        PDF_TRACE_END("chapter", chapter->output_path, span);
+        return result;
+    }
+
+    qpdf_out = qpdf_init();
+    if (qpdf_out == NULL) {
+        output_abort(&out);
+        PDF_TRACE_END("chapter", chapter->output_path, span);
+        return PDF_ERR_MEMORY;
+    }
+
+    qpdf_empty_pdf(qpdf_out);
+
+    /* Copy pages one by one in the chapter's order. A page listed twice
+     * is added again; QPDF makes it a copy sharing the same resources. */
+    start = stats_clock(stats);
+    while (result == PDF_OK && chapter_next_range(chapter, total_pages, &pos, &first, &last)) {
+        for (i = first; ; i += first <= last ? 1 : -1) {
+            if (pdf_cancel_requested(cancel)) {
+                result = PDF_ERR_CANCELLED;
+                break;
+            }
+            /* qpdf_in is the cached document: release the handle now, not
+             * when the document is evicted */
+            page = qpdf_get_page_n(qpdf_in, i - 1);
+            qpdf_add_page(qpdf_out, qpdf_in, page, QPDF_FALSE);
+            qpdf_oh_release(qpdf_in, page);
+            progress_add(progress, 1);
+            copied++;
+            if (i == last) break;
+        }
+    }
+    stats_phase(stats, PDF_PHASE_COPY, start);
+    stats_add(stats, STAT_PAGES, copied);
+
+    if (result == PDF_OK && pdf_cancel_requested(cancel)) {
+        result = PDF_ERR_CANCELLED;
+    }
+
+    /* Stream write next to the destination (low memory) */
+    if (result == PDF_OK) {
+        qpdf_init_write(qpdf_out, out.temp_path_a);
+        set_output_format(qpdf_out, format);
+        write_progress_begin(&wp, progress, qpdf_out, page_count);
+
+        start = stats_clock(stats);
+        if (qpdf_write(qpdf_out) >= 2) {
+            result = PDF_ERR_WRITE_FAILED;
+        } else {
+            write_progress_end(&wp);
+        }
+        stats_phase(stats, PDF_PHASE_WRITE, start);
+    }
+
+    qpdf_cleanup(&qpdf_out);
+
+    /* Rename over the final destination */
+    if (result == PDF_OK) {
+        output_commit(&out, &result);
+    } else {
+        output_abort(&out);
+    }
+    PDF_TRACE_END("chapter", chapter->output_path, span);
+    return result;
+}
+
+/* ==================== Parallel split ==================== */
+
+/*
+ * Each worker parses its own qpdf handle from the shared read-only mapping,
+ * so a qpdf_data is only ever touched by one thread. Worker 0 reuses the
+ * document the caller already parsed.
+ */
+typedef struct split_ctx {
+    const pdf_source_t* src;        /* shared mapping of the input */
+    const pdf_split_chapter_t* chapters;
+    pdf_error_t* results;
+    int chapter_count;
+    int total_pages;
+    qpdf_data* docs;                /* per worker, NULL until first task */
+    pdf_error_t* doc_errors;        /* per worker read error */
+    pdf_progress_cb progress_cb;
+    void* user_data;
+    const output_format_t* format;
+    const pdf_cancel_t* cancel;
+    progress_tracker_t* progress;
+} split_ctx_t;
+
+static void split_run_task(int index, int worker, void* ctx)
+{
+    split_ctx_t* split = (split_ctx_t*)ctx;
+
+    /* Queued chapters drain quickly once cancelled */
+    if (pdf_cancel_requested(split->cancel)) {
+        split->results[index] = PDF_ERR_CANCELLED;
+        return;
+    }
+
+    if (split->docs[worker] == NULL && split->doc_errors[worker] == PDF_OK) {
+        op_stats_t* stats = split->progress->stats;
+        LONGLONG start = stats_clock(stats);
+        split->docs[worker] = source_reopen(split->src, &split->doc_errors[worker]);
+        stats_phase(stats, PDF_PHASE_READ, start);
+        if (split->docs[worker]) stats_add(stats, STAT_BYTES_READ, (LONGLONG)split->src->map.size);
+    }
+
+    if (split->doc_errors[worker] != PDF_OK) {
+        split->results[index] = split->doc_errors[worker];
+        return;
+    }
+    split->results[index] = split_write_chapter(split->docs[worker], split->total_pages, &split->chapters[index],
+                                                split->format, split->cancel, split->progress);
+}
+
+static void split_task_done(int done_count, void* ctx)
+{
+    split_ctx_t* split = (split_ctx_t*)ctx;
+    if (split->progress_cb) {
+        split->progress_cb(done_count, split->chapter_count, split->user_data);
+    }
+}
+
+/*
+ * split_parallel - Write all chapters on a worker pool
+ * @param src parsed source; worker 0 uses src->qpdf, the others parse their own
+ * @return 1 if the pool ran, 0 if it could not be started
+ */
+static int split_parallel(pdf_source_t* src, int total_pages,
+                          const pdf_split_chapter_t* chapters, int chapter_count, pdf_error_t* results,
+                          int thread_count, const output_format_t* format, const pdf_cancel_t* cancel,
+                          progress_tracker_t* progress, pdf_progress_cb progress_cb, void* user_data)
+{
+    split_ctx_t ctx;
+    int i, workers, ok;
+
+    workers = pool_thread_count(chapter_count, thread_count);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.docs = (qpdf_data*)calloc((size_t)workers, sizeof(qpdf_data));
+    ctx.doc_errors = (pdf_error_t*)calloc((size_t)workers, sizeof(pdf_error_t));
+    if (!ctx.docs || !ctx.doc_errors) {
+        free(ctx.docs);
+        free(ctx.doc_errors);
+        return 0;
+    }
+
+    ctx.src = src;
+    ctx.chapters = chapters;
+    ctx.results = results;
+    ctx.chapter_count = chapter_count;
+    ctx.total_pages = total_pages;
+    ctx.progress_cb = progress_cb;
+    ctx.user_data = user_data;
+    ctx.format = format;
+    ctx.cancel = cancel;
+    ctx.progress = progress;
+    ctx.docs[0] = src->qpdf;
+
+    PDF_LOG(PDF_LOG_DEBUG, "Parallel split: %d workers", workers);
+
+    ok = run_parallel(chapter_count, workers, split_run_task, split_task_done, &ctx);
+
+    /* docs[0] belongs to the caller */
+    for (i = 1; i < workers; i++) {
+        if (ctx.docs[i]) qpdf_cleanup(&ctx.docs[i]);
+    }
+    free(ctx.docs);
+    free(ctx.doc_errors);
+    return ok;
+}
+
+void pdf_split_options_init(pdf_split_options_t* options)
+{
+    if (!options) return;
+    memset(options, 0, sizeof(*options));
+    options->mode = PDF_SPLIT_SERIAL;
+    options->profile = PDF_OUTPUT_COMPACT;
+}
+
+int pdf_split_batch_ex(const WCHAR* input_path, const pdf_split_chapter_t* chapters, int chapter_count,
+                       const pdf_split_options_t* options, pdf_error_t* results,
+                       pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error)
+{
+    pdf_document_t* doc;
+    pdf_split_options_t defaults;
+    progress_tracker_t progress;
+    output_format_t format;
+    op_stats_t op;
+    op_stats_t* stats;
+    LONGLONG span = PDF_TRACE_BEGIN();
+    long long split_pages = 0;
+    int i, total_pages, page_count, success = 0;
+    pdf_error_t input_error = PDF_OK;
+
+    if (!options) {
+        pdf_split_options_init(&defaults);
+        options = &defaults;
+    }
+    stats = op_stats_begin(&op, options->stats);
+    format.profile = options->profile;
+    format.linearize = options->linearize;
+    format.dedup = 0;
+    format.duplicates = PDF_DUPLICATES_KEEP;
+    format.duplicate_list = NULL;
+
+    SET_ERROR(error, PDF_OK);
+    for (i = 0; i < chapter_count; i++) {
+        results[i] = PDF_OK;
+    }
+
+    PDF_LOG(PDF_LOG_INFO, "=== SPLIT START: chapter_count=%d, mode=%d ===", chapter_count, (int)options->mode);
+
+    if (chapter_count <= 0) {
+        op_stats_end(stats);
+        PDF_TRACE_END("split", input_path, span);
+        return 0;
+    }
+    if (pdf_cancel_requested(options->cancel)) {
+        input_error = PDF_ERR_CANCELLED;
+        goto input_failed;
+    }
+
+    /* Parse the input once (or reuse the cached parse), then emit every
+     * chapter from it */
+    doc = document_open(input_path, stats, &input_error);
+    if (!doc) {
+        goto input_failed;
+    }
+    AcquireSRWLockExclusive(&doc->use_lock);
+
+    total_pages = qpdf_get_num_pages(doc->src.qpdf);
+
+    /* Pages of the valid chapters; bytes are the input share of those pages */
+    for (i = 0; i < chapter_count; i++) {
+        if (chapter_page_count(&chapters[i], total_pages, &page_count) == PDF_OK) {
+            split_pages += page_count;
+        }
+    }
+    progress_init(&progress, options->page_progress, user_data, options->progress_interval_ms, split_pages,
+                  total_pages > 0 ? (unsigned long long)((double)doc->src.map.size * split_pages / total_pages) : 0);
+    progress.stats = stats;
+
+    if (options->mode == PDF_SPLIT_PARALLEL && chapter_count > 1 &&
+        pool_thread_count(chapter_count, options->thread_count) > 1) {
+        if (!split_parallel(&doc->src, total_pages, chapters, chapter_count, results, options->thread_count,
+                            &format, options->cancel, &progress, progress_cb, user_data)) {
+            PDF_LOG(PDF_LOG_ERROR, "failed to start worker threads");
+            ReleaseSRWLockExclusive(&doc->use_lock);
+            pdf_document_close(doc);
+            input_error = PDF_ERR_MEMORY;
+            goto input_failed;
+        }
+    } else {
+        for (i = 0; i < chapter_count; i++) {
+            if (progress_cb) progress_cb(i + 1, chapter_count, user_data);
+            results[i] = split_write_chapter(doc->src.qpdf, total_pages, &chapters[i], &format,
+                                             options->cancel, &progress);
+        }
+    }
+
+    ReleaseSRWLockExclusive(&doc->use_lock);
+    pdf_document_close(doc);
+
+    for (i = 0; i < chapter_count; i++) {
+        if (results[i] == PDF_OK) {
+            success++;
+        } else {
+            if (results[i] == PDF_ERR_CANCELLED) SET_ERROR(error, PDF_ERR_CANCELLED);
+            PDF_LOG(PDF_LOG_ERROR, "chapter %d failed (%d)", i, (int)results[i]);
+        }
+    }
+
+    PDF_LOG(PDF_LOG_INFO, "=== SPLIT END: %d/%d ===", success, chapter_count);
+    op_stats_end(stats);
+    PDF_TRACE_END("split", input_path, span);
+    return success;
+
+input_failed:
+    /* Input problems fail every chapter with the same error */
+    SET_ERROR(error, input_error);
+    for (i = 0; i < chapter_count; i++) {
+        results[i] = input_error;
+    }
+    PDF_LOG(PDF_LOG_INFO, "=== SPLIT END (INPUT FAILED) ===");
+    op_stats_end(stats);
+    PDF_TRACE_END("split", input_path, span);
+    return 0;
+}
+
+int pdf_split_batch(const WCHAR* input_path, const pdf_split_chapter_t* chapters, int chapter_count,
+                    pdf_error_t* results, pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error)
+{
+    return pdf_split_batch_ex(input_path, chapters, chapter_count, NULL, results,
+                              progress_cb, user_data, error);
+}
+
+int pdf_split(const WCHAR* input_path, const WCHAR* output_path, int start_page, int end_page, pdf_error_t* error)
+{
+    pdf_split_chapter_t chapter;
+    pdf_error_t result = PDF_OK;
+
+    chapter.output_path = output_path;
+    chapter.start_page = start_page;
+    chapter.end_page = end_page;
+    chapter.pages = NULL;
+
+    if (pdf_split_batch(input_path, &chapter, 1, &result, NULL, NULL, NULL) == 1) {
+        SET_ERROR(error, PDF_OK);
+        return 1;
+    }
+    SET_ERROR(error, result);
+    return 0;
+}
+
+/*
+ * pdf_merge_two - Merge exactly 2 PDF files (internal function)
+ * Keeps the 2 inputs and the output document in memory
+ * @param cancel checked between pages and before the write (can be NULL)
+ * @param which_failed: 0=none, 1=first file, 2=second file, 3=output
+ */
+static int pdf_merge_two(const WCHAR* path1, const WCHAR* path2, const WCHAR* output_path,
+                         const output_format_t* format, const pdf_cancel_t* cancel, progress_tracker_t* progress,
+                         pdf_error_t* error, int* which_failed)
+{
+    atomic_output_t out;
+    write_progress_t wp;
+    pdf_source_t src1, src2;
+    qpdf_data qpdf_out = NULL;
+    qpdf_oh page;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start, span = PDF_TRACE_BEGIN();
+    int i, page_count, out_pages = 0, written = 0, result = 0;
+    pdf_error_t local_error = PDF_OK;
+
+    if (which_failed) *which_failed = 0;
+    memset(&src1, 0, sizeof(src1));
+    memset(&src2, 0, sizeof(src2));
+    memset(&out, 0, sizeof(out));
+    src1.map.file = src2.map.file = INVALID_HANDLE_VALUE;
+
+    PDF_LOG(PDF_LOG_DEBUG, "pdf_merge_two: start");
+
+    if (pdf_cancel_requested(cancel)) {
+        local_error = PDF_ERR_CANCELLED;
+        goto cleanup;
+    }
+
+    /* Output goes to a temp file next to the destination */
+    if (!output_begin(output_path, &out, stats, &local_error)) {
+        PDF_LOG(PDF_LOG_ERROR, "failed to create output temp file");
+        if (which_failed) *which_failed = 3;
+        goto cleanup;
+    }
+
+    /* Map and read both PDFs */
+    if (!source_open(path1, &src1, stats, &local_error)) {
+        PDF_LOG(PDF_LOG_ERROR, "open path1 failed");
+        if (which_failed) *which_failed = 1;
+        goto cleanup;
+    }
+    if (pdf_cancel_requested(cancel)) {
+        local_error = PDF_ERR_CANCELLED;
+        goto cleanup;
+    }
+    if (!source_open(path2, &src2, stats, &local_error)) {
+        PDF_LOG(PDF_LOG_ERROR, "open path2 failed");
+        if (which_failed) *which_failed = 2;
+        goto cleanup;
+    }
+
+    qpdf_out = qpdf_init();
+    if (!qpdf_out) {
+        PDF_LOG(PDF_LOG_ERROR, "qpdf_init failed");
+        local_error = PDF_ERR_MEMORY;
+        goto cleanup;
+    }
+
+    /* Create output and add pages */
+    qpdf_empty_pdf(qpdf_out);
+
+    /* Add pages from first PDF */
+    start = stats_clock(stats);
+    page_count = qpdf_get_num_pages(src1.qpdf);
+    progress_input_pages(progress, path1, page_count);
+    PDF_LOG(PDF_LOG_DEBUG, "Adding %d pages from file 1", page_count);
+    for (i = 0; i < page_count; i++) {
+        if (pdf_cancel_requested(cancel)) {
+            local_error = PDF_ERR_CANCELLED;
+            goto cleanup;
+        }
+        page = qpdf_get_page_n(src1.qpdf, i);
+        qpdf_add_page(qpdf_out, src1.qpdf, page, QPDF_FALSE);
+        qpdf_oh_release(src1.qpdf, page);
+        progress_add(progress, 1);
+        stats_add(stats, STAT_PAGES, 1);
+    }
+    out_pages += page_count;
+
+    /* Add pages from second PDF */
+    page_count = qpdf_get_num_pages(src2.qpdf);
+    progress_input_pages(progress, path2, page_count);
+    PDF_LOG(PDF_LOG_DEBUG, "Adding %d pages from file 2", page_count);
+    for (i = 0; i < page_count; i++) {
+        if (pdf_cancel_requested(cancel)) {
+            local_error = PDF_ERR_CANCELLED;
+            goto cleanup;
+        }
+        page = qpdf_get_page_n(src2.qpdf, i);
+        qpdf_add_page(qpdf_out, src2.qpdf, page, QPDF_FALSE);
+        qpdf_oh_release(src2.qpdf, page);
+        progress_add(progress, 1);
+        stats_add(stats, STAT_PAGES, 1);
+    }
+    out_pages += page_count;
+    stats_phase(stats, PDF_PHASE_COPY, start);
+
+    if (wants_dedup(format) && !dedup_output(qpdf_out, format, cancel, stats, &out_pages, &local_error)) {
+        goto cleanup;
+    }
+
+    /* Write output */
+    if (pdf_cancel_requested(cancel)) {
+        local_error = PDF_ERR_CANCELLED;
+        goto cleanup;
+    }
+    qpdf_init_write(qpdf_out, out.temp_path_a);
+    qpdf_set_static_ID(qpdf_out, QPDF_TRUE);
+    set_output_format(qpdf_out, format);
+    write_progress_begin(&wp, progress, qpdf_out, out_pages);
+
+    start = stats_clock(stats);
+    if (qpdf_write(qpdf_out) < 2) {
+        PDF_LOG(PDF_LOG_DEBUG, "qpdf_write OK");
+        write_progress_end(&wp);
+        written = 1;
+    } else {
+        PDF_LOG(PDF_LOG_ERROR, "qpdf_write failed");
+        local_error = PDF_ERR_WRITE_FAILED;
+        if (which_failed) *which_failed = 3;
+    }
+    stats_phase(stats, PDF_PHASE_WRITE, start);
+
+cleanup:
+    /* Release the inputs first: the output may replace one of them */
+    if (qpdf_out) qpdf_cleanup(&qpdf_out);
+    source_close(&src1);
+    source_close(&src2);
+
+    if (written) {
+        if (!output_commit(&out, &local_error)) {
+            if (which_failed) *which_failed = 3;
+        } else {
+            result = 1;
+        }
+    }
+    output_abort(&out);
+
+    SET_ERROR(error, local_error);
+
+    PDF_LOG(PDF_LOG_DEBUG, "pdf_merge_two: end, result=%d", result);
+    PDF_TRACE_END("merge two", output_path, span);
+
+    return result;
+}
+
+/*
+ * pdf_merge_single_pass - Merge N PDF files in one pass (internal function)
+ * Each input is mapped and parsed once, its pages are added once and the
+ * output is written once, so the work is linear in the total page count.
+ * All inputs stay open until qpdf_write(), because QPDF reads the stream
+ * data of copied pages from the source documents while writing.
+ *
+ * Progress: one step per input, plus a final step for the write.
+ * Cancellation is checked between inputs and pages; the write itself
+ * runs to completion once started.
+ */
+static int pdf_merge_single_pass(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+                                 const output_format_t* format, const pdf_cancel_t* cancel,
+                                 progress_tracker_t* progress,
+                                 pdf_progress_cb progress_cb, void* user_data,
+                                 pdf_error_t* error, int* failed_index)
+{
+    atomic_output_t out;
+    write_progress_t wp;
+    pdf_source_t* src = NULL;
+    qpdf_data qpdf_out = NULL;
+    qpdf_oh page;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start;
+    int i, j, page_count, out_pages = 0, opened = 0, written = 0, result = 0;
+    int total_steps = input_count + 1;
+    pdf_error_t local_error = PDF_OK;
+
+    PDF_LOG(PDF_LOG_DEBUG, "pdf_merge_single_pass: start");
+
+    memset(&out, 0, sizeof(out));
+    src = (pdf_source_t*)calloc((size_t)input_count, sizeof(*src));
+    if (!src) {
+        PDF_LOG(PDF_LOG_ERROR, "out of memory");
+        local_error = PDF_ERR_MEMORY;
+        goto cleanup;
+    }
+
+    if (!output_begin(output_path, &out, stats, &local_error)) {
+        PDF_LOG(PDF_LOG_ERROR, "failed to create output temp file");
+        goto cleanup;
+    }
+
+    qpdf_out = qpdf_init();
+    if (!qpdf_out) {
+        PDF_LOG(PDF_LOG_ERROR, "qpdf_init failed");
+        local_error = PDF_ERR_MEMORY;
+        goto cleanup;
+    }
+    qpdf_empty_pdf(qpdf_out);
+
+    for (i = 0; i < input_count; i++) {
+        if (progress_cb) progress_cb(i + 1, total_steps, user_data);
+        if (pdf_cancel_requested(cancel)) {
+            local_error = PDF_ERR_CANCELLED;
+            goto cleanup;
+        }
+
+        /* Map and parse the input in place */
+        if (!source_open(input_paths[i], &src[i], stats, &local_error)) {
+            PDF_LOG(PDF_LOG_ERROR, "open input %d failed", i);
+            if (failed_index) *failed_index = i;
+            goto cleanup;
+        }
+        opened = i + 1;
+
+        start = stats_clock(stats);
+        page_count = qpdf_get_num_pages(src[i].qpdf);
+        progress_input_pages(progress, input_paths[i], page_count);
+        PDF_LOG(PDF_LOG_DEBUG, "Adding %d pages from file %d", page_count, i);
+        for (j = 0; j < page_count; j++) {
+            if (pdf_cancel_requested(cancel)) {
+                local_error = PDF_ERR_CANCELLED;
+                goto cleanup;
+            }
+            page = qpdf_get_page_n(src[i].qpdf, j);
+            qpdf_add_page(qpdf_out, src[i].qpdf, page, QPDF_FALSE);
+            qpdf_oh_release(src[i].qpdf, page);
+            progress_add(progress, 1);
+            stats_add(stats, STAT_PAGES, 1);
+        }
+        stats_file_phase(stats, PDF_PHASE_COPY, start, input_paths[i]);
+        out_pages += page_count;
+    }
+
+    if (wants_dedup(format) && !dedup_output(qpdf_out, format, cancel, stats, &out_pages, &local_error)) {
+        goto cleanup;
+    }
+
+    /* Write output once */
+    if (progress_cb) progress_cb(total_steps, total_steps, user_data);
+    if (pdf_cancel_requested(cancel)) {
+        local_error = PDF_ERR_CANCELLED;
+        goto cleanup;
+    }
+    qpdf_init_write(qpdf_out, out.temp_path_a);
+    qpdf_set_static_ID(qpdf_out, QPDF_TRUE);
+    set_output_format(qpdf_out, format);
+    write_progress_begin(&wp, progress, qpdf_out, out_pages);
+
+    start = stats_clock(stats);
+    if (qpdf_write(qpdf_out) < 2) {
+        PDF_LOG(PDF_LOG_DEBUG, "qpdf_write OK");
+        write_progress_end(&wp);
+        written = 1;
+    } else {
+        PDF_LOG(PDF_LOG_ERROR, "qpdf_write failed");
+        local_error = PDF_ERR_WRITE_FAILED;
+    }
+    stats_phase(stats, PDF_PHASE_WRITE, start);
+
+cleanup:
+    /* Release the inputs first: the output may replace one of them */
+    if (qpdf_out) qpdf_cleanup(&qpdf_out);
+    for (i = 0; i < opened; i++) {
+        source_close(&src[i]);
+    }
+    free(src);
+
+    if (written && output_commit(&out, &local_error)) {
+        result = 1;
+    }
+    output_abort(&out);
+
+    SET_ERROR(error, local_error);
+
+    PDF_LOG(PDF_LOG_DEBUG, "pdf_merge_single_pass: end, result=%d", result);
+
+    return result;
+}
+
+/*
+ * pdf_merge_tree - Merge multiple PDF files as a balanced binary tree
+ * Adjacent pairs are merged concurrently, halving the list every round:
+ *
+ *   [A, B, C, D, E] ->
+ *   round 1: A + B -> t1, C + D -> t2, E carried over
+ *   round 2: t1 + t2 -> t3, E carried over
+ *   round 3: t3 + E -> output
+ *
+ * Every page is rewritten about log2(N) times instead of up to N times,
+ * and each pdf_merge_two() call owns its qpdf handles, so pairs can run
+ * on separate threads. Memory: 2 PDFs per worker thread.
+ *
+ * Progress: one step per pairwise merge (N - 1 in total), reported on
+ * the calling thread.
+ */
+typedef struct tree_item {
+    WCHAR path[MAX_PATH];
+    int source_index;           /* index into input_paths, -1 for temp files */
+} tree_item_t;
+
+typedef struct tree_task {
+    const tree_item_t* left;
+    const tree_item_t* right;
+    const WCHAR* output_path;
+    const output_format_t* format;  /* 최종 출력만 요청한 형식, 중간 결과는 intermediate_format */
+    int result;
+    pdf_error_t error;
+    int which_failed;
+} tree_task_t;
+
+typedef struct tree_ctx {
+    tree_task_t* tasks;
+    const pdf_cancel_t* cancel;
+    progress_tracker_t* progress;
+    pdf_progress_cb progress_cb;
+    void* user_data;
+    int steps_done;             /* pairwise merges finished in earlier rounds */
+    int total_steps;
+} tree_ctx_t;
+
+static void tree_run_task(int index, int worker, void* ctx)
+{
+    tree_ctx_t* tree = (tree_ctx_t*)ctx;
+    tree_task_t* task = &tree->tasks[index];
+    (void)worker;
+    task->result = pdf_merge_two(task->left->path, task->right->path, task->output_path, task->format,
+                                 tree->cancel, tree->progress, &task->error, &task->which_failed);
+}
+
+static void tree_task_done(int done_count, void* ctx)
+{
+    tree_ctx_t* tree = (tree_ctx_t*)ctx;
+    if (tree->progress_cb) {
+        tree->progress_cb(tree->steps_done + done_count, tree->total_steps, tree->user_data);
+    }
+}
+
+static int pdf_merge_tree(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+                          int thread_count, const output_format_t* format, const pdf_cancel_t* cancel,
+                          progress_tracker_t* progress,
+                          pdf_progress_cb progress_cb, void* user_data,
+                          pdf_error_t* error, int* failed_index)
+{
+    tree_item_t* items = NULL;
+    tree_item_t* next_items = NULL;
+    tree_item_t* swap;
+    tree_task_t* tasks = NULL;
+    tree_ctx_t ctx;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start;
+    int i, count, next_count, pair_count, round = 0, result = 0;
+    pdf_error_t local_error = PDF_OK;
+
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE START (TREE MODE) ===");
+
+    items = (tree_item_t*)calloc((size_t)input_count, sizeof(tree_item_t));
+    next_items = (tree_item_t*)calloc((size_t)input_count, sizeof(tree_item_t));
+    tasks = (tree_task_t*)calloc((size_t)input_count / 2, sizeof(tree_task_t));
+    if (!items || !next_items || !tasks) {
+        PDF_LOG(PDF_LOG_ERROR, "out of memory");
+        local_error = PDF_ERR_MEMORY;
+        goto cleanup;
+    }
+
+    for (i = 0; i < input_count; i++) {
+        if (wcslen(input_paths[i]) >= MAX_PATH) {
+            PDF_LOG(PDF_LOG_ERROR, "input %d: path too long", i);
+            local_error = PDF_ERR_INVALID_ARGUMENT;
+            if (failed_index) *failed_index = i;
+            goto cleanup;
+        }
+        wcscpy_s(items[i].path, MAX_PATH, input_paths[i]);
+        items[i].source_index = i;
+    }
+    count = input_count;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.tasks = tasks;
+    ctx.cancel = cancel;
+    ctx.progress = progress;
+    ctx.progress_cb = progress_cb;
+    ctx.user_data = user_data;
+    ctx.total_steps = input_count - 1;
+
+    while (count > 1) {
+        round++;
+        pair_count = count / 2;
+        next_count = pair_count + (count % 2);
+
+        PDF_LOG(PDF_LOG_DEBUG, "Round %d: %d items, %d pairs", round, count, pair_count);
+
+        /* Plan this round: pair i writes next_items[i] */
+        memset(next_items, 0, sizeof(tree_item_t) * (size_t)next_count);
+        for (i = 0; i < pair_count; i++) {
+            tasks[i].left = &items[2 * i];
+            tasks[i].right = &items[2 * i + 1];
+            tasks[i].result = 0;
+            tasks[i].error = PDF_OK;
+            tasks[i].which_failed = 0;
+            next_items[i].source_index = -1;
+
+            if (next_count == 1) {
+                tasks[i].output_path = output_path;
+                tasks[i].format = format;
+            } else {
+                start = stats_clock(stats);
+                if (!get_temp_file(next_items[i].path, L"tre")) {
+                    PDF_LOG(PDF_LOG_ERROR, "failed to create temp files");
+                    next_items[i].path[0] = L'\0';
+                    local_error = PDF_ERR_TEMP_FILE;
+                    goto round_cleanup;
+                }
+                stats_phase(stats, PDF_PHASE_TEMP, start);
+                tasks[i].output_path = next_items[i].path;
+                tasks[i].format = &intermediate_format;
+            }
         }
-
-        qpdf_empty_pdf(qpdf_out);
-
-        /* Copy pages one by one (0-indexed) */
-        for (i = start_page - 1; i < end_page; i++) {
-            page = qpdf_get_page_n(qpdf_in, i);
-            qpdf_add_page(qpdf_out, qpdf_in, page, QPDF_FALSE);
+        if (count % 2) {
+            next_items[next_count - 1] = items[count - 1];
         }
 
-        /* Stream write to file (low memory) */
-        qpdf_init_write(qpdf_out, temp_out_a);
-        qpdf_set_compress_streams(qpdf_out, QPDF_TRUE);
-        qpdf_set_object_stream_mode(qpdf_out, qpdf_o_generate);
+        if (!run_parallel(pair_count, thread_count, tree_run_task, tree_task_done, &ctx)) {
+            PDF_LOG(PDF_LOG_ERROR, "failed to start worker threads");
+            local_error = PDF_ERR_MEMORY;
+            goto round_cleanup;
+        }
+        ctx.steps_done += pair_count;
+
+        /* Report the first failing pair so failed_index stays deterministic */
+        for (i = 0; i < pair_count; i++) {
+            if (tasks[i].result) continue;
+            local_error = tasks[i].error;
+            if (failed_index) {
+                if (tasks[i].which_failed == 1) *failed_index = tasks[i].left->source_index;
+                else if (tasks[i].which_failed == 2) *failed_index = tasks[i].right->source_index;
+            }
+            PDF_LOG(PDF_LOG_ERROR, "round %d pair %d failed (which=%d)", round, i, tasks[i].which_failed);
+            goto round_cleanup;
+        }
 
-        if (qpdf_write(qpdf_out) < 2) {
-            result = 1;
-        } else {
-            SET_ERROR(error, PDF_ERR_WRITE_FAILED);
+        /* Outputs of this round are the next temp files; its inputs are consumed */
+        if (next_count > 1) {
+            for (i = 0; i < pair_count; i++) {
+                temp_track(stats, next_items[i].path);
+            }
         }
-    } else {
-        SET_ERROR(error, PDF_ERR_INVALID_PDF);
+        for (i = 0; i < count; i++) {
+            if (items[i].source_index < 0) temp_delete(stats, items[i].path);
+        }
+
+        swap = items;
+        items = next_items;
+        next_items = swap;
+        count = next_count;
     }
 
-    qpdf_cleanup(&qpdf_in);
-    qpdf_cleanup(&qpdf_out);
+    result = 1;
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE END (SUCCESS) ===");
+    goto cleanup;
 
-    /* Copy result to final destination */
-    if (result) {
-        if (!copy_file_w(temp_out, output_path)) {
-            DWORD err = GetLastError();
-            result = 0;
-            if (err == ERROR_ACCESS_DENIED) {
-                SET_ERROR(error, PDF_ERR_ACCESS_DENIED);
-            } else if (err == ERROR_DISK_FULL) {
-                SET_ERROR(error, PDF_ERR_WRITE_FAILED);
-            } else {
-                SET_ERROR(error, PDF_ERR_WRITE_FAILED);
-            }
-        }
+round_cleanup:
+    /* Temp files of the failed round (planned outputs and its inputs) */
+    for (i = 0; i < next_count; i++) {
+        if (next_items[i].source_index < 0 && next_items[i].path[0]) DeleteFileW(next_items[i].path);
+    }
+    for (i = 0; i < count; i++) {
+        if (items[i].source_index < 0) temp_delete(stats, items[i].path);
     }
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE END (FAILED) ===");
 
-    DeleteFileW(temp_in);
-    DeleteFileW(temp_out);
+cleanup:
+    free(tasks);
+    free(next_items);
+    free(items);
 
+    SET_ERROR(error, local_error);
     return result;
 }
 
+/* "1.7" -> 17, for picking the highest input version */
+static int pdf_version_value(const char* version)
+{
+    int major = 0, minor = 0;
+    if (!version || sscanf(version, "%d.%d", &major, &minor) < 1) return 0;
+    return major * 10 + minor;
+}
+
 /*
- * pdf_merge_two - Merge exactly 2 PDF files (internal function)
- * This keeps only 2 PDFs in memory at a time for low memory usage
- * @param which_failed: 0=none, 1=first file, 2=second file, 3=output
+ * pdf_merge_streaming - Merge multiple PDF files with bounded memory
+ * Each input is opened, its pages and everything they reference are
+ * written straight to the output file (pdf_writer), then it is closed
+ * before the next input is opened. Only one input is resident at a time;
+ * the writer keeps just the xref offsets and the page list.
+ *
+ * Output layout:
+ *   header, objects of input 1, ..., objects of input N,
+ *   page tree root (2), catalog (1), xref, trailer
+ *
+ * Progress: one step per input, plus a final step for the page tree/xref.
+ * The writer checks cancellation between objects, so a large input stops
+ * within one object rather than at the end of the input.
  */
-static int pdf_merge_two(const WCHAR* path1, const WCHAR* path2, const WCHAR* output_path,
-                         pdf_error_t* error, int* which_failed)
+static int pdf_merge_streaming(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+                               const pdf_cancel_t* cancel, progress_tracker_t* progress,
+                               pdf_progress_cb progress_cb, void* user_data,
+                               pdf_error_t* error, int* failed_index)
 {
-    WCHAR temp1[MAX_PATH], temp2[MAX_PATH], temp_out[MAX_PATH];
-    char temp1_a[MAX_PATH], temp2_a[MAX_PATH], temp_out_a[MAX_PATH];
-    qpdf_data qpdf1 = NULL, qpdf2 = NULL, qpdf_out = NULL;
-    int i, page_count, result = 0;
-    char buf[128];
+    atomic_output_t target;
+    char version[8];
+    char trailer[128];
+    FILE* out = NULL;
+    pdf_writer_t* writer = NULL;
+    pdf_source_t src;
+    qpdf_data qpdf_in = NULL;
+    int* kids = NULL;
+    int kid_count = 0, kid_cap = 0;
+    int catalog_num, pages_num;
+    int i, j, page_count, page_num, max_version = 14, result = 0;
+    int total_steps = input_count + 1;
+    unsigned long long digest;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start;
     pdf_error_t local_error = PDF_OK;
 
-    if (which_failed) *which_failed = 0;
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE START (STREAMING MODE) ===");
 
-    log_msg("pdf_merge_two: start");
+    memset(&src, 0, sizeof(src));
+    src.map.file = INVALID_HANDLE_VALUE;
+    if (!output_begin(output_path, &target, stats, &local_error)) {
+        PDF_LOG(PDF_LOG_ERROR, "failed to create output temp file");
+        SET_ERROR(error, local_error);
+        return 0;
+    }
 
-    /* Create temp files */
-    if (!get_temp_file(temp1, L"pm1") || !get_temp_file(temp2, L"pm2") || !get_temp_file(temp_out, L"pmo")) {
-        log_msg("ERROR: failed to create temp files");
-        local_error = PDF_ERR_TEMP_FILE;
+    out = _wfopen(target.temp_path, L"wb");
+    if (!out) {
+        PDF_LOG(PDF_LOG_ERROR, "failed to open output");
+        local_error = PDF_ERR_WRITE_FAILED;
         goto cleanup;
     }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
 
-    /* Copy inputs to temp */
-    if (!copy_file_w(path1, temp1)) {
-        log_msg("ERROR: copy path1 failed");
-        DWORD err = GetLastError();
-        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
-            local_error = PDF_ERR_FILE_NOT_FOUND;
-        } else if (err == ERROR_ACCESS_DENIED || err == ERROR_SHARING_VIOLATION) {
-            local_error = PDF_ERR_ACCESS_DENIED;
-        } else {
-            local_error = PDF_ERR_UNKNOWN;
-        }
-        if (which_failed) *which_failed = 1;
+    writer = pdf_writer_create(out, 0, 1);
+    if (!writer) {
+        local_error = PDF_ERR_MEMORY;
         goto cleanup;
     }
-    if (!copy_file_w(path2, temp2)) {
-        log_msg("ERROR: copy path2 failed");
-        DWORD err = GetLastError();
-        if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
-            local_error = PDF_ERR_FILE_NOT_FOUND;
-        } else if (err == ERROR_ACCESS_DENIED || err == ERROR_SHARING_VIOLATION) {
-            local_error = PDF_ERR_ACCESS_DENIED;
-        } else {
-            local_error = PDF_ERR_UNKNOWN;
+    pdf_writer_set_cancel(writer, cancel);
+    catalog_num = pdf_writer_reserve(writer);
+    pages_num = pdf_writer_reserve(writer);
+
+    /* Version is patched once every input has been seen */
+    pdf_writer_printf(writer, "%%PDF-1.4\n%%\xE2\xE3\xCF\xD3\n");
+
+    for (i = 0; i < input_count; i++) {
+        if (progress_cb) progress_cb(i + 1, total_steps, user_data);
+        if (pdf_cancel_requested(cancel)) {
+            local_error = PDF_ERR_CANCELLED;
+            goto cleanup;
         }
-        if (which_failed) *which_failed = 2;
-        goto cleanup;
-    }
 
-    wchar_to_utf8(temp1, temp1_a, MAX_PATH);
-    wchar_to_utf8(temp2, temp2_a, MAX_PATH);
-    wchar_to_utf8(temp_out, temp_out_a, MAX_PATH);
+        /* Map and parse the input in place */
+        if (!source_open(input_paths[i], &src, stats, &local_error)) {
+            PDF_LOG(PDF_LOG_ERROR, "open input %d failed", i);
+            if (failed_index) *failed_index = i;
+            goto cleanup;
+        }
+        qpdf_in = src.qpdf;
+        start = stats_clock(stats);
 
-    /* Initialize QPDF objects */
-    qpdf1 = qpdf_init();
-    qpdf2 = qpdf_init();
-    qpdf_out = qpdf_init();
+        if (pdf_version_value(qpdf_get_pdf_version(qpdf_in)) > max_version) {
+            max_version = pdf_version_value(qpdf_get_pdf_version(qpdf_in));
+        }
 
-    if (!qpdf1 || !qpdf2 || !qpdf_out) {
-        log_msg("ERROR: qpdf_init failed");
-        local_error = PDF_ERR_MEMORY;
-        goto cleanup;
-    }
+        /* Pages must carry their own /Resources, /MediaBox, ... */
+        qpdf_push_inherited_attributes_to_page(qpdf_in);
 
-    /* Read both PDFs */
-    if (qpdf_read(qpdf1, temp1_a, NULL) >= 2) {
-        log_msg("ERROR: qpdf_read path1 failed");
-        local_error = PDF_ERR_INVALID_PDF;
-        if (which_failed) *which_failed = 1;
-        goto cleanup;
-    }
-    if (qpdf_read(qpdf2, temp2_a, NULL) >= 2) {
-        log_msg("ERROR: qpdf_read path2 failed");
-        local_error = PDF_ERR_INVALID_PDF;
-        if (which_failed) *which_failed = 2;
-        goto cleanup;
-    }
+        page_count = qpdf_get_num_pages(qpdf_in);
+        PDF_LOG(PDF_LOG_DEBUG, "Streaming %d pages from file %d", page_count, i);
 
-    /* Create output and add pages */
-    qpdf_empty_pdf(qpdf_out);
+        if (kid_count + page_count > kid_cap) {
+            int new_cap = kid_cap ? kid_cap : 256;
+            int* grown;
+            while (new_cap < kid_count + page_count) new_cap *= 2;
+            grown = (int*)realloc(kids, (size_t)new_cap * sizeof(int));
+            if (!grown) {
+                local_error = PDF_ERR_MEMORY;
+                goto cleanup;
+            }
+            kids = grown;
+            kid_cap = new_cap;
+        }
 
-    /* Add pages from first PDF */
-    page_count = qpdf_get_num_pages(qpdf1);
-    sprintf(buf, "Adding %d pages from file 1", page_count);
-    log_msg(buf);
-    for (i = 0; i < page_count; i++) {
-        qpdf_add_page(qpdf_out, qpdf1, qpdf_get_page_n(qpdf1, i), QPDF_FALSE);
-    }
+        pdf_writer_begin_source(writer, qpdf_in);
+        for (j = 0; j < page_count; j++) {
+            qpdf_oh page;
+            if (pdf_cancel_requested(cancel)) {
+                local_error = PDF_ERR_CANCELLED;
+                goto cleanup;
+            }
+            page = qpdf_get_page_n(qpdf_in, (size_t)j);
+            page_num = pdf_writer_add_page(writer, page, pages_num);
+            qpdf_oh_release(qpdf_in, page);
+            if (!page_num) break;
+            kids[kid_count++] = page_num;
+            progress_add(progress, 1);
+            stats_add(stats, STAT_PAGES, 1);
+        }
 
-    /* Add pages from second PDF */
-    page_count = qpdf_get_num_pages(qpdf2);
-    sprintf(buf, "Adding %d pages from file 2", page_count);
-    log_msg(buf);
-    for (i = 0; i < page_count; i++) {
-        qpdf_add_page(qpdf_out, qpdf2, qpdf_get_page_n(qpdf2, i), QPDF_FALSE);
+        if (!pdf_writer_flush(writer)) {
+            PDF_LOG(PDF_LOG_ERROR, "writing objects of input %d failed", i);
+            /* Object access errors are the input's fault, I/O errors are ours */
+            if (pdf_cancel_requested(cancel)) {
+                local_error = PDF_ERR_CANCELLED;
+            } else if (qpdf_has_error(qpdf_in)) {
+                local_error = PDF_ERR_INVALID_PDF;
+                if (failed_index) *failed_index = i;
+            } else {
+                local_error = PDF_ERR_WRITE_FAILED;
+            }
+            goto cleanup;
+        }
+
+        progress_add(progress, page_count);
+        stats_file_phase(stats, PDF_PHASE_COPY, start, input_paths[i]);
+
+        /* Release this input before opening the next one */
+        source_close(&src);
+        qpdf_in = NULL;
     }
 
-    /* Write output */
-    qpdf_init_write(qpdf_out, temp_out_a);
-    qpdf_set_static_ID(qpdf_out, QPDF_TRUE);
+    if (progress_cb) progress_cb(total_steps, total_steps, user_data);
+    start = stats_clock(stats);
 
-    if (qpdf_write(qpdf_out) < 2) {
-        log_msg("qpdf_write OK");
-        if (!copy_file_w(temp_out, output_path)) {
-            local_error = PDF_ERR_WRITE_FAILED;
-            if (which_failed) *which_failed = 3;
-        } else {
-            result = 1;
-        }
-    } else {
-        log_msg("ERROR: qpdf_write failed");
+    /* Page tree: flat root holding every page */
+    pdf_writer_begin_object(writer, pages_num);
+    pdf_writer_printf(writer, "<< /Type /Pages /Count %d /Kids [", kid_count);
+    for (j = 0; j < kid_count; j++) {
+        pdf_writer_printf(writer, (j % 16 == 15) ? "%d 0 R\n" : "%d 0 R ", kids[j]);
+    }
+    pdf_writer_printf(writer, "] >>");
+    pdf_writer_end_object(writer);
+
+    pdf_writer_begin_object(writer, catalog_num);
+    pdf_writer_printf(writer, "<< /Type /Catalog /Pages %d 0 R >>", pages_num);
+    pdf_writer_end_object(writer);
+
+    digest = pdf_writer_digest(writer);
+    sprintf(trailer, "/Root %d 0 R /ID [<%016llX%016llX><%016llX%016llX>]",
+            catalog_num, digest, (unsigned long long)kid_count, digest, (unsigned long long)kid_count);
+    pdf_writer_write_xref(writer, 0, trailer, 1);
+
+    sprintf(version, "%d.%d", max_version / 10, max_version % 10);
+    pdf_writer_patch(writer, 5, version, 3);
+
+    i = pdf_writer_failed(writer);
+    if (fclose(out) != 0) i = 1;
+    out = NULL;
+    stats_phase(stats, PDF_PHASE_WRITE, start);
+    if (i) {
+        PDF_LOG(PDF_LOG_ERROR, "writing output failed");
         local_error = PDF_ERR_WRITE_FAILED;
-        if (which_failed) *which_failed = 3;
+        goto cleanup;
     }
 
-cleanup:
-    if (qpdf1) qpdf_cleanup(&qpdf1);
-    if (qpdf2) qpdf_cleanup(&qpdf2);
-    if (qpdf_out) qpdf_cleanup(&qpdf_out);
-    DeleteFileW(temp1);
-    DeleteFileW(temp2);
-    DeleteFileW(temp_out);
+    if (!output_commit(&target, &local_error)) {
+        goto cleanup;
+    }
 
-    SET_ERROR(error, local_error);
+    result = 1;
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE END (SUCCESS) ===");
 
-    sprintf(buf, "pdf_merge_two: end, result=%d", result);
-    log_msg(buf);
+cleanup:
+    source_close(&src);
+    pdf_writer_destroy(writer);
+    if (out) fclose(out);
+    output_abort(&target);
+    free(kids);
 
+    SET_ERROR(error, local_error);
     return result;
 }
 
 /*
- * pdf_merge - Merge multiple PDF files using sequential merge
- * Memory usage: Only 2 PDFs in memory at any time
+ * pdf_merge_sequential - Merge multiple PDF files using sequential merge
+ * Memory usage: 2 PDFs at a time, but the first one is the accumulated
+ * output, so it grows to the full merged document (use streaming mode for
+ * a real bound)
  *
  * Algorithm:
  *   [A, B, C, D, E] ->
@@ -398,49 +2576,32 @@ cleanup:
  *   temp2 + D -> temp1
  *   temp1 + E -> output
  */
-int pdf_merge(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
-              pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index)
+static int pdf_merge_sequential(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+                                const output_format_t* format, const pdf_cancel_t* cancel,
+                                progress_tracker_t* progress,
+                                pdf_progress_cb progress_cb, void* user_data,
+                                pdf_error_t* error, int* failed_index)
 {
     WCHAR temp1[MAX_PATH], temp2[MAX_PATH];
     WCHAR* current;
     WCHAR* next;
+    op_stats_t* stats = progress->stats;
+    LONGLONG start;
     int i, result = 0;
     int total_steps;
-    char buf[128];
     int which_failed = 0;
 
-    SET_ERROR(error, PDF_OK);
-    if (failed_index) *failed_index = -1;
-
-    log_msg("=== MERGE START (SEQUENTIAL MODE) ===");
-    sprintf(buf, "input_count: %d", input_count);
-    log_msg(buf);
-
-    if (input_count <= 0) {
-        log_msg("ERROR: invalid input_count");
-        SET_ERROR(error, PDF_ERR_UNKNOWN);
-        return 0;
-    }
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE START (SEQUENTIAL MODE) ===");
 
     /* Calculate total steps: (input_count - 1) merges */
-    total_steps = (input_count > 1) ? (input_count - 1) : 1;
-
-    /* Single file: just copy */
-    if (input_count == 1) {
-        log_msg("Single file, copying...");
-        if (progress_cb) progress_cb(1, 1, user_data);
-        if (!copy_file_w(input_paths[0], output_path)) {
-            SET_ERROR(error, PDF_ERR_WRITE_FAILED);
-            return 0;
-        }
-        return 1;
-    }
+    total_steps = input_count - 1;
 
     /* Two files: direct merge */
     if (input_count == 2) {
-        log_msg("Two files, direct merge...");
+        PDF_LOG(PDF_LOG_DEBUG, "Two files, direct merge...");
         if (progress_cb) progress_cb(1, 1, user_data);
-        result = pdf_merge_two(input_paths[0], input_paths[1], output_path, error, &which_failed);
+        result = pdf_merge_two(input_paths[0], input_paths[1], output_path, format, cancel, progress,
+                               error, &which_failed);
         if (!result && which_failed > 0 && which_failed <= 2 && failed_index) {
             *failed_index = which_failed - 1;  /* Convert to 0-based index */
         }
@@ -448,31 +2609,33 @@ int pdf_merge(const WCHAR** input_paths, int input_count, const WCHAR* output_pa
     }
 
     /* 3+ files: sequential merge */
-    log_msg("Multiple files, sequential merge...");
+    PDF_LOG(PDF_LOG_DEBUG, "Multiple files, sequential merge...");
 
     /* Create temp file paths */
+    start = stats_clock(stats);
     if (!get_temp_file(temp1, L"seq") || !get_temp_file(temp2, L"seq")) {
-        log_msg("ERROR: failed to create temp files");
+        PDF_LOG(PDF_LOG_ERROR, "failed to create temp files");
         SET_ERROR(error, PDF_ERR_TEMP_FILE);
         return 0;
     }
+    stats_phase(stats, PDF_PHASE_TEMP, start);
 
     /* First merge: input[0] + input[1] -> temp1 */
-    sprintf(buf, "Step 1: merging files 0 and 1");
-    log_msg(buf);
+    PDF_LOG(PDF_LOG_DEBUG, "Step 1: merging files 0 and 1");
     if (progress_cb) progress_cb(1, total_steps, user_data);
-    if (!pdf_merge_two(input_paths[0], input_paths[1], temp1, error, &which_failed)) {
-        log_msg("ERROR: first merge failed");
+    if (!pdf_merge_two(input_paths[0], input_paths[1], temp1, &intermediate_format, cancel, progress,
+                       error, &which_failed)) {
+        PDF_LOG(PDF_LOG_ERROR, "first merge failed");
         if (which_failed > 0 && which_failed <= 2 && failed_index) {
             *failed_index = which_failed - 1;  /* 0 or 1 */
         }
         goto fail;
     }
+    temp_track(stats, temp1);
 
     /* Sequential merge: temp + input[i] -> next_temp */
     for (i = 2; i < input_count; i++) {
-        sprintf(buf, "Step %d: merging with file %d", i, i);
-        log_msg(buf);
+        PDF_LOG(PDF_LOG_DEBUG, "Step %d: merging with file %d", i, i);
 
         /* Report progress */
         if (progress_cb) progress_cb(i, total_steps, user_data);
@@ -483,39 +2646,488 @@ int pdf_merge(const WCHAR** input_paths, int input_count, const WCHAR* output_pa
 
         /* Last file: output to final destination */
         if (i == input_count - 1) {
-            if (!pdf_merge_two(current, input_paths[i], output_path, error, &which_failed)) {
-                log_msg("ERROR: final merge failed");
+            if (!pdf_merge_two(current, input_paths[i], output_path, format, cancel, progress,
+                               error, &which_failed)) {
+                PDF_LOG(PDF_LOG_ERROR, "final merge failed");
                 if (which_failed == 2 && failed_index) {
                     *failed_index = i;  /* The current input file */
                 }
                 goto fail;
             }
         } else {
-            if (!pdf_merge_two(current, input_paths[i], next, error, &which_failed)) {
-                log_msg("ERROR: intermediate merge failed");
+            if (!pdf_merge_two(current, input_paths[i], next, &intermediate_format, cancel, progress,
+                               error, &which_failed)) {
+                PDF_LOG(PDF_LOG_ERROR, "intermediate merge failed");
                 if (which_failed == 2 && failed_index) {
                     *failed_index = i;  /* The current input file */
                 }
                 goto fail;
             }
+            temp_track(stats, next);
         }
 
         /* Delete the temp file we just used as input */
-        DeleteFileW(current);
+        temp_delete(stats, current);
     }
 
     result = 1;
     if (progress_cb) progress_cb(total_steps, total_steps, user_data);
-    log_msg("=== MERGE END (SUCCESS) ===");
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE END (SUCCESS) ===");
 
     /* Cleanup remaining temp files */
-    DeleteFileW(temp1);
-    DeleteFileW(temp2);
+    temp_delete(stats, temp1);
+    temp_delete(stats, temp2);
     return result;
 
 fail:
-    log_msg("=== MERGE END (FAILED) ===");
-    DeleteFileW(temp1);
-    DeleteFileW(temp2);
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE END (FAILED) ===");
+    temp_delete(stats, temp1);
+    temp_delete(stats, temp2);
     return 0;
 }
+
+/*
+ * merge_progress_init - Size a page progress tracker for a merge
+ * Page counts come from pdf_get_file_info() (index or tail scan, no full
+ * parse). Sequential and tree modes rewrite pages, so their totals are the
+ * pages of every intermediate output.
+ */
+static void merge_progress_init(progress_tracker_t* t, const pdf_merge_options_t* options, void* user_data,
+                                const WCHAR** input_paths, int input_count)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attr;
+    pdf_file_info_t info;
+    long long* pages;
+    long long input_pages = 0, total = 0;
+    unsigned long long input_bytes = 0;
+    int i, count;
+
+    if (!options->page_progress) {
+        progress_init(t, NULL, NULL, 0, 0, 0);
+        return;
+    }
+
+    pages = (long long*)calloc((size_t)input_count, sizeof(long long));
+    for (i = 0; i < input_count; i++) {
+        if (get_file_info(input_paths[i], &info, options->cancel, NULL, NULL) && pages) {
+            pages[i] = info.page_count;
+            input_pages += info.page_count;
+        }
+        if (GetFileAttributesExW(input_paths[i], GetFileExInfoStandard, &attr)) {
+            input_bytes += ((unsigned long long)attr.nFileSizeHigh << 32) | attr.nFileSizeLow;
+        }
+    }
+
+    if (!pages || options->mode == PDF_MERGE_SINGLE_PASS || options->mode == PDF_MERGE_STREAMING) {
+        total = input_pages;
+    } else if (options->mode == PDF_MERGE_SEQUENTIAL) {
+        long long acc = pages[0];
+        for (i = 1; i < input_count; i++) {
+            acc += pages[i];
+            total += acc;
+        }
+    } else {
+        /* Tree: pair outputs of every round, folded in place */
+        for (count = input_count; count > 1; count = (count + 1) / 2) {
+            for (i = 0; i < count / 2; i++) {
+                pages[i] = pages[2 * i] + pages[2 * i + 1];
+                total += pages[i];
+            }
+            if (count % 2) pages[count / 2] = pages[count - 1];
+        }
+    }
+    free(pages);
+
+    progress_init(t, options->page_progress, user_data, options->progress_interval_ms, total,
+                  input_pages > 0 ? (unsigned long long)((double)input_bytes * total / input_pages) : 0);
+}
+
+/* Merged position (1-based) -> input index and page within that input */
+static void position_to_input(const long long* ends, int input_count, int* input_index, int* page)
+{
+    int i = 0;
+    while (i < input_count - 1 && *page > ends[i]) i++;
+    *page -= (int)(i > 0 ? ends[i - 1] : 0);
+    *input_index = i;
+}
+
+/*
+ * dedup_output() lists duplicate pages by position in the merged
+ * document; map them to the inputs with the page counts QPDF found for
+ * each input while merging (progress_input_pages).
+ */
+static void duplicates_to_inputs(pdf_duplicate_list_t* list, const int* input_pages, int input_count)
+{
+    long long* ends;
+    int i, n;
+
+    if (!list || !list->pages || list->count == 0 || !input_pages) return;
+    ends = (long long*)calloc((size_t)input_count, sizeof(long long));
+    if (!ends) return;
+    for (i = 0; i < input_count; i++) {
+        ends[i] = (i > 0 ? ends[i - 1] : 0) + (input_pages[i] > 0 ? input_pages[i] : 0);
+    }
+
+    n = list->count < list->capacity ? list->count : list->capacity;
+    for (i = 0; i < n; i++) {
+        position_to_input(ends, input_count, &list->pages[i].input_index, &list->pages[i].page);
+        position_to_input(ends, input_count, &list->pages[i].first_input_index, &list->pages[i].first_page);
+    }
+    free(ends);
+}
+
+void pdf_merge_options_init(pdf_merge_options_t* options)
+{
+    if (!options) return;
+    memset(options, 0, sizeof(*options));
+    options->mode = PDF_MERGE_SINGLE_PASS;
+}
+
+int pdf_merge_ex(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+                 const pdf_merge_options_t* options,
+                 pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index)
+{
+    pdf_merge_options_t defaults;
+    progress_tracker_t progress;
+    output_format_t format;
+    pdf_merge_mode_t mode;
+    op_stats_t op;
+    op_stats_t* stats;
+    LONGLONG start, span = PDF_TRACE_BEGIN();
+    int result;
+
+    SET_ERROR(error, PDF_OK);
+    if (failed_index) *failed_index = -1;
+
+    if (!options) {
+        pdf_merge_options_init(&defaults);
+        options = &defaults;
+    }
+
+    stats = op_stats_begin(&op, options->stats);
+    PDF_LOG(PDF_LOG_INFO, "=== MERGE: input_count=%d, mode=%d ===", input_count, (int)options->mode);
+
+    if (input_count <= 0) {
+        PDF_LOG(PDF_LOG_ERROR, "invalid input_count");
+        SET_ERROR(error, PDF_ERR_UNKNOWN);
+        op_stats_end(stats);
+        PDF_TRACE_END("merge", output_path, span);
+        return 0;
+    }
+    if (pdf_cancel_requested(options->cancel)) {
+        SET_ERROR(error, PDF_ERR_CANCELLED);
+        op_stats_end(stats);
+        PDF_TRACE_END("merge", output_path, span);
+        return 0;
+    }
+
+    format.profile = options->profile;
+    format.linearize = options->linearize;
+    format.dedup = options->dedup;
+    format.duplicates = options->duplicates;
+    format.duplicate_list = options->duplicate_list;
+    if (format.duplicate_list) format.duplicate_list->count = 0;
+    mode = options->mode;
+    if (format.linearize && mode == PDF_MERGE_STREAMING) {
+        /* The streaming writer cannot lay out hint tables; QPDF has to write the file */
+        PDF_LOG(PDF_LOG_WARN, "linearized output: streaming mode falls back to single pass");
+        mode = PDF_MERGE_SINGLE_PASS;
+    }
+    if (wants_dedup(&format) && mode == PDF_MERGE_STREAMING) {
+        /* Objects are written as soon as they are reached; dedup needs the whole document */
+        PDF_LOG(PDF_LOG_WARN, "dedup: streaming mode falls back to single pass");
+        mode = PDF_MERGE_SINGLE_PASS;
+    }
+
+    /* Single file: just copy (next to the destination, then rename) */
+    if (input_count == 1 && !format.linearize && !wants_dedup(&format)) {
+        atomic_output_t out;
+        PDF_LOG(PDF_LOG_DEBUG, "Single file, copying...");
+        if (progress_cb) progress_cb(1, 1, user_data);
+        result = 0;
+        if (output_begin(output_path, &out, stats, error)) {
+            start = stats_clock(stats);
+            if (copy_file_w(input_paths[0], out.temp_path, options->cancel, error)) {
+                stats_phase(stats, PDF_PHASE_WRITE, start);
+                stats_add(stats, STAT_BYTES_READ, (LONGLONG)file_size_w(input_paths[0]));
+                result = output_commit(&out, error);
+            } else {
+                if (failed_index && !pdf_cancel_requested(options->cancel)) *failed_index = 0;
+                output_abort(&out);
+            }
+        }
+        op_stats_end(stats);
+        PDF_TRACE_END("merge", output_path, span);
+        return result;
+    }
+
+    start = stats_clock(stats);
+    merge_progress_init(&progress, options, user_data, input_paths, input_count);
+    stats_phase(stats, PDF_PHASE_READ, start);
+    progress.stats = stats;
+    if (format.duplicate_list) {
+        progress.input_paths = input_paths;
+        progress.input_count = input_count;
+        progress.input_pages = (int*)calloc((size_t)input_count, sizeof(int));
+        if (!progress.input_pages) {
+            SET_ERROR(error, PDF_ERR_MEMORY);
+            op_stats_end(stats);
+            PDF_TRACE_END("merge", output_path, span);
+            return 0;
+        }
+    }
+
+    switch (mode) {
+        case PDF_MERGE_STREAMING:
+            result = pdf_merge_streaming(input_paths, input_count, output_path, options->cancel, &progress,
+                                         progress_cb, user_data, error, failed_index);
+            break;
+        case PDF_MERGE_TREE:
+            result = pdf_merge_tree(input_paths, input_count, output_path, options->thread_count, &format,
+                                    options->cancel, &progress, progress_cb, user_data, error, failed_index);
+            break;
+        case PDF_MERGE_SEQUENTIAL:
+            result = pdf_merge_sequential(input_paths, input_count, output_path, &format,
+                                          options->cancel, &progress, progress_cb, user_data, error, failed_index);
+            break;
+        case PDF_MERGE_SINGLE_PASS:
+        default:
+            result = pdf_merge_single_pass(input_paths, input_count, output_path, &format,
+                                           options->cancel, &progress, progress_cb, user_data, error, failed_index);
+            break;
+    }
+    duplicates_to_inputs(format.duplicate_list, progress.input_pages, input_count);
+    free(progress.input_pages);
+    op_stats_end(stats);
+    PDF_TRACE_END("merge", output_path, span);
+    return result;
+}
+
+int pdf_merge(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+              pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index)
+{
+    return pdf_merge_ex(input_paths, input_count, output_path, NULL,
+                        progress_cb, user_data, error, failed_index);
+}
+
+/* Hex of a string object, for carrying over /ID */
+static void string_to_hex(qpdf_data qpdf, qpdf_oh oh, char* out, size_t out_len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t len = 0, i, n = 0;
+    const unsigned char* data = (const unsigned char*)qpdf_oh_get_binary_string_value(qpdf, oh, &len);
+
+    for (i = 0; data && i < len && n + 3 <= out_len; i++) {
+        out[n++] = hex[data[i] >> 4];
+        out[n++] = hex[data[i] & 0x0f];
+    }
+    out[n] = '\0';
+}
+
+int pdf_append(const WCHAR* target_path, const WCHAR** input_paths, int input_count,
+               pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index)
+{
+    pdf_source_t target, src;
+    char trailer[512];
+    char id0[80];
+    qpdf_data qpdf_target = NULL;
+    qpdf_data qpdf_in = NULL;
+    qpdf_oh trailer_oh = 0, root = 0, old_pages = 0, value = 0;
+    FILE* out = NULL;
+    pdf_writer_t* writer = NULL;
+    int* kids = NULL;
+    int kid_count = 0, kid_cap = 0;
+    int i, j, page_count, page_num, new_pages_num, size_floor, old_count, xref_is_stream = 0;
+    int total_steps = input_count + 1, appended = 0, result = 0;
+    long long prev_xref;
+    unsigned long long original_size;
+    char buf[160];
+    pdf_error_t local_error = PDF_OK;
+
+    SET_ERROR(error, PDF_OK);
+    if (failed_index) *failed_index = -1;
+    memset(&src, 0, sizeof(src));
+    src.map.file = INVALID_HANDLE_VALUE;
+
+    PDF_LOG(PDF_LOG_INFO, "=== APPEND START: input_count=%d ===", input_count);
+
+    if (input_count <= 0) {
+        SET_ERROR(error, PDF_ERR_UNKNOWN);
+        return 0;
+    }
+
+    /* Parse the existing document in place: only its trailer, catalog and
+     * page tree root are touched, the rest is never read */
+    if (!source_open(target_path, &target, NULL, &local_error)) {
+        SET_ERROR(error, local_error);
+        return 0;
+    }
+    original_size = target.map.size;
+    qpdf_target = target.qpdf;
+
+    /* New objects would have to be encrypted with the document key */
+    if (qpdf_is_encrypted(qpdf_target)) {
+        local_error = PDF_ERR_PASSWORD_PROTECTED;
+        goto cleanup;
+    }
+
+    prev_xref = pdf_scan_startxref(target.map.data, target.map.size, &xref_is_stream);
+    trailer_oh = qpdf_get_trailer(qpdf_target);
+    root = qpdf_get_root(qpdf_target);
+    old_pages = qpdf_oh_get_key(qpdf_target, root, "/Pages");
+    value = qpdf_oh_get_key(qpdf_target, trailer_oh, "/Size");
+    size_floor = qpdf_oh_get_int_value_as_int(qpdf_target, value);
+    qpdf_oh_release(qpdf_target, value);
+    value = qpdf_oh_get_key(qpdf_target, old_pages, "/Count");
+    old_count = qpdf_oh_get_int_value_as_int(qpdf_target, value);
+    qpdf_oh_release(qpdf_target, value);
+
+    if (prev_xref < 0 || size_floor <= 0 || !qpdf_oh_is_indirect(qpdf_target, root) ||
+        !qpdf_oh_is_indirect(qpdf_target, old_pages) || qpdf_has_error(qpdf_target)) {
+        PDF_LOG(PDF_LOG_ERROR, "target trailer/page tree not usable for append");
+        local_error = PDF_ERR_INVALID_PDF;
+        goto cleanup;
+    }
+
+    out = _wfopen(target_path, L"ab");
+    if (!out) {
+        local_error = PDF_ERR_ACCESS_DENIED;
+        goto cleanup;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    appended = 1;
+
+    writer = pdf_writer_create(out, (long long)original_size, size_floor);
+    if (!writer) {
+        local_error = PDF_ERR_MEMORY;
+        goto cleanup;
+    }
+    if (target.map.data[target.map.size - 1] != '\n' && target.map.data[target.map.size - 1] != '\r') {
+        pdf_writer_write(writer, "\n", 1);
+    }
+
+    /* New page tree root: [old root, new pages...] so inherited attributes
+     * of the old root keep applying to old pages only */
+    new_pages_num = pdf_writer_reserve(writer);
+
+    for (i = 0; i < input_count; i++) {
+        if (progress_cb) progress_cb(i + 1, total_steps, user_data);
+
+        /* Map and parse the input in place */
+        if (!source_open(input_paths[i], &src, NULL, &local_error)) {
+            if (failed_index) *failed_index = i;
+            goto cleanup;
+        }
+        qpdf_in = src.qpdf;
+        qpdf_push_inherited_attributes_to_page(qpdf_in);
+
+        page_count = qpdf_get_num_pages(qpdf_in);
+        PDF_LOG(PDF_LOG_DEBUG, "Appending %d pages from file %d", page_count, i);
+
+        if (kid_count + page_count > kid_cap) {
+            int new_cap = kid_cap ? kid_cap : 256;
+            int* grown;
+            while (new_cap < kid_count + page_count) new_cap *= 2;
+            grown = (int*)realloc(kids, (size_t)new_cap * sizeof(int));
+            if (!grown) {
+                local_error = PDF_ERR_MEMORY;
+                goto cleanup;
+            }
+            kids = grown;
+            kid_cap = new_cap;
+        }
+
+        pdf_writer_begin_source(writer, qpdf_in);
+        for (j = 0; j < page_count; j++) {
+            qpdf_oh page = qpdf_get_page_n(qpdf_in, (size_t)j);
+            page_num = pdf_writer_add_page(writer, page, new_pages_num);
+            qpdf_oh_release(qpdf_in, page);
+            if (!page_num) break;
+            kids[kid_count++] = page_num;
+        }
+        if (!pdf_writer_flush(writer)) {
+            if (qpdf_has_error(qpdf_in)) {
+                local_error = PDF_ERR_INVALID_PDF;
+                if (failed_index) *failed_index = i;
+            } else {
+                local_error = PDF_ERR_WRITE_FAILED;
+            }
+            goto cleanup;
+        }
+
+        source_close(&src);
+        qpdf_in = NULL;
+    }
+
+    if (progress_cb) progress_cb(total_steps, total_steps, user_data);
+
+    /* Updated objects of the existing document, under their own numbers */
+    pdf_writer_begin_source(writer, qpdf_target);
+    sprintf(buf, " /Parent %d 0 R", new_pages_num);
+    pdf_writer_rewrite_object(writer, old_pages, "/Parent", buf);
+    sprintf(buf, " /Pages %d 0 R", new_pages_num);
+    pdf_writer_rewrite_object(writer, root, "/Pages", buf);
+
+    pdf_writer_begin_object(writer, new_pages_num);
+    pdf_writer_printf(writer, "<< /Type /Pages /Count %d /Kids [%d %d R",
+                      old_count + kid_count,
+                      qpdf_oh_get_object_id(qpdf_target, old_pages),
+                      qpdf_oh_get_generation(qpdf_target, old_pages));
+    for (j = 0; j < kid_count; j++) {
+        pdf_writer_printf(writer, (j % 16 == 15) ? " %d 0 R\n" : " %d 0 R", kids[j]);
+    }
+    pdf_writer_printf(writer, "] >>");
+    pdf_writer_end_object(writer);
+
+    /* Trailer: same /Root and /Info, /Prev chain, first /ID kept */
+    sprintf(trailer, "/Root %d %d R /Prev %lld",
+            qpdf_oh_get_object_id(qpdf_target, root), qpdf_oh_get_generation(qpdf_target, root), prev_xref);
+    value = qpdf_oh_get_key(qpdf_target, trailer_oh, "/Info");
+    if (qpdf_oh_is_indirect(qpdf_target, value)) {
+        sprintf(trailer + strlen(trailer), " /Info %d %d R",
+                qpdf_oh_get_object_id(qpdf_target, value), qpdf_oh_get_generation(qpdf_target, value));
+    }
+    qpdf_oh_release(qpdf_target, value);
+    value = qpdf_oh_get_key(qpdf_target, trailer_oh, "/ID");
+    if (qpdf_oh_is_array(qpdf_target, value) && qpdf_oh_get_array_n_items(qpdf_target, value) >= 1) {
+        qpdf_oh first = qpdf_oh_get_array_item(qpdf_target, value, 0);
+        string_to_hex(qpdf_target, first, id0, sizeof(id0));
+        qpdf_oh_release(qpdf_target, first);
+        sprintf(trailer + strlen(trailer), " /ID [<%s><%016llX%08X>]",
+                id0, pdf_writer_digest(writer), (unsigned int)kid_count);
+    }
+    qpdf_oh_release(qpdf_target, value);
+
+    if (xref_is_stream) {
+        pdf_writer_write_xref_stream(writer, size_floor, trailer);
+    } else {
+        pdf_writer_write_xref(writer, size_floor, trailer, 0);
+    }
+
+    i = pdf_writer_failed(writer);
+    if (fclose(out) != 0) i = 1;
+    out = NULL;
+    if (i) {
+        PDF_LOG(PDF_LOG_ERROR, "writing update section failed");
+        local_error = PDF_ERR_WRITE_FAILED;
+        goto cleanup;
+    }
+
+    result = 1;
+    PDF_LOG(PDF_LOG_INFO, "=== APPEND END (SUCCESS) ===");
+
+cleanup:
+    source_close(&src);
+    pdf_writer_destroy(writer);
+    if (out) fclose(out);
+    source_close(&target);
+    free(kids);
+
+    /* Never leave a half-written update section behind */
+    if (!result && appended) {
+        truncate_file_w(target_path, original_size);
+    }
+
+    SET_ERROR(error, local_error);
+    return result;
+}
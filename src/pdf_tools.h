@@ -6,7 +6,11 @@
 #ifndef PDF_TOOLS_H
 #define PDF_TOOLS_H
 
-#include <windows.h>
+/*
+ * Public types are plain C (wchar_t paths, which are UTF-16 on Windows and
+ * UTF-32 elsewhere), so the header does not need <windows.h>.
+ */
+#include <wchar.h>
 
 /*
  * PDF 작업 오류 코드
@@ -21,6 +25,8 @@ typedef enum {
     PDF_ERR_WRITE_FAILED = -6,      /* 파일 쓰기 실패 */
     PDF_ERR_MEMORY = -7,            /* 메모리 부족 */
     PDF_ERR_TEMP_FILE = -8,         /* 임시 파일 생성 실패 */
+    PDF_ERR_CANCELLED = -9,         /* 취소 요청 또는 제한 시간 초과 */
+    PDF_ERR_INVALID_ARGUMENT = -10, /* 잘못된 인자 (MAX_PATH 이상인 경로 등) */
     PDF_ERR_UNKNOWN = -99           /* 알 수 없는 오류 */
 } pdf_error_t;
 
@@ -29,16 +35,117 @@ typedef enum {
  * @param error 오류 코드
  * @return 오류 메시지 (정적 문자열)
  */
-const WCHAR* pdf_error_message(pdf_error_t error);
+const wchar_t* pdf_error_message(pdf_error_t error);
 
 /*
- * Progress callback type for merge operations.
+ * Progress callback type for split/merge operations.
  * @param current current step (1-based)
  * @param total total steps
  * @param user_data user-provided data
  */
 typedef void (*pdf_progress_cb)(int current, int total, void* user_data);
 
+/*
+ * Page-level progress of a split or merge.
+ * A page counts half when it is copied into an output document and half
+ * while that document is written, so progress keeps moving during the
+ * write. In the sequential and tree merge modes a page is counted every
+ * time it is rewritten. Bytes are the input size spread over its pages.
+ */
+typedef struct pdf_progress_info {
+    long long pages_done;
+    long long pages_total;
+    unsigned long long bytes_done;
+    unsigned long long bytes_total;
+    double elapsed;                 /* 초 */
+    double mb_per_sec;              /* bytes_done / elapsed */
+    double eta;                     /* 남은 시간 (초), 아직 모르면 -1 */
+} pdf_progress_info_t;
+
+/*
+ * Called at most once per progress interval, plus once when the last page
+ * is done. In parallel modes it can run on a worker thread, but calls never
+ * overlap. user_data is the one passed to the operation.
+ */
+typedef void (*pdf_page_progress_cb)(const pdf_progress_info_t* info, void* user_data);
+
+#define PDF_PROGRESS_DEFAULT_INTERVAL_MS 200
+
+/*
+ * Cancellation token, shared between the caller and a running operation.
+ * Another thread calls pdf_cancel_request(), or the deadline passes, and
+ * the operation stops at its next check with PDF_ERR_CANCELLED. Checks
+ * run between inputs, chapters and pages; a single QPDF parse or write
+ * that is already running finishes first. Temp files are removed and no
+ * output is committed for the work that was cancelled.
+ */
+typedef struct pdf_cancel {
+    volatile long requested;
+    unsigned long long deadline;    /* 단조 시계 ms 기준, 0 = 없음 */
+} pdf_cancel_t;
+
+void pdf_cancel_init(pdf_cancel_t* cancel);
+
+/*
+ * Request cancellation (any thread).
+ */
+void pdf_cancel_request(pdf_cancel_t* cancel);
+
+/*
+ * Cancel automatically timeout_ms from now (0 = no deadline).
+ */
+void pdf_cancel_set_timeout(pdf_cancel_t* cancel, unsigned long timeout_ms);
+
+/*
+ * @return 1 if cancellation was requested or the deadline has passed
+ *         (NULL = never)
+ */
+int pdf_cancel_requested(const pdf_cancel_t* cancel);
+
+/*
+ * Where an operation spent its time.
+ */
+typedef enum {
+    PDF_PHASE_TEMP = 0,             /* 임시 파일 생성/삭제 */
+    PDF_PHASE_READ,                 /* 입력 매핑, xref 스캔, QPDF 파싱 */
+    PDF_PHASE_COPY,                 /* 페이지 복사 (qpdf_add_page, 스트리밍 병합의 객체 복사) */
+    PDF_PHASE_DEDUP,                /* 중복 스트림 합치기 (병합 dedup 옵션) */
+    PDF_PHASE_WRITE,                /* 출력 기록 (qpdf_write, xref, 파일 복사) */
+    PDF_PHASE_COMMIT,               /* 임시 파일을 최종 경로로 교체 */
+    PDF_PHASE_COUNT
+} pdf_phase_t;
+
+/*
+ * Per-operation statistics, filled when the operation returns (also on
+ * failure, for the work done so far). In the parallel modes the phase
+ * times are summed over worker threads, so they can add up to more than
+ * total_seconds.
+ */
+typedef struct pdf_stats {
+    double total_seconds;
+    double phase_seconds[PDF_PHASE_COUNT];
+    unsigned long long bytes_read;      /* 파싱하거나 스캔한 입력 파일 크기 합 (캐시/인덱스 적중 제외) */
+    unsigned long long bytes_written;   /* 기록한 출력 파일 크기 합 (중간 결과 포함) */
+    long long pages_copied;             /* 출력 문서에 복사한 페이지 (중간 결과 포함) */
+    long long objects_written;          /* 출력 파일의 객체 수 합 (trailer /Size - 1) */
+    unsigned long long peak_temp_bytes; /* 동시에 존재한 임시 파일 크기의 최댓값 */
+    long long streams_deduplicated;     /* 첫 사본으로 합친 중복 스트림 수 (병합 dedup 옵션) */
+    unsigned long long dedup_bytes_saved; /* 합친 스트림의 원본 데이터 크기 합 (출력에서 빠진 바이트) */
+} pdf_stats_t;
+
+/*
+ * Short name of a phase ("temp", "read", "copy", "dedup", "write", "commit").
+ */
+const wchar_t* pdf_phase_name(pdf_phase_t phase);
+
+/*
+ * One-line summary of stats for a status bar or log, e.g.
+ * "1.84s (read 0.21s, copy 0.40s, write 1.15s, commit 0.01s), 120.4 MB in, ..."
+ * Phases under 5 ms are left out.
+ * @return characters written (without the terminator)
+ */
+int pdf_stats_format(const pdf_stats_t* stats, wchar_t* buf, int len);
+
 /*
  * Get page count of a PDF file.
  *
@@ -46,7 +153,76 @@ typedef void (*pdf_progress_cb)(int current, int total, void* user_data);
  * @param error 오류 코드 출력 (NULL 가능)
  * @return page count (-1 on error)
  */
-int pdf_get_page_count(const WCHAR* pdf_path, pdf_error_t* error);
+int pdf_get_page_count(const wchar_t* pdf_path, pdf_error_t* error);
+
+/*
+ * pdf_get_page_count() that can be cancelled and timed (cancel and stats
+ * can be NULL).
+ */
+int pdf_get_page_count_ex(const wchar_t* pdf_path, const pdf_cancel_t* cancel, pdf_stats_t* stats,
+                          pdf_error_t* error);
+
+/*
+ * Basic facts about a PDF file.
+ */
+typedef struct pdf_file_info {
+    int page_count;
+    int object_count;               /* trailer /Size - 1 */
+    int encrypted;                  /* 1 = 암호화된 문서 */
+    char version[8];                /* "1.7" 등 */
+} pdf_file_info_t;
+
+/*
+ * Get page count, version, encryption flag and object count.
+ * Files already seen (same path, size and modification time) are answered
+ * from the persistent index without opening the file; new results are
+ * added to it. pdf_get_page_count() uses this too.
+ *
+ * @return 1 on success, 0 on failure
+ */
+int pdf_get_file_info(const wchar_t* pdf_path, pdf_file_info_t* info, pdf_error_t* error);
+
+/*
+ * Where the first page of a linearized file ends.
+ */
+typedef struct pdf_linearization {
+    unsigned long long file_size;       /* 파일 크기 */
+    unsigned long long first_page_end;  /* 첫 페이지 표시에 필요한 앞부분 크기 (/E) */
+} pdf_linearization_t;
+
+/*
+ * Check that a file is linearized ("fast web view") and that its hint
+ * tables match the file, so a viewer can show the first page after
+ * fetching only the start of the file: the linearization dictionary is
+ * in the first 1024 bytes, written for this file length, and (with more
+ * than one page) the first page section ends before the end of the file.
+ * QPDF prints the hint table problems it finds to stderr.
+ *
+ * @return 1 = linearized and valid, 0 = not linearized or invalid,
+ *         -1 = the file could not be read (see error)
+ */
+int pdf_check_linearization(const wchar_t* pdf_path, pdf_error_t* error);
+
+/*
+ * pdf_check_linearization that also reports the first page section.
+ * @param info filled when the file has a linearization dictionary (NULL 가능)
+ */
+int pdf_check_linearization_ex(const wchar_t* pdf_path, pdf_linearization_t* info, pdf_error_t* error);
+
+/*
+ * Persistent metadata index file.
+ * Default: %LOCALAPPDATA%\JunPdfTools\pdf_index.dat on Windows,
+ * $XDG_CACHE_HOME/jun-pdf-tools/pdf_index.dat (or ~/.cache/...) elsewhere.
+ * NULL disables the index. Changing the file closes the current one.
+ * @return 1 on success, 0 if the path is empty or MAX_PATH or longer
+ *         (the index is then disabled)
+ */
+int pdf_index_set_file(const wchar_t* index_path);
+
+/*
+ * Close the index file (e.g. at program exit). It is reopened on demand.
+ */
+void pdf_index_close(void);
 
 /*
  * Split pages from a PDF file.
@@ -58,10 +234,209 @@ int pdf_get_page_count(const WCHAR* pdf_path, pdf_error_t* error);
  * @param error 오류 코드 출력 (NULL 가능)
  * @return 1 on success, 0 on failure
  */
-int pdf_split(const WCHAR* input_path, const WCHAR* output_path, int start_page, int end_page, pdf_error_t* error);
+int pdf_split(const wchar_t* input_path, const wchar_t* output_path, int start_page, int end_page, pdf_error_t* error);
+
+/*
+ * Parsed document handle.
+ * Handles of the same unchanged file (path, size, modification time) share
+ * one parsed document through an LRU cache, so loading a file and then
+ * splitting it parses it only once. pdf_split_batch() goes through the
+ * same cache.
+ */
+typedef struct pdf_document pdf_document_t;
+
+/*
+ * Open (or reuse) a parsed document.
+ * @return handle, NULL on error
+ */
+pdf_document_t* pdf_document_open(const wchar_t* path, pdf_error_t* error);
+
+/*
+ * Release a handle. The parsed document stays cached until evicted.
+ */
+void pdf_document_close(pdf_document_t* doc);
+
+/*
+ * Pages of the parsed page tree, the count pdf_split_batch() checks
+ * chapters against (unlike pdf_get_page_count(), which may trust the
+ * root /Count).
+ * @return page count, -1 on error
+ */
+int pdf_document_get_page_count(pdf_document_t* doc, pdf_error_t* error);
+
+typedef struct pdf_cache_stats {
+    unsigned long long hits;        /* opens served from the cache */
+    unsigned long long misses;      /* opens that parsed the file */
+    unsigned long long evictions;
+    int entries;
+    unsigned long long bytes;       /* 캐시된 파일 크기 합계 */
+    unsigned long long limit;
+} pdf_cache_stats_t;
 
 /*
- * Merge multiple PDF files into one.
+ * Set the cache memory cap in bytes (default 1 GB). The cost of an entry
+ * is its file size; entries in use are never evicted.
+ */
+void pdf_document_cache_set_limit(unsigned long long max_bytes);
+void pdf_document_cache_get_stats(pdf_cache_stats_t* stats);
+
+/*
+ * Drop every cached document that has no open handle.
+ */
+void pdf_document_cache_clear(void);
+
+/*
+ * One chapter of a batch split.
+ * With pages set, the chapter is the pages of that expression in its
+ * order (see pdf_page_ranges_count) and start_page/end_page are ignored.
+ */
+typedef struct pdf_split_chapter {
+    const wchar_t* output_path;       /* 출력 PDF 경로 */
+    int start_page;                 /* 시작 페이지 (1부터) */
+    int end_page;                   /* 끝 페이지 (포함) */
+    const wchar_t* pages;           /* 페이지 범위 식 (예: L"1-3,10,7-9"), NULL = start_page~end_page */
+} pdf_split_chapter_t;
+
+/*
+ * Check a page-range expression and count the pages it selects.
+ *
+ * Items are separated by commas; an item is a page "N" or a range "A-B".
+ * "$" stands for the last page, and A > B is a reverse range, so
+ * "1-3,10,7-9", "5-1" and "8-$" are all valid. Pages come out in the
+ * order written; a page may appear more than once. Whitespace is ignored.
+ *
+ * @param expr expression
+ * @param total_pages 문서 페이지 수 ("$"의 값), 0 = 아직 모름 (형식과 0 페이지만 검사)
+ * @param bad_page 범위를 벗어난 페이지 번호 출력 (NULL 가능)
+ * @return pages selected (0 when total_pages is 0), -1 = syntax error,
+ *         -2 = page 0 or past the last page (or more than INT_MAX pages)
+ */
+int pdf_page_ranges_count(const wchar_t* expr, int total_pages, int* bad_page);
+
+/*
+ * Split several chapters out of one PDF file.
+ * The source is read and parsed once; every chapter is written from
+ * that single parsed document.
+ *
+ * @param input_path source PDF path
+ * @param chapters chapter array
+ * @param chapter_count number of chapters
+ * @param results 챕터별 오류 코드 출력 (chapter_count개, PDF_OK = 성공)
+ * @param progress_cb progress callback, one step per chapter (can be NULL)
+ * @param user_data user data for callback
+ * @param error 입력 파일 오류 코드 출력 (NULL 가능, 이 경우 모든 챕터 실패)
+ * @return number of chapters written successfully
+ */
+int pdf_split_batch(const wchar_t* input_path, const pdf_split_chapter_t* chapters, int chapter_count,
+                    pdf_error_t* results, pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error);
+
+/*
+ * How QPDF writes an output file (split, and merges other than
+ * PDF_MERGE_STREAMING, which always copies streams as they are).
+ */
+typedef enum {
+    PDF_OUTPUT_STANDARD = 0,        /* QPDF 기본값: 비압축/구형 필터 스트림은 다시 압축, 객체 스트림 유지 (병합 기본값) */
+    PDF_OUTPUT_FAST,                /* 스트림을 디코딩/재압축 없이 그대로 복사, 객체 스트림 생성 안 함 */
+    PDF_OUTPUT_COMPACT              /* 스트림 다시 압축 + 객체 스트림 생성 (분할 기본값, CPU 많이 씀) */
+} pdf_output_profile_t;
+
+/*
+ * Split strategy.
+ */
+typedef enum {
+    PDF_SPLIT_SERIAL = 0,           /* 챕터를 하나씩 기록 (기본값) */
+    PDF_SPLIT_PARALLEL              /* 작업 스레드에서 챕터를 동시에 기록 */
+} pdf_split_mode_t;
+
+/*
+ * Split options. Initialize with pdf_split_options_init().
+ */
+typedef struct pdf_split_options {
+    pdf_split_mode_t mode;
+    int thread_count;               /* PDF_SPLIT_PARALLEL 스레드 수 (0 = CPU 코어 수) */
+    const pdf_cancel_t* cancel;     /* 취소 토큰 (NULL = 없음) */
+    pdf_page_progress_cb page_progress; /* 페이지 단위 진행률 (NULL = 없음) */
+    unsigned long progress_interval_ms; /* page_progress 최소 간격 (0 = 기본값) */
+    pdf_stats_t* stats;             /* 단계별 시간과 카운터 출력 (NULL = 수집 안 함) */
+    pdf_output_profile_t profile;   /* 출력 기록 방식 (기본값 PDF_OUTPUT_COMPACT) */
+    int linearize;                  /* 1 = 선형화(빠른 웹 보기) 출력 */
+} pdf_split_options_t;
+
+void pdf_split_options_init(pdf_split_options_t* options);
+
+/*
+ * pdf_split_batch() with options (NULL = defaults).
+ * In PDF_SPLIT_PARALLEL mode every worker parses its own qpdf handle from
+ * the shared file mapping, so peak memory grows with thread_count.
+ * Progress is reported as chapters finish, on the calling thread.
+ * On cancellation, chapters already written are kept and the rest fail
+ * with PDF_ERR_CANCELLED.
+ */
+int pdf_split_batch_ex(const wchar_t* input_path, const pdf_split_chapter_t* chapters, int chapter_count,
+                       const pdf_split_options_t* options, pdf_error_t* results,
+                       pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error);
+
+/*
+ * Merge strategy.
+ */
+typedef enum {
+    PDF_MERGE_SINGLE_PASS = 0,      /* 각 입력을 한 번만 읽고, 출력은 한 번만 쓰기 (기본값) */
+    PDF_MERGE_SEQUENTIAL = 1,       /* 2개씩 순차 병합 (A+B->t1, t1+C->t2, ...) */
+    PDF_MERGE_TREE = 2,             /* 인접한 2개씩 병렬 병합, log2(N) 라운드 */
+    PDF_MERGE_STREAMING = 3         /* 입력을 하나씩 열어 출력 파일에 바로 기록 (메모리 = 가장 큰 입력 1개) */
+} pdf_merge_mode_t;
+
+/*
+ * What a merge does with pages that equal an earlier page of the merged
+ * document (same attributes, resources, annotations and content streams,
+ * compared by value across inputs).
+ */
+typedef enum {
+    PDF_DUPLICATES_KEEP = 0,        /* 검사 안 함 (기본값) */
+    PDF_DUPLICATES_REPORT,          /* 찾아서 목록만 돌려줌, 출력은 그대로 */
+    PDF_DUPLICATES_DROP             /* 찾아서 출력에서 뺌 (처음 나온 페이지만 남음) */
+} pdf_duplicate_mode_t;
+
+typedef struct pdf_duplicate_page {
+    int input_index;                /* 중복 페이지가 있는 입력 파일 (0부터) */
+    int page;                       /* 그 파일의 페이지 번호 (1부터) */
+    int first_input_index;          /* 같은 페이지가 처음 나온 입력 파일 */
+    int first_page;                 /* 그 파일의 페이지 번호 */
+} pdf_duplicate_page_t;
+
+/*
+ * Duplicate pages found by a merge, in merged order.
+ */
+typedef struct pdf_duplicate_list {
+    pdf_duplicate_page_t* pages;    /* 호출자가 준 배열 (NULL = 개수만) */
+    int capacity;                   /* pages 배열 크기 */
+    int count;                      /* 찾은 중복 페이지 수 (capacity보다 크면 앞의 capacity개만 기록) */
+} pdf_duplicate_list_t;
+
+/*
+ * Merge options. Initialize with pdf_merge_options_init() before use.
+ */
+typedef struct pdf_merge_options {
+    pdf_merge_mode_t mode;          /* 병합 방식 */
+    int thread_count;               /* PDF_MERGE_TREE 작업 스레드 수 (0 = CPU 코어 수) */
+    const pdf_cancel_t* cancel;     /* 취소 토큰 (NULL = 없음) */
+    pdf_page_progress_cb page_progress; /* 페이지 단위 진행률 (NULL = 없음) */
+    unsigned long progress_interval_ms; /* page_progress 최소 간격 (0 = 기본값) */
+    pdf_stats_t* stats;             /* 단계별 시간과 카운터 출력 (NULL = 수집 안 함) */
+    pdf_output_profile_t profile;   /* 최종 출력 기록 방식 (기본값 PDF_OUTPUT_STANDARD, 중간 결과는 항상 FAST) */
+    int linearize;                  /* 1 = 최종 출력을 선형화 (PDF_MERGE_STREAMING은 SINGLE_PASS로 실행) */
+    int dedup;                      /* 1 = 같은 스트림(글꼴, 로고, ICC 프로필)을 한 객체로 합침, 절약량은 stats에 (STREAMING은 SINGLE_PASS로 실행) */
+    pdf_duplicate_mode_t duplicates; /* 중복 페이지 처리 (PDF_DUPLICATES_KEEP 외에는 STREAMING을 SINGLE_PASS로 실행) */
+    pdf_duplicate_list_t* duplicate_list; /* 찾은 중복 페이지 출력 (NULL = 안 받음) */
+} pdf_merge_options_t;
+
+/*
+ * Fill merge options with defaults (single-pass mode).
+ */
+void pdf_merge_options_init(pdf_merge_options_t* options);
+
+/*
+ * Merge multiple PDF files into one (default options).
  *
  * @param input_paths array of input PDF paths
  * @param input_count number of input files
@@ -72,7 +447,98 @@ int pdf_split(const WCHAR* input_path, const WCHAR* output_path, int start_page,
  * @param failed_index 실패한 파일 인덱스 출력 (NULL 가능, 입력 파일 오류 시)
  * @return 1 on success, 0 on failure
  */
-int pdf_merge(const WCHAR** input_paths, int input_count, const WCHAR* output_path,
+int pdf_merge(const wchar_t** input_paths, int input_count, const wchar_t* output_path,
               pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index);
 
+/*
+ * Merge multiple PDF files into one using the given options.
+ * Same parameters as pdf_merge(), plus:
+ *
+ * @param options merge options (NULL = defaults)
+ * @return 1 on success, 0 on failure
+ */
+int pdf_merge_ex(const wchar_t** input_paths, int input_count, const wchar_t* output_path,
+                 const pdf_merge_options_t* options,
+                 pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index);
+
+/*
+ * Append PDF files to the end of an existing PDF as an incremental update.
+ * The existing bytes are left untouched: the new pages and their objects,
+ * an updated catalog and page tree root, and a new xref/trailer are
+ * written after them. Cost is proportional to the appended files, not to
+ * the existing document. On failure the target is cut back to its
+ * original size.
+ *
+ * @param target_path existing PDF to grow (not encrypted)
+ * @param input_paths array of PDF paths to append, in order
+ * @param input_count number of input files
+ * @param progress_cb progress callback (can be NULL)
+ * @param user_data user data for callback
+ * @param error 오류 코드 출력 (NULL 가능)
+ * @param failed_index 실패한 파일 인덱스 출력 (NULL 가능, 입력 파일 오류 시)
+ * @return 1 on success, 0 on failure
+ */
+int pdf_append(const wchar_t* target_path, const wchar_t** input_paths, int input_count,
+               pdf_progress_cb progress_cb, void* user_data, pdf_error_t* error, int* failed_index);
+
+/*
+ * Debug log (off by default, nothing is written until pdf_log_open).
+ * Messages are formatted on the calling thread into a lock-free ring
+ * buffer and written to the sink by a background thread, so a log call
+ * never waits for the disk. When the ring is full, messages are dropped
+ * and counted instead of blocking. Below the current level a log call
+ * costs one comparison.
+ */
+typedef enum {
+    PDF_LOG_OFF = 0,
+    PDF_LOG_ERROR,
+    PDF_LOG_WARN,
+    PDF_LOG_INFO,
+    PDF_LOG_DEBUG
+} pdf_log_level_t;
+
+/*
+ * Start logging to path (appended; NULL = stderr) at the given level.
+ * An open log is closed first.
+ * @return 1 on success, 0 if the file or the writer thread failed
+ */
+int pdf_log_open(const wchar_t* path, pdf_log_level_t level);
+
+/*
+ * Change the level of an open log (PDF_LOG_OFF pauses it).
+ */
+void pdf_log_set_level(pdf_log_level_t level);
+
+/*
+ * Write out everything queued, stop the writer thread and close the sink.
+ */
+void pdf_log_close(void);
+
+/*
+ * @return messages dropped because the ring was full, since pdf_log_open
+ */
+unsigned long long pdf_log_dropped(void);
+
+/*
+ * Timeline trace (off by default). While a trace is open every operation
+ * records nested spans (operation, chapter / merge step / input file,
+ * then the phases of pdf_phase_t) with the thread that ran them. The
+ * spans are kept in memory and written by pdf_trace_close as Chrome
+ * trace-event JSON, which loads in Perfetto (ui.perfetto.dev) and
+ * chrome://tracing. While no trace is open a span costs one comparison.
+ */
+
+/*
+ * Start recording. An open trace is discarded first.
+ * @param path JSON file written by pdf_trace_close
+ * @return 1 on success, 0 on failure
+ */
+int pdf_trace_open(const wchar_t* path);
+
+/*
+ * Stop recording and write the trace file.
+ * @return 1 if the file was written, 0 on failure or if no trace was open
+ */
+int pdf_trace_close(void);
+
 #endif /* PDF_TOOLS_H */
@@ -0,0 +1,198 @@
+/*
+ * pdf_trace.c - Timeline trace in Chrome trace-event format
+ *
+ * Spans are recorded as complete events ("ph": "X") when they end, so a
+ * span is one append under a lock. Nesting comes from the timestamps:
+ * the viewer stacks events of one thread that lie inside each other.
+ * Spans are coarse (a file, a chapter, a phase), so a lock is cheap
+ * enough; the file is only written by pdf_trace_close.
+ */
+
+#include "pdf_trace.h"
+#include "pdf_compat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_FILE_MAX 64           /* UTF-8 bytes of a file name kept per span */
+#define TRACE_MAX_EVENTS (1 << 20)  /* ≈ 100 MB; later spans are counted as dropped */
+
+typedef struct trace_event {
+    const char* name;
+    DWORD thread_id;
+    LONGLONG start;                 /* QueryPerformanceCounter */
+    LONGLONG end;
+    char file[TRACE_FILE_MAX];      /* 파일 이름 (UTF-8), 없으면 "" */
+} trace_event_t;
+
+volatile long g_pdf_trace_on = 0;
+
+static SRWLOCK g_lock = SRWLOCK_INIT;
+static trace_event_t* g_events = NULL;  /* NULL = 기록 중이 아님 */
+static int g_count = 0;
+static int g_capacity = 0;
+static int g_dropped = 0;
+static LONGLONG g_origin = 0;
+static DWORD g_origin_thread = 0;
+static WCHAR g_path[MAX_PATH];
+
+long long pdf_trace_clock(void)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart ? now.QuadPart : 1;
+}
+
+/* File name part of path as UTF-8, cut at a character boundary */
+static void file_name_utf8(const WCHAR* path, char* out)
+{
+    char buf[MAX_PATH * 4];
+    const WCHAR* name = path;
+    const WCHAR* p;
+    int n;
+
+    for (p = path; *p; p++) {
+        if (*p == L'\\' || *p == L'/') name = p + 1;
+    }
+    n = WideCharToMultiByte(CP_UTF8, 0, name, -1, buf, (int)sizeof(buf), NULL, NULL);
+    if (n <= 0) {
+        out[0] = '\0';
+        return;
+    }
+    n--;
+    if (n >= TRACE_FILE_MAX) {
+        n = TRACE_FILE_MAX - 1;
+        while (n > 0 && ((unsigned char)buf[n] & 0xC0) == 0x80) n--;
+    }
+    memcpy(out, buf, (size_t)n);
+    out[n] = '\0';
+}
+
+void pdf_trace_span(const char* name, const WCHAR* file, long long start)
+{
+    LONGLONG end = pdf_trace_clock();
+    trace_event_t* ev;
+    trace_event_t* grown;
+    int capacity;
+
+    AcquireSRWLockExclusive(&g_lock);
+    if (!g_events) {
+        ReleaseSRWLockExclusive(&g_lock);
+        return;
+    }
+    if (g_count == g_capacity) {
+        capacity = g_capacity * 2;
+        grown = capacity <= TRACE_MAX_EVENTS
+            ? (trace_event_t*)realloc(g_events, (size_t)capacity * sizeof(*g_events)) : NULL;
+        if (!grown) {
+            g_dropped++;
+            ReleaseSRWLockExclusive(&g_lock);
+            return;
+        }
+        g_events = grown;
+        g_capacity = capacity;
+    }
+    ev = &g_events[g_count++];
+    ev->name = name;
+    ev->thread_id = GetCurrentThreadId();
+    ev->start = start;
+    ev->end = end;
+    ev->file[0] = '\0';
+    if (file) file_name_utf8(file, ev->file);
+    ReleaseSRWLockExclusive(&g_lock);
+}
+
+int pdf_trace_open(const WCHAR* path)
+{
+    trace_event_t* events;
+
+    if (!path || !path[0] || wcslen(path) >= MAX_PATH) return 0;
+    events = (trace_event_t*)malloc(1024 * sizeof(*events));
+    if (!events) return 0;
+
+    AcquireSRWLockExclusive(&g_lock);
+    free(g_events);
+    g_events = events;
+    g_count = 0;
+    g_capacity = 1024;
+    g_dropped = 0;
+    g_origin = pdf_trace_clock();
+    g_origin_thread = GetCurrentThreadId();
+    wcscpy(g_path, path);
+    g_pdf_trace_on = 1;
+    ReleaseSRWLockExclusive(&g_lock);
+    return 1;
+}
+
+/* JSON string body (quotes, backslashes and control characters escaped) */
+static void write_json_string(FILE* f, const char* s)
+{
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', f);
+            fputc(c, f);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+}
+
+/* Ticks since pdf_trace_open in microseconds (spans that began earlier start at 0) */
+static double trace_us(LONGLONG ticks, double freq)
+{
+    return ticks > g_origin ? (double)(ticks - g_origin) * 1e6 / freq : 0.0;
+}
+
+int pdf_trace_close(void)
+{
+    LARGE_INTEGER freq;
+    trace_event_t* ev;
+    FILE* f;
+    double start, end;
+    int i, failed;
+
+    g_pdf_trace_on = 0;
+    AcquireSRWLockExclusive(&g_lock);
+    if (!g_events) {
+        ReleaseSRWLockExclusive(&g_lock);
+        return 0;
+    }
+
+    QueryPerformanceFrequency(&freq);
+    f = _wfopen(g_path, L"wb");
+    if (f) {
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,"
+                   "\"args\":{\"name\":\"jun-pdf-tools\"}}",
+                (unsigned long)g_origin_thread);
+        for (i = 0; i < g_count; i++) {
+            ev = &g_events[i];
+            start = trace_us(ev->start, (double)freq.QuadPart);
+            end = trace_us(ev->end, (double)freq.QuadPart);
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"pdf\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+                       "\"ts\":%.3f,\"dur\":%.3f",
+                    ev->name, (unsigned long)ev->thread_id, start, end - start);
+            if (ev->file[0]) {
+                fputs(",\"args\":{\"file\":\"", f);
+                write_json_string(f, ev->file);
+                fputs("\"}", f);
+            }
+            fputc('}', f);
+        }
+        fprintf(f, "\n],\"otherData\":{\"dropped_spans\":%d}}\n", g_dropped);
+        failed = ferror(f);
+        if (fclose(f) != 0) failed = 1;
+    } else {
+        failed = 1;
+    }
+
+    free(g_events);
+    g_events = NULL;
+    g_count = 0;
+    g_capacity = 0;
+    ReleaseSRWLockExclusive(&g_lock);
+    return failed ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+/*
+ * pdf_trace.h
+ * Timeline trace of operation spans (internal)
+ *
+ * long long start = PDF_TRACE_BEGIN();
+ * ...
+ * PDF_TRACE_END("chapter", output_path, start);
+ *
+ * While no trace is open PDF_TRACE_BEGIN is one load and returns 0, and
+ * PDF_TRACE_END does nothing for a span that started as 0.
+ */
+
+#ifndef PDF_TRACE_H
+#define PDF_TRACE_H
+
+#include "pdf_tools.h"
+
+/* 1 while a trace is open */
+extern volatile long g_pdf_trace_on;
+
+#define PDF_TRACE_ENABLED() (g_pdf_trace_on != 0)
+
+#define PDF_TRACE_BEGIN() (g_pdf_trace_on ? pdf_trace_clock() : 0)
+
+#define PDF_TRACE_END(name, file, start) \
+    do { if (start) pdf_trace_span((name), (file), (start)); } while (0)
+
+/*
+ * High-resolution clock (QueryPerformanceCounter ticks), never 0.
+ */
+long long pdf_trace_clock(void);
+
+/*
+ * Record a span from start (a pdf_trace_clock value) until now on the
+ * calling thread. name must stay valid (a literal); file is optional and
+ * only its file name is kept. Dropped if no trace is open.
+ */
+void pdf_trace_span(const char* name, const wchar_t* file, long long start);
+
+#endif /* PDF_TRACE_H */
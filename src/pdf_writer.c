@@ -0,0 +1,676 @@
+/*
+ * pdf_writer.c - Streaming PDF object writer
+ */
+
+#include "pdf_writer.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct xref_entry {
+    int num;
+    int generation;
+    long long offset;
+} xref_entry_t;
+
+typedef struct queued_object {
+    int objid;
+    int generation;
+    int num;
+    int parent_num;             /* > 0 for pages: replaces /Parent */
+} queued_object_t;
+
+struct pdf_writer {
+    FILE* out;
+    long long offset;
+    int failed;
+    int next_num;
+    unsigned long long digest;
+
+    xref_entry_t* xref;
+    int xref_count;
+    int xref_cap;
+
+    /* Current source: (objid, generation) -> new object number */
+    qpdf_data src;
+    int identity;               /* rewriting source objects in place: keep numbers */
+    unsigned long long* map_keys;   /* 0 = empty slot */
+    int* map_vals;
+    size_t map_cap;
+    size_t map_count;
+
+    queued_object_t* queue;
+    int queue_head;
+    int queue_count;
+    int queue_cap;
+
+    const pdf_cancel_t* cancel;
+};
+
+/* ==================== Object map ==================== */
+
+static unsigned long long map_key(int objid, int generation)
+{
+    return ((unsigned long long)(unsigned int)objid << 32) | (unsigned int)generation;
+}
+
+static size_t map_slot(unsigned long long key, size_t cap)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & (cap - 1);
+}
+
+static int map_get(const pdf_writer_t* w, unsigned long long key)
+{
+    size_t i;
+    if (w->map_cap == 0) return 0;
+    for (i = map_slot(key, w->map_cap); w->map_keys[i]; i = (i + 1) & (w->map_cap - 1)) {
+        if (w->map_keys[i] == key) return w->map_vals[i];
+    }
+    return 0;
+}
+
+static int map_put(pdf_writer_t* w, unsigned long long key, int value)
+{
+    size_t i;
+
+    /* Keep load factor under 1/2 */
+    if ((w->map_count + 1) * 2 > w->map_cap) {
+        size_t old_cap = w->map_cap;
+        unsigned long long* old_keys = w->map_keys;
+        int* old_vals = w->map_vals;
+        size_t new_cap = old_cap ? old_cap * 2 : 1024;
+
+        w->map_keys = (unsigned long long*)calloc(new_cap, sizeof(unsigned long long));
+        w->map_vals = (int*)calloc(new_cap, sizeof(int));
+        if (!w->map_keys || !w->map_vals) {
+            free(w->map_keys);
+            free(w->map_vals);
+            w->map_keys = old_keys;
+            w->map_vals = old_vals;
+            return 0;
+        }
+        w->map_cap = new_cap;
+        w->map_count = 0;
+        for (i = 0; i < old_cap; i++) {
+            if (old_keys[i]) map_put(w, old_keys[i], old_vals[i]);
+        }
+        free(old_keys);
+        free(old_vals);
+    }
+
+    for (i = map_slot(key, w->map_cap); w->map_keys[i]; i = (i + 1) & (w->map_cap - 1)) {
+        if (w->map_keys[i] == key) {
+            w->map_vals[i] = value;
+            return 1;
+        }
+    }
+    w->map_keys[i] = key;
+    w->map_vals[i] = value;
+    w->map_count++;
+    return 1;
+}
+
+static void map_clear(pdf_writer_t* w)
+{
+    if (w->map_cap) {
+        memset(w->map_keys, 0, w->map_cap * sizeof(unsigned long long));
+        memset(w->map_vals, 0, w->map_cap * sizeof(int));
+    }
+    w->map_count = 0;
+}
+
+/* ==================== Output ==================== */
+
+pdf_writer_t* pdf_writer_create(FILE* out, long long base_offset, int first_obj_num)
+{
+    pdf_writer_t* w = (pdf_writer_t*)calloc(1, sizeof(pdf_writer_t));
+    if (!w) return NULL;
+    w->out = out;
+    w->offset = base_offset;
+    w->next_num = first_obj_num > 0 ? first_obj_num : 1;
+    w->digest = 14695981039346656037ULL;
+    return w;
+}
+
+void pdf_writer_destroy(pdf_writer_t* w)
+{
+    if (!w) return;
+    free(w->xref);
+    free(w->map_keys);
+    free(w->map_vals);
+    free(w->queue);
+    free(w);
+}
+
+int pdf_writer_failed(const pdf_writer_t* w)
+{
+    return w->failed;
+}
+
+long long pdf_writer_offset(const pdf_writer_t* w)
+{
+    return w->offset;
+}
+
+int pdf_writer_reserve(pdf_writer_t* w)
+{
+    return w->next_num++;
+}
+
+unsigned long long pdf_writer_digest(const pdf_writer_t* w)
+{
+    return w->digest;
+}
+
+int pdf_writer_write(pdf_writer_t* w, const void* data, size_t len)
+{
+    if (w->failed) return 0;
+    if (len && fwrite(data, 1, len, w->out) != len) {
+        w->failed = 1;
+        return 0;
+    }
+    w->offset += (long long)len;
+    return 1;
+}
+
+static int write_str(pdf_writer_t* w, const char* s)
+{
+    return pdf_writer_write(w, s, strlen(s));
+}
+
+int pdf_writer_printf(pdf_writer_t* w, const char* fmt, ...)
+{
+    char buf[512];
+    char* big;
+    va_list args;
+    int len, result;
+
+    va_start(args, fmt);
+    len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (len < 0) {
+        w->failed = 1;
+        return 0;
+    }
+    if ((size_t)len < sizeof(buf)) {
+        return pdf_writer_write(w, buf, (size_t)len);
+    }
+
+    big = (char*)malloc((size_t)len + 1);
+    if (!big) {
+        w->failed = 1;
+        return 0;
+    }
+    va_start(args, fmt);
+    vsnprintf(big, (size_t)len + 1, fmt, args);
+    va_end(args);
+    result = pdf_writer_write(w, big, (size_t)len);
+    free(big);
+    return result;
+}
+
+int pdf_writer_patch(pdf_writer_t* w, long long offset, const char* data, size_t len)
+{
+    if (w->failed) return 0;
+    if (fflush(w->out) != 0 ||
+        _fseeki64(w->out, offset, SEEK_SET) != 0 ||
+        fwrite(data, 1, len, w->out) != len ||
+        _fseeki64(w->out, 0, SEEK_END) != 0) {
+        w->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+static int begin_object_gen(pdf_writer_t* w, int obj_num, int generation)
+{
+    unsigned long long v;
+    int i;
+
+    if (w->xref_count == w->xref_cap) {
+        int new_cap = w->xref_cap ? w->xref_cap * 2 : 1024;
+        xref_entry_t* grown = (xref_entry_t*)realloc(w->xref, (size_t)new_cap * sizeof(xref_entry_t));
+        if (!grown) {
+            w->failed = 1;
+            return 0;
+        }
+        w->xref = grown;
+        w->xref_cap = new_cap;
+    }
+    w->xref[w->xref_count].num = obj_num;
+    w->xref[w->xref_count].generation = generation;
+    w->xref[w->xref_count].offset = w->offset;
+    w->xref_count++;
+
+    /* FNV-1a over number and offset */
+    v = ((unsigned long long)(unsigned int)obj_num << 40) ^ (unsigned long long)w->offset;
+    for (i = 0; i < 8; i++) {
+        w->digest ^= (v >> (i * 8)) & 0xff;
+        w->digest *= 1099511628211ULL;
+    }
+
+    return pdf_writer_printf(w, "%d %d obj\n", obj_num, generation);
+}
+
+int pdf_writer_begin_object(pdf_writer_t* w, int obj_num)
+{
+    return begin_object_gen(w, obj_num, 0);
+}
+
+int pdf_writer_end_object(pdf_writer_t* w)
+{
+    return write_str(w, "\nendobj\n");
+}
+
+/* ==================== Object copy ==================== */
+
+static int enqueue(pdf_writer_t* w, int objid, int generation, int num, int parent_num)
+{
+    queued_object_t* item;
+
+    if (w->queue_count == w->queue_cap) {
+        int new_cap = w->queue_cap ? w->queue_cap * 2 : 256;
+        queued_object_t* grown = (queued_object_t*)realloc(w->queue, (size_t)new_cap * sizeof(queued_object_t));
+        if (!grown) {
+            w->failed = 1;
+            return 0;
+        }
+        w->queue = grown;
+        w->queue_cap = new_cap;
+    }
+    item = &w->queue[w->queue_count++];
+    item->objid = objid;
+    item->generation = generation;
+    item->num = num;
+    item->parent_num = parent_num;
+    return 1;
+}
+
+void pdf_writer_begin_source(pdf_writer_t* w, qpdf_data src)
+{
+    w->src = src;
+    map_clear(w);
+    w->queue_head = 0;
+    w->queue_count = 0;
+}
+
+int pdf_writer_add_page(pdf_writer_t* w, qpdf_oh page, int parent_num)
+{
+    int objid = qpdf_oh_get_object_id(w->src, page);
+    int generation = qpdf_oh_get_generation(w->src, page);
+    unsigned long long key = map_key(objid, generation);
+    int num;
+
+    if (objid <= 0) {
+        w->failed = 1;
+        return 0;
+    }
+    num = map_get(w, key);
+    if (num) return num;
+
+    num = w->next_num++;
+    if (!map_put(w, key, num) || !enqueue(w, objid, generation, num, parent_num)) {
+        w->failed = 1;
+        return 0;
+    }
+    return num;
+}
+
+/* Names: escape delimiters, '#' and non-printable bytes as #xx */
+static int write_name(pdf_writer_t* w, const char* name)
+{
+    char buf[256];
+    size_t n = 0;
+    const unsigned char* p = (const unsigned char*)name;
+
+    if (*p == '/') p++;
+    buf[n++] = '/';
+    for (; *p; p++) {
+        if (n + 4 > sizeof(buf)) {
+            if (!pdf_writer_write(w, buf, n)) return 0;
+            n = 0;
+        }
+        if (*p < 0x21 || *p > 0x7e || strchr("#()<>[]{}/%", *p)) {
+            n += (size_t)sprintf(buf + n, "#%02X", *p);
+        } else {
+            buf[n++] = (char)*p;
+        }
+    }
+    return pdf_writer_write(w, buf, n);
+}
+
+/* Strings are written as hex so binary content survives */
+static int write_string(pdf_writer_t* w, qpdf_oh oh)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char buf[256];
+    size_t len = 0, i, n = 0;
+    const unsigned char* data;
+
+    data = (const unsigned char*)qpdf_oh_get_binary_string_value(w->src, oh, &len);
+    buf[n++] = '<';
+    for (i = 0; data && i < len; i++) {
+        if (n + 3 > sizeof(buf)) {
+            if (!pdf_writer_write(w, buf, n)) return 0;
+            n = 0;
+        }
+        buf[n++] = hex[data[i] >> 4];
+        buf[n++] = hex[data[i] & 0x0f];
+    }
+    buf[n++] = '>';
+    return pdf_writer_write(w, buf, n);
+}
+
+static int write_value(pdf_writer_t* w, qpdf_oh oh);
+
+static int write_reference(pdf_writer_t* w, qpdf_oh oh)
+{
+    int objid = qpdf_oh_get_object_id(w->src, oh);
+    int generation = qpdf_oh_get_generation(w->src, oh);
+    unsigned long long key = map_key(objid, generation);
+    int num;
+
+    if (w->identity) {
+        return pdf_writer_printf(w, "%d %d R", objid, generation);
+    }
+
+    num = map_get(w, key);
+    if (!num) {
+        /* Do not cross into pages that were not queued or the page tree */
+        if (qpdf_oh_is_dictionary_of_type(w->src, oh, "/Page", "") ||
+            qpdf_oh_is_dictionary_of_type(w->src, oh, "/Pages", "") ||
+            qpdf_oh_is_dictionary_of_type(w->src, oh, "/Catalog", "")) {
+            return write_str(w, "null");
+        }
+        num = w->next_num++;
+        if (!map_put(w, key, num) || !enqueue(w, objid, generation, num, 0)) {
+            w->failed = 1;
+            return 0;
+        }
+    }
+    return pdf_writer_printf(w, "%d 0 R", num);
+}
+
+/*
+ * Dictionary without skip_key, followed by extra entries (already
+ * formatted). Keys are copied first because QPDF has a single key
+ * iterator per document and values may be dictionaries themselves.
+ */
+static int write_dict(pdf_writer_t* w, qpdf_oh dict, const char* skip_key, const char* extra)
+{
+    char** keys = NULL;
+    int key_count = 0, key_cap = 0, i, ok = 1;
+    qpdf_oh value;
+
+    qpdf_oh_begin_dict_key_iter(w->src, dict);
+    while (qpdf_oh_dict_more_keys(w->src)) {
+        const char* key = qpdf_oh_dict_next_key(w->src);
+        if (key_count == key_cap) {
+            int new_cap = key_cap ? key_cap * 2 : 16;
+            char** grown = (char**)realloc(keys, (size_t)new_cap * sizeof(char*));
+            if (!grown) {
+                ok = 0;
+                break;
+            }
+            keys = grown;
+            key_cap = new_cap;
+        }
+        keys[key_count] = (char*)malloc(strlen(key) + 1);
+        if (!keys[key_count]) {
+            ok = 0;
+            break;
+        }
+        strcpy(keys[key_count], key);
+        key_count++;
+    }
+
+    if (ok) ok = write_str(w, "<<");
+    for (i = 0; ok && i < key_count; i++) {
+        if (skip_key && strcmp(keys[i], skip_key) == 0) continue;
+        value = qpdf_oh_get_key(w->src, dict, keys[i]);
+        ok = write_str(w, " ") && write_name(w, keys[i]) && write_str(w, " ") && write_value(w, value);
+        qpdf_oh_release(w->src, value);
+    }
+    if (ok && extra) ok = write_str(w, extra);
+    if (ok) ok = write_str(w, " >>");
+
+    for (i = 0; i < key_count; i++) free(keys[i]);
+    free(keys);
+
+    if (!ok) w->failed = 1;
+    return ok;
+}
+
+/* Direct value (or the body of an indirect non-stream object) */
+static int write_direct(pdf_writer_t* w, qpdf_oh oh)
+{
+    int i, n, ok;
+    qpdf_oh item;
+
+    if (qpdf_oh_is_array(w->src, oh)) {
+        ok = write_str(w, "[");
+        n = qpdf_oh_get_array_n_items(w->src, oh);
+        for (i = 0; ok && i < n; i++) {
+            item = qpdf_oh_get_array_item(w->src, oh, i);
+            ok = (i == 0 || write_str(w, " ")) && write_value(w, item);
+            qpdf_oh_release(w->src, item);
+        }
+        return ok && write_str(w, "]");
+    }
+    if (qpdf_oh_is_dictionary(w->src, oh)) {
+        return write_dict(w, oh, NULL, NULL);
+    }
+    if (qpdf_oh_is_string(w->src, oh)) {
+        return write_string(w, oh);
+    }
+    if (qpdf_oh_is_stream(w->src, oh)) {
+        /* Streams are always indirect; a direct one is malformed */
+        return write_str(w, "null");
+    }
+    return write_str(w, qpdf_oh_unparse(w->src, oh));
+}
+
+static int write_value(pdf_writer_t* w, qpdf_oh oh)
+{
+    if (qpdf_oh_is_indirect(w->src, oh)) {
+        return write_reference(w, oh);
+    }
+    return write_direct(w, oh);
+}
+
+static int write_stream(pdf_writer_t* w, qpdf_oh stream)
+{
+    unsigned char* data = NULL;
+    size_t len = 0;
+    QPDF_BOOL filtered = QPDF_FALSE;
+    qpdf_oh dict;
+    char extra[48];
+    int ok;
+
+    /* Raw (still encoded) data: no decode / re-encode round trip */
+    if (qpdf_oh_get_stream_data(w->src, stream, qpdf_dl_none, &filtered, &data, &len) >= 2) {
+        w->failed = 1;
+        return 0;
+    }
+
+    dict = qpdf_oh_get_dict(w->src, stream);
+    sprintf(extra, " /Length %llu", (unsigned long long)len);
+    ok = write_dict(w, dict, "/Length", extra) &&
+         write_str(w, "\nstream\n") &&
+         pdf_writer_write(w, data, len) &&
+         write_str(w, "\nendstream");
+    qpdf_oh_release(w->src, dict);
+    free(data);
+    return ok;
+}
+
+static int write_queued(pdf_writer_t* w, const queued_object_t* item)
+{
+    qpdf_oh oh;
+    char extra[48];
+    int ok;
+
+    oh = qpdf_get_object_by_id(w->src, item->objid, item->generation);
+    ok = pdf_writer_begin_object(w, item->num);
+    if (ok) {
+        if (qpdf_oh_is_stream(w->src, oh)) {
+            ok = write_stream(w, oh);
+        } else if (item->parent_num > 0 && qpdf_oh_is_dictionary(w->src, oh)) {
+            sprintf(extra, " /Parent %d 0 R", item->parent_num);
+            ok = write_dict(w, oh, "/Parent", extra);
+        } else {
+            ok = write_direct(w, oh);
+        }
+    }
+    if (ok) ok = pdf_writer_end_object(w);
+    qpdf_oh_release(w->src, oh);
+    return ok;
+}
+
+int pdf_writer_flush(pdf_writer_t* w)
+{
+    /* write_queued() may append to the queue while we walk it */
+    while (!w->failed && w->queue_head < w->queue_count) {
+        queued_object_t item = w->queue[w->queue_head++];
+        if (pdf_cancel_requested(w->cancel)) {
+            w->failed = 1;
+            break;
+        }
+        if (!write_queued(w, &item)) w->failed = 1;
+        if (qpdf_has_error(w->src)) w->failed = 1;
+    }
+    w->queue_head = 0;
+    w->queue_count = 0;
+    return !w->failed;
+}
+
+void pdf_writer_set_cancel(pdf_writer_t* w, const pdf_cancel_t* cancel)
+{
+    w->cancel = cancel;
+}
+
+int pdf_writer_rewrite_object(pdf_writer_t* w, qpdf_oh oh, const char* skip_key, const char* extra)
+{
+    int ok;
+
+    if (!qpdf_oh_is_indirect(w->src, oh) || !qpdf_oh_is_dictionary(w->src, oh)) {
+        w->failed = 1;
+        return 0;
+    }
+
+    w->identity = 1;
+    ok = begin_object_gen(w, qpdf_oh_get_object_id(w->src, oh), qpdf_oh_get_generation(w->src, oh)) &&
+         write_dict(w, oh, skip_key, extra) &&
+         pdf_writer_end_object(w);
+    w->identity = 0;
+
+    if (qpdf_has_error(w->src)) w->failed = 1;
+    return ok && !w->failed;
+}
+
+/* ==================== Cross-reference table ==================== */
+
+static int compare_xref(const void* a, const void* b)
+{
+    int na = ((const xref_entry_t*)a)->num;
+    int nb = ((const xref_entry_t*)b)->num;
+    return (na > nb) - (na < nb);
+}
+
+/* Sort entries and compute /Size */
+static int prepare_xref(pdf_writer_t* w, int size_floor)
+{
+    int size;
+
+    qsort(w->xref, (size_t)w->xref_count, sizeof(xref_entry_t), compare_xref);
+
+    size = w->next_num;
+    if (w->xref_count > 0 && w->xref[w->xref_count - 1].num + 1 > size) {
+        size = w->xref[w->xref_count - 1].num + 1;
+    }
+    if (size_floor > size) size = size_floor;
+    return size;
+}
+
+/* End of the run of consecutive object numbers starting at run_start */
+static int run_end_of(const pdf_writer_t* w, int run_start)
+{
+    int run_end = run_start + 1;
+    while (run_end < w->xref_count && w->xref[run_end].num == w->xref[run_end - 1].num + 1) {
+        run_end++;
+    }
+    return run_end;
+}
+
+int pdf_writer_write_xref(pdf_writer_t* w, int size_floor, const char* trailer_extra, int with_free_head)
+{
+    long long xref_offset = w->offset;
+    int i, run_start, run_end, size;
+
+    if (w->failed) return 0;
+
+    size = prepare_xref(w, size_floor);
+
+    write_str(w, "xref\n");
+    if (with_free_head) {
+        write_str(w, "0 1\n0000000000 65535 f \n");
+    }
+
+    /* One subsection per run of consecutive object numbers */
+    for (run_start = 0; run_start < w->xref_count; run_start = run_end) {
+        run_end = run_end_of(w, run_start);
+        pdf_writer_printf(w, "%d %d\n", w->xref[run_start].num, run_end - run_start);
+        for (i = run_start; i < run_end; i++) {
+            pdf_writer_printf(w, "%010lld %05d n \n", w->xref[i].offset, w->xref[i].generation);
+        }
+    }
+
+    pdf_writer_printf(w, "trailer\n<< /Size %d %s >>\nstartxref\n%lld\n%%%%EOF\n",
+                      size, trailer_extra ? trailer_extra : "", xref_offset);
+
+    return !w->failed;
+}
+
+int pdf_writer_write_xref_stream(pdf_writer_t* w, int size_floor, const char* trailer_extra)
+{
+    int xref_num = pdf_writer_reserve(w);
+    long long xref_offset = w->offset;
+    unsigned char* data;
+    unsigned char* p;
+    int i, k, run_start, run_end, size;
+
+    if (w->failed) return 0;
+
+    /* Registers the xref stream itself, so it is part of its own index */
+    if (!begin_object_gen(w, xref_num, 0)) return 0;
+    size = prepare_xref(w, size_floor);
+
+    /* /W [1 8 2]: type 1, 8-byte offset, 2-byte generation */
+    data = (unsigned char*)malloc((size_t)w->xref_count * 11 + 1);
+    if (!data) {
+        w->failed = 1;
+        return 0;
+    }
+    for (i = 0, p = data; i < w->xref_count; i++, p += 11) {
+        p[0] = 1;
+        for (k = 0; k < 8; k++) p[1 + k] = (unsigned char)((unsigned long long)w->xref[i].offset >> (56 - 8 * k));
+        p[9] = (unsigned char)((w->xref[i].generation >> 8) & 0xff);
+        p[10] = (unsigned char)(w->xref[i].generation & 0xff);
+    }
+
+    pdf_writer_printf(w, "<< /Type /XRef /Size %d /W [1 8 2] /Index [", size);
+    for (run_start = 0; run_start < w->xref_count; run_start = run_end) {
+        run_end = run_end_of(w, run_start);
+        pdf_writer_printf(w, "%s%d %d", run_start ? " " : "", w->xref[run_start].num, run_end - run_start);
+    }
+    pdf_writer_printf(w, "] /Length %d %s >>\nstream\n", w->xref_count * 11,
+                      trailer_extra ? trailer_extra : "");
+    pdf_writer_write(w, data, (size_t)w->xref_count * 11);
+    free(data);
+
+    write_str(w, "\nendstream");
+    pdf_writer_end_object(w);
+    pdf_writer_printf(w, "startxref\n%lld\n%%%%EOF\n", xref_offset);
+
+    return !w->failed;
+}
@@ -0,0 +1,135 @@
+/*
+ * pdf_writer.h
+ * Streaming PDF object writer (internal)
+ *
+ * Copies objects from a QPDF source document straight to an output file,
+ * renumbering them on the way. Only the object map of the current source
+ * and the xref offsets are kept in memory, so a source can be closed as
+ * soon as its objects are written.
+ */
+
+#ifndef PDF_WRITER_H
+#define PDF_WRITER_H
+
+#include <stdio.h>
+#include <qpdf/qpdf-c.h>
+#include "pdf_tools.h"
+#include "pdf_compat.h"
+
+typedef struct pdf_writer pdf_writer_t;
+
+/*
+ * Create a writer on an open binary file.
+ *
+ * @param out output file, positioned where the next byte goes
+ * @param base_offset file offset of the current position (0 for a new file)
+ * @param first_obj_num first object number to hand out (1 for a new file)
+ * @return writer, or NULL if out of memory
+ */
+pdf_writer_t* pdf_writer_create(FILE* out, long long base_offset, int first_obj_num);
+
+/*
+ * Free the writer. Does not close the file.
+ */
+void pdf_writer_destroy(pdf_writer_t* w);
+
+/*
+ * @return 1 if any write or QPDF object access has failed
+ */
+int pdf_writer_failed(const pdf_writer_t* w);
+
+/*
+ * @return current file offset
+ */
+long long pdf_writer_offset(const pdf_writer_t* w);
+
+/*
+ * Hand out the next unused object number (for objects the caller writes).
+ */
+int pdf_writer_reserve(pdf_writer_t* w);
+
+/*
+ * Write raw bytes / formatted text at the current position.
+ */
+int pdf_writer_write(pdf_writer_t* w, const void* data, size_t len);
+int pdf_writer_printf(pdf_writer_t* w, const char* fmt, ...);
+
+/*
+ * Overwrite bytes at an earlier offset (e.g. the header version), then
+ * continue at the end of the file.
+ */
+int pdf_writer_patch(pdf_writer_t* w, long long offset, const char* data, size_t len);
+
+/*
+ * Start / end an object written by the caller ("N 0 obj" ... "endobj").
+ * The object's offset is recorded for the xref table.
+ */
+int pdf_writer_begin_object(pdf_writer_t* w, int obj_num);
+int pdf_writer_end_object(pdf_writer_t* w);
+
+/*
+ * Select the source document for the following pdf_writer_add_page() and
+ * pdf_writer_flush() calls. Resets the object map of the previous source.
+ */
+void pdf_writer_begin_source(pdf_writer_t* w, qpdf_data src);
+
+/*
+ * Queue a page of the current source. The page is written with /Parent
+ * replaced by parent_num, and everything it references is written with it.
+ * References to pages that were not queued, to page tree nodes and to the
+ * catalog are written as null.
+ * Inherited attributes must have been pushed to the pages beforehand
+ * (qpdf_push_inherited_attributes_to_page).
+ *
+ * @return new object number of the page, 0 on failure
+ */
+int pdf_writer_add_page(pdf_writer_t* w, qpdf_oh page, int parent_num);
+
+/*
+ * Write every queued object of the current source and its closure.
+ * @return 1 on success, 0 on failure
+ */
+int pdf_writer_flush(pdf_writer_t* w);
+
+/*
+ * Make pdf_writer_flush() check a cancellation token between objects and
+ * fail once it is set (NULL = never). The writer is then failed for good.
+ */
+void pdf_writer_set_cancel(pdf_writer_t* w, const pdf_cancel_t* cancel);
+
+/*
+ * Rewrite a dictionary object of the current source under its own object
+ * number and generation (incremental update). References keep their
+ * original numbers and are not followed.
+ *
+ * @param oh indirect dictionary of the current source
+ * @param skip_key key to leave out (NULL = none)
+ * @param extra extra entries appended before ">>" (NULL = none)
+ * @return 1 on success, 0 on failure
+ */
+int pdf_writer_rewrite_object(pdf_writer_t* w, qpdf_oh oh, const char* skip_key, const char* extra);
+
+/*
+ * Write the xref table for every object written so far, followed by the
+ * trailer and startxref.
+ *
+ * @param size_floor minimum /Size (previous /Size when appending, else 0)
+ * @param trailer_extra extra trailer entries, e.g. "/Root 1 0 R"
+ * @param with_free_head 1 to include the object 0 free entry (new files)
+ * @return 1 on success, 0 on failure
+ */
+int pdf_writer_write_xref(pdf_writer_t* w, int size_floor, const char* trailer_extra, int with_free_head);
+
+/*
+ * Same as pdf_writer_write_xref() but as a cross-reference stream, for
+ * updating files whose last xref section is a stream. The trailer entries
+ * go into the stream dictionary.
+ */
+int pdf_writer_write_xref_stream(pdf_writer_t* w, int size_floor, const char* trailer_extra);
+
+/*
+ * Digest of the object numbers and offsets written so far, for /ID.
+ */
+unsigned long long pdf_writer_digest(const pdf_writer_t* w);
+
+#endif /* PDF_WRITER_H */